@@ -15931,8 +15931,15 @@ Bool disInstr_ARM64_WRK (
          // Data processing - SIMD and floating point
          ok = dis_ARM64_simd_and_fp(dres, insn, archinfo, sigill_diag);
          break;
+      case BITS4(0,0,1,0):
+         // SVE and SVE2 (not supported)
+         if (sigill_diag) {
+            vex_printf("ARM64 front end: SVE instructions are not "
+                       "supported\n");
+         }
+         break;
       case BITS4(0,0,0,0): case BITS4(0,0,0,1):
-      case BITS4(0,0,1,0): case BITS4(0,0,1,1):
+      case BITS4(0,0,1,1):
          // UNALLOCATED
          break;
       default:
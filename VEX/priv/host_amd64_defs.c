@@ -36,6 +36,7 @@
 #include "libvex_trc_values.h"
 
 #include "main_util.h"
+#include "main_globals.h"
 #include "host_generic_regs.h"
 #include "host_amd64_defs.h"
 
@@ -3180,6 +3181,9 @@ Int emit_AMD64Instr ( /*MB_MOD*/Bool* is_profInc,
    }
 
    case Ain_XIndir: {
+      /* NB: what goes on here has to be very closely coordinated with
+         patchXIndir_AMD64 and unpatchXIndir_AMD64 below, and with
+         VG_(disp_cp_xindir) in the dispatchers. */
       /* We're generating transfers that could lead indirectly to a
          chain-me, so we need to be sure this is actually allowed --
          no-redir translations are not allowed to reach normal
@@ -3205,30 +3209,77 @@ Int emit_AMD64Instr ( /*MB_MOD*/Bool* is_profInc,
       *p++ = 0x89;
       p = doAMode_M(p, i->Ain.XIndir.dstGA, i->Ain.XIndir.amRIP);
 
-      /* get $disp_cp_xindir into %r11 */
-      if (fitsIn32Bits((Addr)disp_cp_xindir)) {
-         /* use a shorter encoding */
-         /* movl sign-extend(disp_cp_xindir), %r11 */
-         *p++ = 0x49;
-         *p++ = 0xC7;
-         *p++ = 0xC3;
-         p = emit32(p, (UInt)(Addr)disp_cp_xindir);
-      } else {
-         /* movabsq $disp_cp_xindir, %r11 */
+      /* --- FIRST PATCHABLE BYTE follows --- */
+      /* This is a one-entry inline cache of the last target, filled in
+         by patchXIndir_AMD64 and emptied by unpatchXIndir_AMD64.  An
+         empty cache holds a guest address of 1, which can't match.
+         VG_(disp_cp_xindir) (which is called, not jumped to) backs up
+         the return address to find the cached guest address, so don't
+         change the length of anything up to and including the call.
+
+         The dispatcher pops that return address rather than returning
+         to it, so every miss leaves an unmatched entry on the CPU's
+         return stack buffer, as the chain-me calls already do.  This
+         costs little.  Generated code only returns from helper calls,
+         which are balanced and sit above the stale entries, so they
+         are still predicted correctly.  The one return that can be
+         mispredicted is the one out of VG_(disp_run_translations),
+         taken once per trip back to the scheduler.  A miss does a fast
+         cache lookup anyway, which costs more than one mispredicted
+         return. */
+      HReg r11 = hregAMD64_R11();
+
+      /* movabsq $cached_guest_addr, %r11 */
+      *p++ = 0x49;
+      *p++ = 0xBB;
+      p = emit64(p, 1);
+
+      /* cmpq %r11, dstGA */
+      *p++ = rexAMode_R(r11, i->Ain.XIndir.dstGA);
+      *p++ = 0x39;
+      p = doAMode_R(p, r11, i->Ain.XIndir.dstGA);
+
+      /* je hit */
+      *p++ = 0x74;
+      *p++ = 13;
+
+      /* movabsq $disp_cp_xindir, %r11 */
+      *p++ = 0x49;
+      *p++ = 0xBB;
+      p = emit64(p, (Addr)disp_cp_xindir);
+
+      /* call *%r11 */
+      *p++ = 0x41;
+      *p++ = 0xFF;
+      *p++ = 0xD3;
+
+      /* hit: */
+      if (vex_control.xindir_cache_hits) {
+         /* movabsq $xindir_cache_hits, %r11 */
          *p++ = 0x49;
          *p++ = 0xBB;
-         p = emit64(p, (Addr)disp_cp_xindir);
+         p = emit64(p, (Addr)vex_control.xindir_cache_hits);
+         /* incl (%r11) */
+         *p++ = 0x41;
+         *p++ = 0xFF;
+         *p++ = 0x03;
       }
 
+      /* movabsq $cached_host_addr, %r11 */
+      *p++ = 0x49;
+      *p++ = 0xBB;
+      p = emit64(p, 0);
+
       /* jmp *%r11 */
       *p++ = 0x41;
       *p++ = 0xFF;
       *p++ = 0xE3;
+      /* --- END of PATCHABLE BYTES --- */
 
       /* Fix up the conditional jump, if there was one. */
       if (i->Ain.XIndir.cond != Acc_ALWAYS) {
          Int delta = p - ptmp;
-         vassert(delta > 0 && delta < 40);
+         vassert(delta > 0 && delta < 100);
          *ptmp = toUChar(delta-1);
       }
       goto done;
@@ -4303,6 +4354,83 @@ VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
 }
 
 
+/* NB: what goes on here has to be very closely coordinated with the
+   emitInstr case for XIndir, above.  Check that place_to_patch looks
+   like the start of an XIndir inline cache and return the location of
+   the cached host address. */
+static UChar* findXIndirHostAddr_AMD64 ( UChar* p )
+{
+   /* What we're expecting to see is:
+        movabsq $cached_guest_addr, %r11
+        cmpq    %r11, dstGA
+        je      hit
+        movabsq $disp_cp_xindir, %r11
+        call    *%r11
+      hit:
+        [movabsq $xindir_cache_hits, %r11
+         incl    (%r11)]
+        movabsq $cached_host_addr, %r11
+        jmpq    *%r11
+      viz
+        49 BB <8 bytes value == cached_guest_addr>
+        4C/4D 39 <1 byte modrm>
+        74 0D
+        49 BB <8 bytes value == disp_cp_xindir>
+        41 FF D3
+        [49 BB <8 bytes value == xindir_cache_hits>
+         41 FF 03]
+        49 BB <8 bytes value == cached_host_addr>
+        41 FF E3
+   */
+   vassert(p[0] == 0x49 && p[1] == 0xBB);
+   vassert((p[10] & 0xFE) == 0x4C && p[11] == 0x39);
+   vassert(p[13] == 0x74 && p[14] == 0x0D);
+   vassert(p[15] == 0x49 && p[16] == 0xBB);
+   vassert(p[25] == 0x41 && p[26] == 0xFF && p[27] == 0xD3);
+   UChar* q = &p[28];
+   if (q[10] == 0x41 && q[11] == 0xFF && q[12] == 0x03) {
+      vassert(q[0] == 0x49 && q[1] == 0xBB);
+      q += 13;
+   }
+   vassert(q[0] == 0x49 && q[1] == 0xBB);
+   vassert(q[10] == 0x41 && q[11] == 0xFF && q[12] == 0xE3);
+   return &q[2];
+}
+
+VexInvalRange patchXIndir_AMD64 ( VexEndness endness_host,
+                                  void* place_to_patch,
+                                  Addr guest_target,
+                                  const void* host_target )
+{
+   vassert(endness_host == VexEndnessLE);
+   UChar* p = (UChar*)place_to_patch;
+   UChar* h = findXIndirHostAddr_AMD64(p);
+   vassert(read_misaligned_ULong_LE(&p[2]) == 1);
+   vassert(read_misaligned_ULong_LE(h) == 0);
+   vassert(guest_target != 1);
+   write_misaligned_ULong_LE(&p[2], (ULong)guest_target);
+   write_misaligned_ULong_LE(h, (ULong)(Addr)host_target);
+   VexInvalRange vir = { (HWord)place_to_patch, h + 8 - p };
+   return vir;
+}
+
+VexInvalRange unpatchXIndir_AMD64 ( VexEndness endness_host,
+                                    void* place_to_unpatch,
+                                    Addr guest_target_EXPECTED,
+                                    const void* host_target_EXPECTED )
+{
+   vassert(endness_host == VexEndnessLE);
+   UChar* p = (UChar*)place_to_unpatch;
+   UChar* h = findXIndirHostAddr_AMD64(p);
+   vassert(read_misaligned_ULong_LE(&p[2]) == (ULong)guest_target_EXPECTED);
+   vassert(read_misaligned_ULong_LE(h) == (ULong)(Addr)host_target_EXPECTED);
+   write_misaligned_ULong_LE(&p[2], 1);
+   write_misaligned_ULong_LE(h, 0);
+   VexInvalRange vir = { (HWord)place_to_unpatch, h + 8 - p };
+   return vir;
+}
+
+
 /* Patch the counter address into a profile inc point, as previously
    created by the Ain_ProfInc case for emit_AMD64Instr. */
 VexInvalRange patchProfInc_AMD64 ( VexEndness endness_host,
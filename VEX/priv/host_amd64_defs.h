@@ -862,6 +862,17 @@ extern VexInvalRange unchainXDirect_AMD64 ( VexEndness endness_host,
                                             const void* place_to_jump_to_EXPECTED,
                                             const void* disp_cp_chain_me );
 
+/* Fill and empty the inline target cache of an XIndir site. */
+extern VexInvalRange patchXIndir_AMD64 ( VexEndness endness_host,
+                                         void* place_to_patch,
+                                         Addr guest_target,
+                                         const void* host_target );
+
+extern VexInvalRange unpatchXIndir_AMD64 ( VexEndness endness_host,
+                                           void* place_to_unpatch,
+                                           Addr guest_target_EXPECTED,
+                                           const void* host_target_EXPECTED );
+
 /* Patch the counter location into an existing ProfInc point. */
 extern VexInvalRange patchProfInc_AMD64 ( VexEndness endness_host,
                                           void*  place_to_patch,
@@ -315,7 +315,8 @@ static inline void mark_vreg_spilled(
 }
 
 /* Spills a vreg assigned to some rreg.
-   The vreg is spilled and the rreg is freed.
+   The vreg is spilled and the rreg is freed. No spill instruction is generated
+   if the rreg is known to still hold the same value as the spill slot.
    Returns rreg's index. */
 static inline UInt spill_vreg(
    HReg vreg, UInt v_idx, UInt current_ii, VRegState* vreg_state, UInt n_vregs,
@@ -332,6 +333,12 @@ static inline UInt spill_vreg(
    vassert(vreg_state[v_idx].dead_before > (Short) current_ii);
    vassert(vreg_state[v_idx].reg_class != HRcINVALID);
 
+   if (rreg_state[r_idx].eq_spill_slot) {
+      /* The spill slot is up to date; nothing needs to be stored. */
+      mark_vreg_spilled(v_idx, vreg_state, n_vregs, rreg_state, n_rregs);
+      return r_idx;
+   }
+
    /* Generate spill. */
    HInstr* spill1 = NULL;
    HInstr* spill2 = NULL;
@@ -351,7 +358,10 @@ static inline UInt spill_vreg(
 
 /* Chooses a vreg to be spilled based on various criteria.
    The vreg must not be from the instruction being processed, that is, it must
-   not be listed in reg_usage->vRegs. */
+   not be listed in reg_usage->vRegs.
+   The primary criterion is the furthest next use. Among candidates whose next
+   use is equally far, prefer one whose rreg still equals its spill slot,
+   because spilling such a vreg does not need to generate any store. */
 static inline HReg find_vreg_to_spill(
    VRegState* vreg_state, UInt n_vregs,
    RRegState* rreg_state, UInt n_rregs,
@@ -372,6 +382,7 @@ static inline HReg find_vreg_to_spill(
 
    HReg vreg_found = INVALID_HREG;
    UInt distance_so_far = 0;
+   Bool found_eq_spill_slot = False;
 
    for (UInt r_idx = con->univ->allocable_start[target_hregclass];
         r_idx <= con->univ->allocable_end[target_hregclass]; r_idx++) {
@@ -385,10 +396,14 @@ static inline HReg find_vreg_to_spill(
                }
             }
 
-            if (ii >= distance_so_far) {
-               distance_so_far = ii;
-               vreg_found = vreg;
-               if (distance_so_far == scan_forward_end) {
+            Bool eq_spill_slot = rreg_state[r_idx].eq_spill_slot;
+            if (ii > distance_so_far
+                || (ii == distance_so_far
+                    && (eq_spill_slot || !found_eq_spill_slot))) {
+               distance_so_far     = ii;
+               vreg_found          = vreg;
+               found_eq_spill_slot = eq_spill_slot;
+               if (distance_so_far >= scan_forward_end && eq_spill_slot) {
                   break; /* We are at the end. Nothing could be better. */
                }
             }
@@ -1129,14 +1144,9 @@ HInstrArray* doRegisterAllocation_v3(
                   UInt v_idx = hregIndex(vreg);
 
                   if (! HRegUsage__contains(&reg_usage[ii], vreg)) {
-                     if (rreg->eq_spill_slot) {
-                        mark_vreg_spilled(v_idx, vreg_state, n_vregs,
-                                          rreg_state, n_rregs);
-                     } else {
-                        /* Spill the vreg. It is not used by this instruction.*/
-                        spill_vreg(vreg, v_idx, ii, vreg_state, n_vregs,
-                                   rreg_state, n_rregs, instrs_out, con);
-                     }
+                     /* Spill the vreg. It is not used by this instruction.*/
+                     spill_vreg(vreg, v_idx, ii, vreg_state, n_vregs,
+                                rreg_state, n_rregs, instrs_out, con);
                   } else {
                      /* Find or make a free rreg where to move this vreg to. */
                      UInt r_free_idx = FIND_OR_MAKE_FREE_RREG(
@@ -543,9 +543,16 @@ static IRSB* flatten_BB ( IRSB* in )
    env and if it matches, replace the Get with the stored value.  If
    there is no match, add a (minoff,maxoff) :-> t binding.
 
-   On seeing 'Put (minoff,maxoff) = t or c', first remove in the env
-   any binding which fully or partially overlaps with (minoff,maxoff).
-   Then add a new (minoff,maxoff) :-> t or c binding.  */
+   On seeing 'Put (minoff,maxoff) = t or c', first check whether the
+   env already binds (minoff,maxoff) to that same t or c.  If so, the
+   Put writes back a value the guest state is known to hold already,
+   so it is removed and the env left unchanged.  This typically
+   catches loop-invariant Puts (flag thunk descriptors, the IP at the
+   loop-closing branch, registers read and written back unchanged)
+   that would otherwise be repeated in every copy of an unrolled
+   loop body.  Otherwise, remove in the env any binding which fully
+   or partially overlaps with (minoff,maxoff).  Then add a new
+   (minoff,maxoff) :-> t or c binding.  */
 
 /* Extract the min/max offsets from a guest state array descriptor. */
 
@@ -663,6 +670,17 @@ static void redundant_get_removal_BB ( IRSB* bb )
          if (st->tag == Ist_Put) {
             key = mk_key_GetPut( st->Ist.Put.offset, 
                                  typeOfIRExpr(bb->tyenv,st->Ist.Put.data) );
+            /* Is this Put writing a value that the guest state is
+               already known to contain?  If so, it's a no-op. */
+            if (lookupHHW(env, &val, (HWord)key)
+                && eqIRAtom((IRExpr*)val, st->Ist.Put.data)) {
+               if (DEBUG_IROPT) {
+                  vex_printf("rPUT(same value): "); ppIRStmt(st);
+                  vex_printf("\n");
+               }
+               bb->stmts[i] = IRStmt_NoOp();
+               continue;
+            }
          } else {
             vassert(st->tag == Ist_PutI);
             key = mk_key_GetIPutI( st->Ist.PutI.details->descr );
@@ -204,6 +204,7 @@ void LibVEX_default_VexControl ( /*OUT*/ VexControl* vcon )
    vcon->guest_max_insns                = 60;
    vcon->guest_chase                    = True;
    vcon->regalloc_version               = 3;
+   vcon->xindir_cache_hits              = NULL;
 }
 
 
@@ -322,6 +323,21 @@ void LibVEX_Init (
 UInt s390_host_hwcaps;
 
 
+/* If the client supplied a timer, charge the time since *phase_start
+   to |phase| and restart the measurement. */
+static inline void note_phase_end ( const VexTranslateArgs* vta,
+                                    /*MOD*/VexTranslateResult* res,
+                                    VexTranslatePhase phase,
+                                    /*MOD*/ULong* phase_start )
+{
+   if (vta->read_timer) {
+      ULong now = vta->read_timer();
+      res->phase_ticks[phase] += now - *phase_start;
+      *phase_start = now;
+   }
+}
+
+
 /* Exported to library client. */
 
 IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
@@ -338,6 +354,7 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
    Int             offB_CMSTART, offB_CMLEN, offB_GUEST_IP, szB_GUEST_IP;
    IRType          guest_word_type;
    IRType          host_word_type;
+   ULong           phase_start;
 
    guest_layout            = NULL;
    specHelper              = NULL;
@@ -584,6 +601,9 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
    res->n_guest_instrs = 0;
    res->n_uncond_in_trace = 0;
    res->n_cond_in_trace = 0;
+   for (i = 0; i < VexPhase_N; i++)
+      res->phase_ticks[i] = 0;
+   phase_start = vta->read_timer ? vta->read_timer() : 0;
 
 #ifndef VEXMULTIARCH
    /* yet more sanity checks ... */
@@ -634,6 +654,8 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_Decode, &phase_start);
+
    if (irsb == NULL) {
       /* Access failure. */
       vexSetAllocModeTEMP_and_clear();
@@ -681,6 +703,8 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
                               vta->guest_bytes_addr,
                               vta->arch_guest );
 
+   note_phase_end(vta, res, VexPhase_Opt1, &phase_start);
+
    // JRS 2016 Aug 03: Sanity checking is expensive, we already checked
    // the output of the front end, and iropt never screws up the IR by
    // itself, unless it is being hacked on.  So remove this post-iropt
@@ -707,12 +731,16 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
                               guest_word_type, host_word_type);
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_Instrument1, &phase_start);
+
    if (vta->instrument2)
       irsb = vta->instrument2(vta->callback_opaque,
                               irsb, guest_layout,
                               vta->guest_extents,
                               &vta->archinfo_host,
                               guest_word_type, host_word_type);
+
+   note_phase_end(vta, res, VexPhase_Instrument2, &phase_start);
       
    if (vex_traceflags & VEX_TRACE_INST) {
       vex_printf("\n------------------------" 
@@ -740,6 +768,8 @@ IRSB* LibVEX_FrontEnd ( /*MOD*/ VexTranslateArgs* vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_Opt2, &phase_start);
+
    if (vex_traceflags & VEX_TRACE_OPT2) {
       vex_printf("\n------------------------" 
                    " After post-instr IR optimisation "
@@ -788,6 +818,7 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
    Int offB_HOST_EvC_FAILADDR;
    Addr            max_ga;
    UChar           insn_bytes[128];
+   ULong           phase_start;
    HInstrArray*    vcode;
    HInstrArray*    rcode;
 
@@ -1113,6 +1144,8 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
    check_hwcaps(vta->arch_host, vta->archinfo_host.hwcaps);
 
 
+   phase_start = vta->read_timer ? vta->read_timer() : 0;
+
    /* Turn it into virtual-registerised code.  Build trees -- this
       also throws away any dead bindings. */
    max_ga = ado_treebuild_BB( irsb, preciseMemExnsFn, pxControl );
@@ -1123,6 +1156,8 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_Opt2, &phase_start);
+
    if (vex_traceflags & VEX_TRACE_TREES) {
       vex_printf("\n------------------------" 
                    "  After tree-building "
@@ -1159,6 +1194,8 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_ISel, &phase_start);
+
    if (vex_traceflags & VEX_TRACE_VCODE)
       vex_printf("\n");
 
@@ -1190,6 +1227,8 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_RegAlloc, &phase_start);
+
    if (vex_traceflags & VEX_TRACE_RCODE) {
       vex_printf("\n------------------------" 
                    " Register-allocated code "
@@ -1259,6 +1298,8 @@ static void libvex_BackEnd ( const VexTranslateArgs *vta,
 
    vexAllocSanityCheck();
 
+   note_phase_end(vta, res, VexPhase_Assemble, &phase_start);
+
    vexSetAllocModeTEMP_and_clear();
 
    if (vex_traceflags) {
@@ -1426,6 +1467,42 @@ VexInvalRange LibVEX_UnChain ( VexArch     arch_host,
    }
 }
 
+/* --------- Patch/UnPatch XIndir inline caches. --------- */
+
+VexInvalRange LibVEX_PatchXIndir ( VexArch     arch_host,
+                                   VexEndness  endness_host,
+                                   void*       place_to_patch,
+                                   Addr        guest_target,
+                                   const void* host_target )
+{
+   switch (arch_host) {
+      case VexArchAMD64:
+         AMD64ST(return patchXIndir_AMD64(endness_host,
+                                          place_to_patch,
+                                          guest_target,
+                                          host_target));
+      default:
+         vassert(0);
+   }
+}
+
+VexInvalRange LibVEX_UnPatchXIndir ( VexArch     arch_host,
+                                     VexEndness  endness_host,
+                                     void*       place_to_unpatch,
+                                     Addr        guest_target_EXPECTED,
+                                     const void* host_target_EXPECTED )
+{
+   switch (arch_host) {
+      case VexArchAMD64:
+         AMD64ST(return unpatchXIndir_AMD64(endness_host,
+                                            place_to_unpatch,
+                                            guest_target_EXPECTED,
+                                            host_target_EXPECTED));
+      default:
+         vassert(0);
+   }
+}
+
 Int LibVEX_evCheckSzB ( VexArch    arch_host )
 {
    static Int cached = 0; /* DO NOT MAKE NON-STATIC */
@@ -552,6 +552,11 @@ typedef
          - '3': current, faster implementation; perhaps producing slightly worse
                 spilling decisions. */
       UInt regalloc_version;
+      /* If non-NULL, back ends which give XIndir sites an inline target
+         cache (currently only amd64) make each hit in that cache
+         increment this counter.  Intended for statistics only, since
+         it costs a memory increment per hit.  Default=NULL. */
+      UInt* xindir_cache_hits;
    }
    VexControl;
 
@@ -666,6 +671,23 @@ extern void LibVEX_Init (
 /*--- Make a translation                              ---*/
 /*-------------------------------------------------------*/
 
+/* The phases of the translation pipeline.  LibVEX_Translate can
+   report how long each of them took; see VexTranslateArgs::read_timer. */
+typedef
+   enum {
+      VexPhase_Decode=0,    /* guest code to IR, including self-checks */
+      VexPhase_Opt1,        /* pre-instrumentation IR optimisation */
+      VexPhase_Instrument1, /* the instrument1 callback */
+      VexPhase_Instrument2, /* the instrument2 callback */
+      VexPhase_Opt2,        /* post-instrumentation cleanup, tree
+                               building and the finaltidy callback */
+      VexPhase_ISel,        /* instruction selection */
+      VexPhase_RegAlloc,    /* register allocation */
+      VexPhase_Assemble,    /* emitting host instructions */
+      VexPhase_N
+   }
+   VexTranslatePhase;
+
 /* Describes the outcome of a translation attempt. */
 typedef
    struct {
@@ -686,6 +708,10 @@ typedef
       /* Stats only: the number of conditional branches incorporated into the
          trace. */
       UShort n_cond_in_trace;
+      /* Stats only: the time spent in each phase, in the units returned
+         by VexTranslateArgs::read_timer.  All zero if read_timer is
+         NULL. */
+      ULong phase_ticks[VexPhase_N];
    }
    VexTranslateResult;
 
@@ -794,6 +820,12 @@ typedef
       */
       Bool    (*preamble_function)(/*callback_opaque*/void*, IRSB*);
 
+      /* IN: stats: optionally, a monotonic timer (for example a cycle
+         counter).  If non-NULL, it is called at each phase boundary and
+         the elapsed time is recorded in VexTranslateResult::phase_ticks.
+         May be NULL. */
+      ULong   (*read_timer)( void );
+
       /* IN: debug: trace vex activity at various points */
       Int     traceflags;
 
@@ -909,6 +941,29 @@ VexInvalRange LibVEX_UnChain ( VexArch     arch_host,
                                const void* place_to_jump_to_EXPECTED,
                                const void* disp_cp_chain_me );
 
+/* Fill the inline target cache of an XIndir site, whose cache starts
+   at place_to_patch, so that a transfer to guest_target jumps
+   straight to host_target instead of going through the dispatcher.
+   It is expected (and checked) that the cache is currently empty.
+   Only amd64 hosts generate such sites; their dispatcher asks for
+   the patching when an empty cache is first used. */
+extern
+VexInvalRange LibVEX_PatchXIndir ( VexArch     arch_host,
+                                   VexEndness  endness_host,
+                                   void*       place_to_patch,
+                                   Addr        guest_target,
+                                   const void* host_target );
+
+/* Undo LibVEX_PatchXIndir, emptying the cache again.  It is expected
+   (and checked) that the cache currently holds guest_target_EXPECTED
+   and host_target_EXPECTED. */
+extern
+VexInvalRange LibVEX_UnPatchXIndir ( VexArch     arch_host,
+                                     VexEndness  endness_host,
+                                     void*       place_to_unpatch,
+                                     Addr        guest_target_EXPECTED,
+                                     const void* host_target_EXPECTED );
+
 /* Returns a constant -- the size of the event check that is put at
    the start of every translation.  This makes it possible to
    calculate the fast entry point address if the slow entry point
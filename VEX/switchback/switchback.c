@@ -595,6 +595,7 @@ void make_translation ( Addr guest_addr, Bool verbose )
    vta.instrument1      = NULL;
    vta.instrument2      = NULL;
    vta.needs_self_check = needs_self_check;
+   vta.read_timer       = NULL;
    vta.traceflags       = verbose ? TEST_FLAGS : DEBUG_TRACE_FLAGS;
 
    vta.disp_cp_chain_me_to_slowEP = NULL; //disp_chain_fast;
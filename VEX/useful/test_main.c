@@ -271,6 +271,7 @@ int main ( int argc, char** argv )
 #endif
       vta.needs_self_check  = needs_self_check;
       vta.preamble_function = NULL;
+      vta.read_timer      = NULL;
       vta.traceflags      = TEST_FLAGS;
       vta.addProfInc      = False;
       vta.sigill_diag     = True;
@@ -0,0 +1,836 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Collect and merge the XML error output of many valgrind      ---*/
+/*--- processes.                               valgrind-collector.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2000-2017 Julian Seward 
+      jseward@acm.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* valgrind-collector accepts connections from processes run with
+   --xml=yes --xml-socket=IP:PORT, typically the many workers of a
+   forking server run with --trace-children=yes.  It parses the
+   <error> elements and the final <errorcounts> of each stream, and
+   merges the errors of all the processes by suppression key: the
+   error kind plus the fun:/obj: names of the frames of the main
+   stack, which unlike the addresses do not depend on where a process
+   happened to map its objects.  When it exits, it prints each merged
+   error once, with the total number of occurrences and the number of
+   processes that reported it, most frequent first.
+
+   The XML comes from the network, so it is never trusted: a stream
+   that is malformed, or that sends an element larger than
+   MAX_ELEMENT_SIZE, is reported and its connection closed, and the
+   collector goes on serving the others. */
+
+/*---------------------------------------------------------------*/
+
+/* Include valgrind headers before system headers to avoid problems
+   with the system headers #defining things which are used as names
+   of structure members in vki headers. */
+
+#include "pub_core_basics.h"
+#include "pub_core_libcassert.h"    // For VG_BUGS_TO
+#include "pub_core_vki.h"           // Avoids warnings from
+                                    // pub_core_libcfile.h
+#include "pub_core_libcfile.h"      // For VG_CLO_DEFAULT_LOGPORT
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+
+/*---------------------------------------------------------------*/
+
+/* The default allowable number of concurrent connections. */
+#define  M_CONNECTIONS_DEFAULT 50
+/* The maximum allowable number of concurrent connections. */
+#define  M_CONNECTIONS_MAX     5000
+
+/* The maximum allowable number of concurrent connections. */
+static unsigned M_CONNECTIONS = 0;
+
+/* The largest <error> or <errorcounts> element accepted. */
+#define  MAX_ELEMENT_SIZE      (16 * 1024 * 1024)
+
+/*---------------------------------------------------------------*/
+
+__attribute__ ((noreturn))
+static void panic ( const char* str )
+{
+   fprintf(stderr,
+           "\nvalgrind-collector: the "
+           "'impossible' happened:\n   %s\n", str);
+   fprintf(stderr,
+           "Please report this bug at: %s\n\n", VG_BUGS_TO);
+   exit(1);
+}
+
+__attribute__ ((noreturn))
+static void my_assert_fail ( const char* expr, const char* file, int line, const char* fn )
+{
+   fprintf(stderr,
+           "\nvalgrind-collector: %s:%d (%s): Assertion '%s' failed.\n",
+           file, line, fn, expr );
+   fprintf(stderr,
+           "Please report this bug at: %s\n\n", VG_BUGS_TO);
+   exit(1);
+}
+
+#undef assert
+
+#define assert(expr)                                             \
+  ((void) ((expr) ? 0 :                                          \
+           (my_assert_fail (VG_STRINGIFY(expr),                  \
+                            __FILE__, __LINE__,                  \
+                            __PRETTY_FUNCTION__), 0)))
+
+static void* xmalloc ( size_t n )
+{
+   void* p = malloc(n);
+   if (p == NULL)
+      panic("out of memory");
+   return p;
+}
+
+static void* xrealloc ( void* p, size_t n )
+{
+   p = realloc(p, n);
+   if (p == NULL)
+      panic("out of memory");
+   return p;
+}
+
+static char* xstrndup ( const char* s, size_t n )
+{
+   char* r = xmalloc(n + 1);
+   memcpy(r, s, n);
+   r[n] = 0;
+   return r;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Merged errors                                           ---*/
+/*---------------------------------------------------------------*/
+
+typedef
+   struct _MergedError {
+      struct _MergedError* next;   /* hash chain */
+      char*  key;           /* kind, then one fun: or obj: line per frame */
+      char*  what;          /* description of the first occurrence */
+      char*  stack;         /* printable main stack of the first occurrence */
+      unsigned long long n_occurrences;
+      unsigned long long leaked_bytes;
+      unsigned n_processes;
+      unsigned last_conn;   /* serial of the last connection counted */
+      int    first_pid;
+   }
+   MergedError;
+
+#define N_ERR_BUCKETS 4099
+
+static MergedError* err_buckets[N_ERR_BUCKETS];
+static unsigned     n_merged_errors = 0;
+static unsigned     n_processes_seen = 0;
+
+static unsigned hash_string ( const char* s )
+{
+   /* FNV-1a */
+   unsigned h = 2166136261u;
+   for (; *s; s++) {
+      h ^= (unsigned char)*s;
+      h *= 16777619u;
+   }
+   return h;
+}
+
+static MergedError* find_or_add_error ( const char* key )
+{
+   unsigned b = hash_string(key) % N_ERR_BUCKETS;
+   MergedError* e;
+   for (e = err_buckets[b]; e != NULL; e = e->next)
+      if (0 == strcmp(e->key, key))
+         return e;
+   e = xmalloc(sizeof(MergedError));
+   memset(e, 0, sizeof(MergedError));
+   e->key = strdup(key);
+   if (e->key == NULL)
+      panic("out of memory");
+   e->next = err_buckets[b];
+   err_buckets[b] = e;
+   n_merged_errors++;
+   return e;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Minimal XML helpers                                     ---*/
+/*---------------------------------------------------------------*/
+
+/* Undo the escaping done by Valgrind's %pS format, in place. */
+static void unescape ( char* s )
+{
+   static const struct { const char* esc; char c; } escs[]
+      = { {"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'},
+          {"&quot;", '"'}, {"&apos;", '\''} };
+   char* w = s;
+   while (*s) {
+      unsigned i;
+      for (i = 0; i < sizeof(escs)/sizeof(escs[0]); i++) {
+         size_t n = strlen(escs[i].esc);
+         if (0 == strncmp(s, escs[i].esc, n)) {
+            *w++ = escs[i].c;
+            s += n;
+            break;
+         }
+      }
+      if (i == sizeof(escs)/sizeof(escs[0]))
+         *w++ = *s++;
+   }
+   *w = 0;
+}
+
+/* Return a malloc-ed, unescaped copy of the contents of the first
+   <tag>...</tag> element in [start, end), or NULL if there is none. */
+static char* element_text ( const char* start, const char* end,
+                            const char* tag )
+{
+   char open[40], close[40];
+   const char *b, *e;
+   snprintf(open, sizeof(open), "<%s>", tag);
+   snprintf(close, sizeof(close), "</%s>", tag);
+   b = strstr(start, open);
+   if (b == NULL || b >= end)
+      return NULL;
+   b += strlen(open);
+   e = strstr(b, close);
+   if (e == NULL || e > end)
+      return NULL;
+   char* r = xstrndup(b, e - b);
+   unescape(r);
+   return r;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Connections                                             ---*/
+/*---------------------------------------------------------------*/
+
+typedef
+   struct {
+      char*  unique;        /* the <unique> value in this process */
+      MergedError* err;
+      unsigned next;        /* hash chain: index + 1, 0 at the end */
+   }
+   UniqueMap;
+
+typedef
+   struct {
+      int    fd;
+      unsigned serial;      /* distinguishes connections over time */
+      int    pid;           /* 0 until the <pid> element is seen */
+      char*  buf;           /* XML not yet processed */
+      size_t used, size;
+      UniqueMap* uniques;   /* errors reported by this process */
+      unsigned   n_uniques, size_uniques;
+      unsigned*  unique_heads;  /* size_uniques hash chains */
+   }
+   Conn;
+
+/* The connections, indexed by fd, and the pollfd array given to poll:
+   conn_pollfd[0] is the listening socket, and conn_pollfd[1 ..
+   conn_count] the connections, in no particular order. */
+static Conn**         conn_by_fd;
+static int            conn_by_fd_size = 0;
+static struct pollfd* conn_pollfd;
+static int            conn_count = 0;
+
+/* Report a protocol error on c. */
+static void bad_stream ( const Conn* c, const char* what )
+{
+   fprintf(stderr, "valgrind-collector: connection %u (pid %d): %s; "
+           "closing it\n", c->serial, c->pid, what);
+}
+
+/* Build the suppression key and printable stack of the first <stack>
+   in [start, end), appending to *key and *stack.  Returns 0 if the
+   stack is malformed. */
+static int add_stack ( const char* start, const char* end,
+                       char** key, size_t* key_len,
+                       char** stack, size_t* stack_len )
+{
+   const char* s_end = strstr(start, "</stack>");
+   if (s_end == NULL || s_end > end)
+      return 0;
+   const char* p = start;
+   int first = 1;
+   while (1) {
+      const char* f = strstr(p, "<frame>");
+      if (f == NULL || f > s_end)
+         break;
+      const char* f_end = strstr(f, "</frame>");
+      const char* f_next = strstr(f + 1, "<frame>");
+      if (f_end == NULL || f_end > s_end
+          || (f_next != NULL && f_next < f_end))
+         return 0;
+      char* fn   = element_text(f, f_end, "fn");
+      char* obj  = element_text(f, f_end, "obj");
+      char* file = element_text(f, f_end, "file");
+      char* line = element_text(f, f_end, "line");
+      char* ip   = element_text(f, f_end, "ip");
+      char  tmp[1000];
+      int   n;
+
+      n = snprintf(tmp, sizeof(tmp), "\n%s:%s",
+                   fn ? "fun" : "obj", fn ? fn : obj ? obj : "*");
+      if (n >= (int)sizeof(tmp)) n = sizeof(tmp) - 1;
+      *key = xrealloc(*key, *key_len + n + 1);
+      memcpy(*key + *key_len, tmp, n + 1);
+      *key_len += n;
+
+      if (file && line)
+         n = snprintf(tmp, sizeof(tmp), "   %s %s (%s:%s)\n",
+                      first ? "at" : "by", fn ? fn : "???", file, line);
+      else
+         n = snprintf(tmp, sizeof(tmp), "   %s %s (in %s)\n",
+                      first ? "at" : "by", fn ? fn : ip ? ip : "???",
+                      obj ? obj : "???");
+      if (n >= (int)sizeof(tmp)) n = sizeof(tmp) - 1;
+      *stack = xrealloc(*stack, *stack_len + n + 1);
+      memcpy(*stack + *stack_len, tmp, n + 1);
+      *stack_len += n;
+
+      free(fn); free(obj); free(file); free(line); free(ip);
+      first = 0;
+      p = f_end;
+   }
+   return 1;
+}
+
+static unsigned find_unique ( const Conn* c, const char* unique )
+{
+   unsigned i;
+   if (c->size_uniques == 0)
+      return c->n_uniques;
+   i = c->unique_heads[hash_string(unique) % c->size_uniques];
+   for (; i != 0; i = c->uniques[i - 1].next)
+      if (0 == strcmp(c->uniques[i - 1].unique, unique))
+         return i - 1;
+   return c->n_uniques;
+}
+
+static void add_unique ( Conn* c, char* unique, MergedError* e )
+{
+   unsigned i, h;
+   if (c->n_uniques == c->size_uniques) {
+      c->size_uniques = c->size_uniques ? 2 * c->size_uniques : 16;
+      c->uniques = xrealloc(c->uniques,
+                            c->size_uniques * sizeof(UniqueMap));
+      free(c->unique_heads);
+      c->unique_heads = xmalloc(c->size_uniques * sizeof(unsigned));
+      memset(c->unique_heads, 0, c->size_uniques * sizeof(unsigned));
+      for (i = 0; i < c->n_uniques; i++) {
+         h = hash_string(c->uniques[i].unique) % c->size_uniques;
+         c->uniques[i].next = c->unique_heads[h];
+         c->unique_heads[h] = i + 1;
+      }
+   }
+   h = hash_string(unique) % c->size_uniques;
+   c->uniques[c->n_uniques].unique = unique;
+   c->uniques[c->n_uniques].err = e;
+   c->uniques[c->n_uniques].next = c->unique_heads[h];
+   c->n_uniques++;
+   c->unique_heads[h] = c->n_uniques;
+}
+
+/* Merge the <error> element [start, end) received from c.  Returns 0
+   if it is malformed, in which case nothing is merged. */
+static int process_error ( Conn* c, const char* start, const char* end )
+{
+   char* unique = element_text(start, end, "unique");
+   char* kind   = element_text(start, end, "kind");
+   char* what   = element_text(start, end, "what");
+   if (what == NULL) {
+      /* <xwhat><text>..</text>..</xwhat> */
+      const char* x = strstr(start, "<xwhat>");
+      if (x != NULL && x < end)
+         what = element_text(x, end, "text");
+   }
+   char* leaked = element_text(start, end, "leakedbytes");
+
+   /* The main stack is the first one after the description. */
+   const char* stk = strstr(start, "<stack>");
+   char*  key = xstrndup(kind ? kind : "?", strlen(kind ? kind : "?"));
+   size_t key_len = strlen(key);
+   char*  stack = xstrndup("", 0);
+   size_t stack_len = 0;
+   if (stk != NULL && stk < end
+       && !add_stack(stk, end, &key, &key_len, &stack, &stack_len)) {
+      free(unique); free(kind); free(what); free(leaked); free(key);
+      free(stack);
+      return 0;
+   }
+
+   MergedError* e = find_or_add_error(key);
+   if (e->n_processes == 0) {
+      e->what  = what;
+      e->stack = stack;
+      e->first_pid = c->pid;
+      what = stack = NULL;
+   }
+   if (e->last_conn != c->serial) {
+      e->last_conn = c->serial;
+      e->n_processes++;
+   }
+   e->n_occurrences++;
+   if (leaked != NULL)
+      e->leaked_bytes += strtoull(leaked, NULL, 10);
+
+   if (unique != NULL) {
+      add_unique(c, unique, e);
+      unique = NULL;
+   }
+
+   free(unique); free(kind); free(what); free(leaked); free(key);
+   free(stack);
+   return 1;
+}
+
+/* Merge the <errorcounts> element [start, end) received from c.  Each
+   error has been counted once when seen, so add the other
+   occurrences. */
+static void process_errorcounts ( Conn* c, const char* start,
+                                  const char* end )
+{
+   const char* p = start;
+   while (1) {
+      const char* pair = strstr(p, "<pair>");
+      if (pair == NULL || pair >= end)
+         break;
+      const char* pair_end = strstr(pair, "</pair>");
+      if (pair_end == NULL || pair_end > end)
+         break;
+      char* count  = element_text(pair, pair_end, "count");
+      char* unique = element_text(pair, pair_end, "unique");
+      if (count != NULL && unique != NULL) {
+         unsigned i = find_unique(c, unique);
+         unsigned long long n = strtoull(count, NULL, 10);
+         if (i < c->n_uniques && n > 1)
+            c->uniques[i].err->n_occurrences += n - 1;
+      }
+      free(count); free(unique);
+      p = pair_end;
+   }
+}
+
+/* Process the complete elements buffered for c, and discard the
+   text that is no longer needed.  Returns 0 if the stream is
+   malformed. */
+static int process_buffer ( Conn* c )
+{
+   size_t consumed = 0;
+   c->buf[c->used] = 0;
+
+   if (c->pid == 0) {
+      char* pid = element_text(c->buf, c->buf + c->used, "pid");
+      if (pid != NULL) {
+         c->pid = atoi(pid);
+         free(pid);
+      }
+   }
+
+   while (1) {
+      char* p  = c->buf + consumed;
+      char* er = strstr(p, "<error>");
+      char* ec = strstr(p, "<errorcounts>");
+      char* s;
+      const char* close;
+      if (er != NULL && (ec == NULL || er < ec)) {
+         s = er; close = "</error>";
+      } else if (ec != NULL) {
+         s = ec; close = "</errorcounts>";
+      } else {
+         /* Keep a tail which might be the start of a tag. */
+         if (c->used - consumed > 16)
+            consumed = c->used - 16;
+         break;
+      }
+      char* e = strstr(s, close);
+      if (e == NULL) {
+         consumed = s - c->buf;
+         if (c->used - consumed > MAX_ELEMENT_SIZE) {
+            bad_stream(c, "element too large");
+            return 0;
+         }
+         break;
+      }
+      /* An element cut short and followed by another one. */
+      char* next = strstr(s + 1, ec == s ? "<errorcounts>" : "<error>");
+      if (next != NULL && next < e) {
+         bad_stream(c, "unterminated element");
+         return 0;
+      }
+      if (ec == s)
+         process_errorcounts(c, s, e);
+      else if (!process_error(c, s, e)) {
+         bad_stream(c, "malformed <error>");
+         return 0;
+      }
+      consumed = (e + strlen(close)) - c->buf;
+   }
+
+   memmove(c->buf, c->buf + consumed, c->used - consumed);
+   c->used -= consumed;
+   c->buf[c->used] = 0;
+   return 1;
+}
+
+/* Read what is available on c.  Returns 0 if the connection has been
+   closed or must be closed. */
+static int read_from_conn ( Conn* c )
+{
+   ssize_t n;
+   if (c->size - c->used < 4096 + 1) {
+      c->size = c->size ? 2 * c->size : 16384;
+      c->buf = xrealloc(c->buf, c->size);
+   }
+   n = read(c->fd, c->buf + c->used, c->size - c->used - 1);
+   if (n < 0 && (errno == EINTR || errno == EAGAIN))
+      return 1;
+   if (n == 0 && c->used > 0 && strstr(c->buf, "<error") != NULL)
+      fprintf(stderr, "valgrind-collector: connection %u (pid %d): "
+              "closed in the middle of an element\n", c->serial, c->pid);
+   if (n <= 0)
+      return 0;
+   c->used += n;
+   return process_buffer(c);
+}
+
+static void add_conn ( int fd, unsigned serial )
+{
+   Conn* c;
+   if (fd >= conn_by_fd_size) {
+      int old_size = conn_by_fd_size;
+      conn_by_fd_size = fd + 64;
+      conn_by_fd = xrealloc(conn_by_fd, conn_by_fd_size * sizeof(Conn*));
+      memset(conn_by_fd + old_size, 0,
+             (conn_by_fd_size - old_size) * sizeof(Conn*));
+   }
+   c = xmalloc(sizeof(Conn));
+   memset(c, 0, sizeof(Conn));
+   c->fd = fd;
+   c->serial = serial;
+   conn_by_fd[fd] = c;
+   conn_count++;
+   conn_pollfd[conn_count].fd = fd;
+   conn_pollfd[conn_count].events = POLLIN;
+}
+
+/* Close the connection polled by conn_pollfd[k], moving the last
+   connection into its place. */
+static void close_conn ( int k )
+{
+   unsigned i;
+   Conn* c = conn_by_fd[conn_pollfd[k].fd];
+   conn_by_fd[c->fd] = NULL;
+   conn_pollfd[k] = conn_pollfd[conn_count];
+   conn_count--;
+   close(c->fd);
+   for (i = 0; i < c->n_uniques; i++)
+      free(c->uniques[i].unique);
+   free(c->uniques);
+   free(c->unique_heads);
+   free(c->buf);
+   free(c);
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Report                                                  ---*/
+/*---------------------------------------------------------------*/
+
+static int cmp_errors ( const void* a, const void* b )
+{
+   const MergedError* ea = *(const MergedError* const*)a;
+   const MergedError* eb = *(const MergedError* const*)b;
+   if (ea->n_occurrences != eb->n_occurrences)
+      return ea->n_occurrences > eb->n_occurrences ? -1 : 1;
+   if (ea->n_processes != eb->n_processes)
+      return ea->n_processes > eb->n_processes ? -1 : 1;
+   return strcmp(ea->key, eb->key);
+}
+
+static void print_report ( void )
+{
+   MergedError** all = xmalloc((n_merged_errors + 1) * sizeof(MergedError*));
+   unsigned i, n = 0;
+   unsigned long long total = 0;
+
+   for (i = 0; i < N_ERR_BUCKETS; i++) {
+      MergedError* e;
+      for (e = err_buckets[i]; e != NULL; e = e->next) {
+         all[n++] = e;
+         total += e->n_occurrences;
+      }
+   }
+   assert(n == n_merged_errors);
+   qsort(all, n, sizeof(MergedError*), cmp_errors);
+
+   printf("\nvalgrind-collector: %u processes, %llu errors "
+          "(%u after merging)\n", n_processes_seen, total, n);
+   for (i = 0; i < n; i++) {
+      MergedError* e = all[i];
+      const char* nl = strchr(e->key, '\n');
+      printf("\n== %llu occurrence%s in %u process%s (first pid %d): %.*s\n",
+             e->n_occurrences, e->n_occurrences == 1 ? "" : "s",
+             e->n_processes, e->n_processes == 1 ? "" : "es",
+             e->first_pid,
+             nl ? (int)(nl - e->key) : (int)strlen(e->key), e->key);
+      if (e->leaked_bytes > 0)
+         printf("%llu bytes leaked in total\n", e->leaked_bytes);
+      printf("%s\n%s", e->what ? e->what : "", e->stack ? e->stack : "");
+   }
+   fflush(stdout);
+   free(all);
+}
+
+
+/*---------------------------------------------------------------*/
+
+/* returns 0 if negative, or > BOUND or invalid characters were found */
+static int atoi_with_bound ( const char* str, int bound )
+{
+   int n = 0;
+   while (1) {
+      if (*str == 0)
+         break;
+      if (*str < '0' || *str > '9')
+         return 0;
+      n = 10*n + (int)(*str - '0');
+      str++;
+      if (n >= bound)
+         return 0;
+   }
+   return n;
+}
+
+/* returns 0 if invalid, else port # */
+static int atoi_portno ( const char* str )
+{
+   int n = atoi_with_bound(str, 65536);
+
+   if (n < 1024)
+      return 0;
+   return n;
+}
+
+
+static void usage ( void )
+{
+   fprintf(stderr,
+      "\n"
+      "usage is:\n"
+      "\n"
+      "   valgrind-collector [--exit-at-zero|-e] [--max-connect=INT] [port-number]\n"
+      "\n"
+      "   Run the processes to collect from with\n"
+      "      --xml=yes --xml-socket=IP-ADDRESS:port-number\n"
+      "   The merged errors are printed when the collector exits.\n"
+      "\n"
+      "   where   --exit-at-zero or -e causes the collector to exit\n"
+      "           when the number of connections falls back to zero\n"
+      "           (the default is to collect until Control-C)\n"
+      "\n"
+      "           --max-connect=INT can be used to increase the maximum\n"
+      "           number of connected processes (default = %d).\n"
+      "           INT must be positive and less than %d.\n"
+      "\n"
+      "           port-number is the default port on which to listen for\n"
+      "           connections.  It must be between 1024 and 65535.\n"
+      "           Current default is %d.\n"
+      "\n"
+      ,
+      M_CONNECTIONS_DEFAULT, M_CONNECTIONS_MAX, VG_CLO_DEFAULT_LOGPORT
+   );
+   exit(1);
+}
+
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void sigint_handler ( int signo )
+{
+   interrupted = 1;
+}
+
+
+int main (int argc, char** argv)
+{
+   int    i, j, res, one;
+   int    main_sd, new_sd;
+   socklen_t client_len;
+   struct sockaddr_in client_addr, server_addr;
+   struct sigaction sa;
+
+   char /*bool*/ exit_when_zero = 0;
+   int           port = VG_CLO_DEFAULT_LOGPORT;
+
+   for (i = 1; i < argc; i++) {
+      if (0==strcmp(argv[i], "--exit-at-zero")
+          || 0==strcmp(argv[i], "-e")) {
+         exit_when_zero = 1;
+      }
+      else if (0 == strncmp(argv[i], "--max-connect=", 14)) {
+         M_CONNECTIONS = atoi_with_bound(strchr(argv[i], '=') + 1, 5000);
+         if (M_CONNECTIONS <= 0 || M_CONNECTIONS > M_CONNECTIONS_MAX)
+            usage();
+      }
+      else
+      if (atoi_portno(argv[i]) > 0) {
+         port = atoi_portno(argv[i]);
+      }
+      else
+      usage();
+   }
+
+   if (M_CONNECTIONS == 0)   // nothing specified on command line
+      M_CONNECTIONS = M_CONNECTIONS_DEFAULT;
+
+   /* One more for the listening socket. */
+   conn_pollfd = malloc((M_CONNECTIONS + 1) * sizeof conn_pollfd[0]);
+   if (conn_pollfd == NULL) {
+      fprintf(stderr, "Memory allocation failed; cannot continue.\n");
+      exit(1);
+   }
+
+   /* No SA_RESTART, so that poll returns when interrupted. */
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = sigint_handler;
+   sigemptyset(&sa.sa_mask);
+   sigaction(SIGINT, &sa, NULL);
+   sigaction(SIGTERM, &sa, NULL);
+
+   /* create socket */
+   main_sd = socket(AF_INET, SOCK_STREAM, 0);
+   if (main_sd < 0) {
+      perror("cannot open socket ");
+      panic("main -- create socket");
+   }
+
+   /* allow address reuse to avoid "address already in use" errors */
+
+   one = 1;
+   if (setsockopt(main_sd, SOL_SOCKET, SO_REUSEADDR,
+                  &one, sizeof(int)) < 0) {
+      perror("cannot enable address reuse ");
+      panic("main -- enable address reuse");
+   }
+
+   /* bind server port */
+   server_addr.sin_family      = AF_INET;
+   server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   server_addr.sin_port        = htons(port);
+
+   if (bind(main_sd, (struct sockaddr *) &server_addr,
+                     sizeof(server_addr) ) < 0) {
+      perror("cannot bind port ");
+      panic("main -- bind port");
+   }
+
+   res = listen(main_sd,M_CONNECTIONS);
+   if (res != 0) {
+      perror("listen failed ");
+      panic("main -- listen");
+   }
+
+   fprintf(stderr, "valgrind-collector: listening on port %d\n", port);
+
+   while (!interrupted) {
+
+      /* Wait for a new connection or for data on the existing ones. */
+      conn_pollfd[0].fd = main_sd;
+      conn_pollfd[0].events = POLLIN;
+      res = poll(conn_pollfd, conn_count + 1, -1);
+      if (res < 0) {
+         if (errno == EINTR)
+            continue;
+         perror("poll(main) failed");
+         panic("poll(main) failed");
+      }
+
+      /* inspect the connections.  Going down, a closed connection is
+         replaced by one that has already been inspected. */
+      for (j = conn_count; j > 0; j--) {
+         if (!(conn_pollfd[j].revents & (POLLIN|POLLHUP|POLLERR)))
+            continue;
+         if (read_from_conn(conn_by_fd[conn_pollfd[j].fd]) == 0)
+            close_conn(j);
+      }
+
+      /* someone is trying to connect; get the fd and add it to our
+         table thereof. */
+      if (conn_pollfd[0].revents & POLLIN) {
+         client_len = sizeof(client_addr);
+         new_sd = accept(main_sd, (struct sockaddr *)&client_addr,
+                                                     &client_len);
+         if (new_sd < 0) {
+            perror("cannot accept connection ");
+            panic("main -- accept connection");
+         }
+
+         if (conn_count >= M_CONNECTIONS) {
+            fprintf(stderr, "\n\nMore than %d concurrent connections.\n"
+                    "Restart the collector giving --max-connect=INT on the\n"
+                    "commandline to increase the limit.\n\n",
+                    M_CONNECTIONS);
+            exit(1);
+         }
+
+         n_processes_seen++;
+         add_conn(new_sd, n_processes_seen);
+      }
+
+      if (conn_count == 0 && exit_when_zero && n_processes_seen > 0)
+         break;
+   }
+
+   /* Merge what has been received from processes still connected. */
+   while (conn_count > 0)
+      close_conn(conn_count);
+
+   print_report();
+   return 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*--- end                                     valgrind-collector.c ---*/
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,719 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Merge and convert binary xtree files.                        ---*/
+/*---                                       valgrind-xtree-merge.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2023 The Valgrind developers.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* valgrind-xtree-merge reads one or more binary xtree files, as
+   produced with e.g. --xtree-memory-file=xtmemory.xtb.%p, and merges
+   them: stacks made of the same functions/files/lines are added
+   together, whatever the addresses were in the processes that produced
+   them.  The result can be written as a binary xtree file, or converted
+   to the callgrind and massif formats produced by valgrind itself.
+   The binary format is described in coregrind/m_xtree.c. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define XT_BINARY_MAGIC "VGXTREE1"
+
+__attribute__ ((noreturn))
+static void fail ( const char* fmt, const char* arg )
+{
+   fprintf(stderr, "valgrind-xtree-merge: ");
+   fprintf(stderr, fmt, arg);
+   fprintf(stderr, "\n");
+   exit(1);
+}
+
+static void* xmalloc ( size_t n )
+{
+   void* p = malloc(n ? n : 1);
+   if (p == NULL)
+      fail("%s", "out of memory");
+   return p;
+}
+
+static void* xrealloc ( void* p, size_t n )
+{
+   p = realloc(p, n ? n : 1);
+   if (p == NULL)
+      fail("%s", "out of memory");
+   return p;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- A hash table mapping byte strings to numbers            ---*/
+/*---------------------------------------------------------------*/
+
+/* Maps keys (byte strings) to consecutive numbers 0, 1, ...  The keys
+   are copied; key(n) gives back the key of number n. */
+typedef
+   struct {
+      unsigned* slots;       /* 1 + number, or 0 if empty */
+      unsigned  n_slots;     /* a power of 2 */
+      char**    keys;
+      unsigned* key_lens;
+      unsigned  n_keys, size_keys;
+   }
+   Dict;
+
+static unsigned hash_bytes ( const void* p, unsigned len )
+{
+   /* FNV-1a */
+   const unsigned char* s = p;
+   unsigned h = 2166136261u;
+   unsigned i;
+   for (i = 0; i < len; i++) {
+      h ^= s[i];
+      h *= 16777619u;
+   }
+   return h;
+}
+
+static void dict_init ( Dict* d )
+{
+   memset(d, 0, sizeof(Dict));
+   d->n_slots = 1024;
+   d->slots = calloc(d->n_slots, sizeof(unsigned));
+   if (d->slots == NULL)
+      fail("%s", "out of memory");
+}
+
+static void dict_grow ( Dict* d )
+{
+   unsigned  n_slots = 2 * d->n_slots;
+   unsigned* slots = calloc(n_slots, sizeof(unsigned));
+   unsigned  i;
+   if (slots == NULL)
+      fail("%s", "out of memory");
+   for (i = 0; i < d->n_keys; i++) {
+      unsigned s = hash_bytes(d->keys[i], d->key_lens[i]) & (n_slots - 1);
+      while (slots[s] != 0)
+         s = (s + 1) & (n_slots - 1);
+      slots[s] = i + 1;
+   }
+   free(d->slots);
+   d->slots = slots;
+   d->n_slots = n_slots;
+}
+
+/* Returns the number of key, adding it if needed.  *is_new tells if it
+   was added. */
+static unsigned dict_add ( Dict* d, const void* key, unsigned len,
+                           int* is_new )
+{
+   unsigned s = hash_bytes(key, len) & (d->n_slots - 1);
+   while (d->slots[s] != 0) {
+      unsigned n = d->slots[s] - 1;
+      if (d->key_lens[n] == len && 0 == memcmp(d->keys[n], key, len)) {
+         if (is_new) *is_new = 0;
+         return n;
+      }
+      s = (s + 1) & (d->n_slots - 1);
+   }
+   if (d->n_keys == d->size_keys) {
+      d->size_keys = d->size_keys ? 2 * d->size_keys : 1024;
+      d->keys = xrealloc(d->keys, d->size_keys * sizeof(char*));
+      d->key_lens = xrealloc(d->key_lens, d->size_keys * sizeof(unsigned));
+   }
+   d->keys[d->n_keys] = xmalloc(len + 1);
+   memcpy(d->keys[d->n_keys], key, len);
+   d->keys[d->n_keys][len] = 0;
+   d->key_lens[d->n_keys] = len;
+   d->slots[s] = ++d->n_keys;
+   if (2 * d->n_keys > d->n_slots)
+      dict_grow(d);
+   if (is_new) *is_new = 1;
+   return d->n_keys - 1;
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- The merged xtree                                        ---*/
+/*---------------------------------------------------------------*/
+
+typedef
+   struct {
+      uint64_t ip;          /* ip of the first occurrence */
+      unsigned fn, file, line;
+   }
+   Frame;
+
+typedef
+   struct {
+      unsigned  n_ips;
+      unsigned* ips;        /* frame numbers, innermost first */
+      uint64_t* values;     /* n_events values */
+   }
+   Stack;
+
+static Dict strings;        /* the merged strings */
+static Dict frame_keys;     /* fn, file, line => merged frame number */
+static Frame* frames;
+static unsigned size_frames;
+static Dict stack_keys;     /* frame numbers => merged stack number */
+static Stack* stacks;
+static unsigned size_stacks;
+
+static char*    events;     /* events of the first file */
+static unsigned n_events;
+static char*    cmd;        /* cmd of the first file */
+static unsigned pid;        /* pid of the first file */
+
+/* Reading a binary file. */
+typedef
+   struct {
+      const char* name;
+      unsigned char* data;
+      size_t size, pos;
+   }
+   Input;
+
+static void get ( Input* in, void* p, size_t n )
+{
+   if (in->size - in->pos < n)
+      fail("%s: truncated or corrupted file", in->name);
+   memcpy(p, in->data + in->pos, n);
+   in->pos += n;
+}
+
+static unsigned get_u32 ( Input* in )
+{
+   uint32_t v;
+   get(in, &v, sizeof(v));
+   return v;
+}
+
+static uint64_t get_u64 ( Input* in )
+{
+   uint64_t v;
+   get(in, &v, sizeof(v));
+   return v;
+}
+
+/* Returns a pointer to the (not zero terminated) string, setting *len. */
+static const char* get_str ( Input* in, unsigned* len )
+{
+   const char* s;
+   *len = get_u32(in);
+   if (in->size - in->pos < *len)
+      fail("%s: truncated or corrupted file", in->name);
+   s = (const char*)in->data + in->pos;
+   in->pos += *len;
+   return s;
+}
+
+static void read_file ( Input* in )
+{
+   FILE* f = fopen(in->name, "rb");
+   size_t n;
+   if (f == NULL)
+      fail("cannot open %s", in->name);
+   in->size = 0;
+   in->data = NULL;
+   do {
+      in->data = xrealloc(in->data, in->size + 65536);
+      n = fread(in->data + in->size, 1, 65536, f);
+      in->size += n;
+   } while (n == 65536);
+   if (ferror(f))
+      fail("error reading %s", in->name);
+   fclose(f);
+   in->pos = 0;
+}
+
+static void merge_file ( const char* name )
+{
+   Input in;
+   char magic[8];
+   const char* s;
+   unsigned len, i, j, n;
+   unsigned *str_map, *frame_map;
+
+   in.name = name;
+   read_file(&in);
+   get(&in, magic, 8);
+   if (0 != memcmp(magic, XT_BINARY_MAGIC, 8))
+      fail("%s: not a binary xtree file", name);
+
+   unsigned file_pid = get_u32(&in);
+   s = get_str(&in, &len);
+   if (cmd == NULL) {
+      pid = file_pid;
+      cmd = xmalloc(len + 1);
+      memcpy(cmd, s, len);
+      cmd[len] = 0;
+   }
+   s = get_str(&in, &len);
+   if (events == NULL) {
+      events = xmalloc(len + 1);
+      memcpy(events, s, len);
+      events[len] = 0;
+      n_events = 1;
+      for (i = 0; i < len; i++)
+         if (events[i] == ',')
+            n_events++;
+   } else if (len != strlen(events) || 0 != memcmp(s, events, len)) {
+      fail("%s: events differ from the events of the first file", name);
+   }
+
+   n = get_u32(&in);
+   unsigned n_strs = n;
+   str_map = xmalloc(n * sizeof(unsigned));
+   for (i = 0; i < n; i++) {
+      s = get_str(&in, &len);
+      str_map[i] = dict_add(&strings, s, len, NULL);
+   }
+
+   n = get_u32(&in);
+   frame_map = xmalloc(n * sizeof(unsigned));
+   for (i = 0; i < n; i++) {
+      Frame fr;
+      unsigned key[3];
+      int is_new;
+      fr.ip = get_u64(&in);
+      fr.fn = get_u32(&in);
+      fr.file = get_u32(&in);
+      fr.line = get_u32(&in);
+      if (fr.fn >= n_strs || fr.file >= n_strs)
+         fail("%s: corrupted frame", name);
+      fr.fn = str_map[fr.fn];
+      fr.file = str_map[fr.file];
+      key[0] = fr.fn; key[1] = fr.file; key[2] = fr.line;
+      frame_map[i] = dict_add(&frame_keys, key, sizeof(key), &is_new);
+      if (is_new) {
+         if (frame_map[i] == size_frames) {
+            size_frames = size_frames ? 2 * size_frames : 1024;
+            frames = xrealloc(frames, size_frames * sizeof(Frame));
+         }
+         frames[frame_map[i]] = fr;
+      }
+   }
+   unsigned n_frames = n;
+
+   n = get_u32(&in);
+   unsigned* ips = NULL;
+   unsigned size_ips = 0;
+   for (i = 0; i < n; i++) {
+      unsigned n_ips = get_u32(&in);
+      int is_new;
+      if (n_ips > size_ips) {
+         size_ips = n_ips;
+         ips = xrealloc(ips, size_ips * sizeof(unsigned));
+      }
+      for (j = 0; j < n_ips; j++) {
+         unsigned f = get_u32(&in);
+         if (f >= n_frames)
+            fail("%s: corrupted stack", name);
+         ips[j] = frame_map[f];
+      }
+      unsigned st = dict_add(&stack_keys, ips, n_ips * sizeof(unsigned),
+                             &is_new);
+      if (is_new) {
+         if (st == size_stacks) {
+            size_stacks = size_stacks ? 2 * size_stacks : 1024;
+            stacks = xrealloc(stacks, size_stacks * sizeof(Stack));
+         }
+         stacks[st].n_ips = n_ips;
+         stacks[st].ips = (unsigned*)stack_keys.keys[st];
+         stacks[st].values = calloc(n_events, sizeof(uint64_t));
+         if (stacks[st].values == NULL)
+            fail("%s", "out of memory");
+      }
+      for (j = 0; j < n_events; j++)
+         stacks[st].values[j] += get_u64(&in);
+   }
+   if (in.pos != in.size)
+      fail("%s: trailing garbage", name);
+
+   free(ips);
+   free(frame_map);
+   free(str_map);
+   free(in.data);
+}
+
+
+/*---------------------------------------------------------------*/
+/*--- Output                                                  ---*/
+/*---------------------------------------------------------------*/
+
+static FILE* open_out ( const char* name )
+{
+   FILE* f = fopen(name, "wb");
+   if (f == NULL)
+      fail("cannot create %s", name);
+   return f;
+}
+
+static void close_out ( FILE* f, const char* name )
+{
+   if (ferror(f) || fclose(f) != 0)
+      fail("error writing %s", name);
+}
+
+static void put_u32 ( FILE* f, unsigned v )
+{
+   uint32_t u = v;
+   fwrite(&u, sizeof(u), 1, f);
+}
+
+static void put_u64 ( FILE* f, uint64_t v )
+{
+   fwrite(&v, sizeof(v), 1, f);
+}
+
+static void put_str ( FILE* f, const char* s, unsigned len )
+{
+   put_u32(f, len);
+   fwrite(s, 1, len, f);
+}
+
+static void write_binary ( const char* name )
+{
+   FILE* f = open_out(name);
+   unsigned i, j;
+
+   fwrite(XT_BINARY_MAGIC, 1, 8, f);
+   put_u32(f, pid);
+   put_str(f, cmd, strlen(cmd));
+   put_str(f, events, strlen(events));
+   put_u32(f, strings.n_keys);
+   for (i = 0; i < strings.n_keys; i++)
+      put_str(f, strings.keys[i], strings.key_lens[i]);
+   put_u32(f, frame_keys.n_keys);
+   for (i = 0; i < frame_keys.n_keys; i++) {
+      put_u64(f, frames[i].ip);
+      put_u32(f, frames[i].fn);
+      put_u32(f, frames[i].file);
+      put_u32(f, frames[i].line);
+   }
+   put_u32(f, stack_keys.n_keys);
+   for (i = 0; i < stack_keys.n_keys; i++) {
+      put_u32(f, stacks[i].n_ips);
+      for (j = 0; j < stacks[i].n_ips; j++)
+         put_u32(f, stacks[i].ips[j]);
+      for (j = 0; j < n_events; j++)
+         put_u64(f, stacks[i].values[j]);
+   }
+   close_out(f, name);
+}
+
+/* Output a compressed callgrind name=(pos) element, as done by
+   VG_(XT_callgrind_print). */
+static void put_pos_str ( FILE* f, const char* name, unsigned str,
+                          unsigned char* seen )
+{
+   if (seen[str])
+      fprintf(f, "%s=(%u)\n", name, str + 1);
+   else
+      fprintf(f, "%s=(%u) %s\n", name, str + 1, strings.keys[str]);
+}
+
+static void put_values ( FILE* f, const uint64_t* values )
+{
+   unsigned i;
+   for (i = 0; i < n_events; i++)
+      fprintf(f, "%s%llu", i ? " " : "", (unsigned long long)values[i]);
+}
+
+static void write_callgrind ( const char* name )
+{
+   FILE* f = open_out(name);
+   /* Which strings have been output as file names resp. function names.
+      VG_(XT_callgrind_print) numbers them separately, so do the same,
+      but with the numbers of the merged string table. */
+   unsigned char* fl_seen = calloc(strings.n_keys + 1, 1);
+   unsigned char* fn_seen = calloc(strings.n_keys + 1, 1);
+   uint64_t* totals = calloc(n_events, sizeof(uint64_t));
+   char* e;
+   char* ev = strdup(events);
+   unsigned i, j;
+
+   if (fl_seen == NULL || fn_seen == NULL || totals == NULL || ev == NULL)
+      fail("%s", "out of memory");
+
+   fprintf(f, "# callgrind format\n");
+   fprintf(f, "version: 1\n");
+   fprintf(f, "creator: xtree-1\n");
+   fprintf(f, "pid: %u\n", pid);
+   fprintf(f, "cmd: %s\n", cmd);
+   fprintf(f, "\npositions:%s\n", " line");
+   for (e = strtok(ev, ","); e != NULL; e = strtok(NULL, ","))
+      fprintf(f, "event: %s\n", e);
+   fprintf(f, "events:");
+   strcpy(ev, events);
+   for (e = strtok(ev, ","); e != NULL; e = strtok(NULL, ",")) {
+      char* p = strchr(e, ':');
+      if (p) *p = 0;
+      fprintf(f, " %s", e);
+   }
+   fprintf(f, "\n");
+
+   for (i = 0; i < stack_keys.n_keys; i++) {
+      const Stack* st = &stacks[i];
+      int k;
+      if (st->n_ips == 0)
+         continue;
+      for (j = 0; j < n_events; j++)
+         totals[j] += st->values[j];
+      for (k = st->n_ips - 1; k >= 0; k--) {
+         const Frame* fr = &frames[st->ips[k]];
+         put_pos_str(f, "fl", fr->file, fl_seen);
+         fl_seen[fr->file] = 1;
+         put_pos_str(f, "fn", fr->fn, fn_seen);
+         fn_seen[fr->fn] = 1;
+         if (k == 0) {
+            fprintf(f, "%u ", fr->line);
+            put_values(f, st->values);
+            fprintf(f, "\n");
+         } else {
+            const Frame* called = &frames[st->ips[k-1]];
+            fprintf(f, "%u\n", fr->line);
+            put_pos_str(f, "cfi", called->file, fl_seen);
+            fl_seen[called->file] = 1;
+            put_pos_str(f, "cfn", called->fn, fn_seen);
+            fn_seen[called->fn] = 1;
+            fprintf(f, "calls=0 %u\n", called->line);
+            fprintf(f, "%u ", fr->line);
+            put_values(f, st->values);
+            fprintf(f, "\n");
+         }
+      }
+      fprintf(f, "\n");
+   }
+   fprintf(f, "totals: ");
+   put_values(f, totals);
+   fprintf(f, "\n");
+   close_out(f, name);
+   free(fl_seen);
+   free(fn_seen);
+   free(totals);
+   free(ev);
+}
+
+/* Massif output: one detailed snapshot per event.  The tree is built
+   from the innermost frame, as done by VG_(XT_massif_print), but
+   without a significance threshold: only zero subtrees are omitted. */
+
+static unsigned cur_event;
+
+static int cmp_stacks ( const void* va, const void* vb )
+{
+   const Stack* a = &stacks[*(const unsigned*)va];
+   const Stack* b = &stacks[*(const unsigned*)vb];
+   unsigned i;
+   for (i = 0; i < a->n_ips && i < b->n_ips; i++)
+      if (a->ips[i] != b->ips[i])
+         return a->ips[i] < b->ips[i] ? -1 : 1;
+   return a->n_ips < b->n_ips ? -1 : a->n_ips > b->n_ips ? 1 : 0;
+}
+
+typedef
+   struct {
+      unsigned first, end;  /* range in the sorted stack numbers */
+      uint64_t total;
+   }
+   Group;
+
+static int cmp_groups ( const void* va, const void* vb )
+{
+   const Group* a = va;
+   const Group* b = vb;
+   return a->total > b->total ? -1 : a->total < b->total ? 1 : 0;
+}
+
+/* Make in *groups the non zero groups of sorted[first..end-1] at
+   depth, that is the sets of stacks having the same frame at depth,
+   biggest first.  Returns the number of groups. */
+static unsigned make_groups ( const unsigned* sorted, unsigned first,
+                              unsigned end, unsigned depth, Group** groups )
+{
+   unsigned n = 0, i = first;
+   *groups = xmalloc((end - first) * sizeof(Group));
+   while (i < end) {
+      const Stack* st = &stacks[sorted[i]];
+      if (st->n_ips <= depth) {
+         i++;
+         continue;
+      }
+      Group g = { i, i, 0 };
+      while (g.end < end
+             && stacks[sorted[g.end]].n_ips > depth
+             && stacks[sorted[g.end]].ips[depth] == st->ips[depth]) {
+         g.total += stacks[sorted[g.end]].values[cur_event];
+         g.end++;
+      }
+      if (g.total > 0)
+         (*groups)[n++] = g;
+      i = g.end;
+   }
+   qsort(*groups, n, sizeof(Group), cmp_groups);
+   return n;
+}
+
+static void output_group ( FILE* f, const unsigned* sorted,
+                           const Group* g, unsigned depth )
+{
+   Group* groups;
+   unsigned n = make_groups(sorted, g->first, g->end, depth + 1, &groups);
+   unsigned i;
+   const Frame* fr = &frames[stacks[sorted[g->first]].ips[depth]];
+   const char* file = strings.keys[fr->file];
+   const char* base = strrchr(file, '/');
+
+   fprintf(f, "%*sn%u: %llu 0x%llX: %s", (int)depth + 1, "", n,
+           (unsigned long long)g->total, (unsigned long long)fr->ip,
+           strings.keys[fr->fn]);
+   if (fr->line > 0)
+      fprintf(f, " (%s:%u)", base ? base + 1 : file, fr->line);
+   fprintf(f, "\n");
+   for (i = 0; i < n; i++)
+      output_group(f, sorted, &groups[i], depth + 1);
+   free(groups);
+}
+
+static void write_massif ( const char* name )
+{
+   FILE* f = open_out(name);
+   unsigned* sorted = xmalloc(stack_keys.n_keys * sizeof(unsigned));
+   char* ev = strdup(events);
+   char* e;
+   unsigned i;
+
+   if (ev == NULL)
+      fail("%s", "out of memory");
+   for (i = 0; i < stack_keys.n_keys; i++)
+      sorted[i] = i;
+   qsort(sorted, stack_keys.n_keys, sizeof(unsigned), cmp_stacks);
+
+   fprintf(f, "desc: valgrind-xtree-merge\n");
+   fprintf(f, "cmd: %s\n", cmd);
+   fprintf(f, "time_unit: ms\n");
+
+   cur_event = 0;
+   for (e = strtok(ev, ","); e != NULL; e = strtok(NULL, ",")) {
+      uint64_t total = 0;
+      Group* groups;
+      unsigned n;
+
+      for (i = 0; i < stack_keys.n_keys; i++)
+         total += stacks[i].values[cur_event];
+      n = make_groups(sorted, 0, stack_keys.n_keys, 0, &groups);
+
+      fprintf(f, "#-----------\n");
+      fprintf(f, "snapshot=%u\n", cur_event);
+      fprintf(f, "#-----------\n");
+      fprintf(f, "time=0\n");
+      fprintf(f, "mem_heap_B=%llu\n", (unsigned long long)total);
+      fprintf(f, "mem_heap_extra_B=0\n");
+      fprintf(f, "mem_stacks_B=0\n");
+      fprintf(f, "heap_tree=detailed\n");
+      fprintf(f, "n%u: %llu %s\n", n, (unsigned long long)total, e);
+      for (i = 0; i < n; i++)
+         output_group(f, sorted, &groups[i], 0);
+      free(groups);
+      cur_event++;
+   }
+   close_out(f, name);
+   free(sorted);
+   free(ev);
+}
+
+
+/*---------------------------------------------------------------*/
+
+static void usage ( void )
+{
+   fprintf(stderr,
+      "\n"
+      "usage is:\n"
+      "\n"
+      "   valgrind-xtree-merge [-o FILE] [--callgrind=FILE] [--massif=FILE]\n"
+      "                        xtree-file.xtb ...\n"
+      "\n"
+      "   Merges the given binary xtree files, e.g. produced with\n"
+      "   --xtree-memory-file=xtmemory.xtb.%%p, and writes the result in:\n"
+      "      -o FILE            a binary xtree file\n"
+      "      --callgrind=FILE   a callgrind format file\n"
+      "      --massif=FILE      a massif format file\n"
+      "   At least one output must be given.\n"
+      "\n");
+   exit(1);
+}
+
+int main ( int argc, char** argv )
+{
+   const char* out_binary = NULL;
+   const char* out_callgrind = NULL;
+   const char* out_massif = NULL;
+   int i, n_inputs = 0;
+
+   dict_init(&strings);
+   dict_init(&frame_keys);
+   dict_init(&stack_keys);
+
+   for (i = 1; i < argc; i++) {
+      if (0 == strcmp(argv[i], "-o") && i + 1 < argc)
+         out_binary = argv[++i];
+      else if (0 == strncmp(argv[i], "--callgrind=", 12))
+         out_callgrind = argv[i] + 12;
+      else if (0 == strncmp(argv[i], "--massif=", 9))
+         out_massif = argv[i] + 9;
+      else if (argv[i][0] == '-')
+         usage();
+   }
+   if (out_binary == NULL && out_callgrind == NULL && out_massif == NULL)
+      usage();
+
+   for (i = 1; i < argc; i++) {
+      if (0 == strcmp(argv[i], "-o")) {
+         i++;
+         continue;
+      }
+      if (argv[i][0] == '-')
+         continue;
+      merge_file(argv[i]);
+      n_inputs++;
+   }
+   if (n_inputs == 0)
+      usage();
+
+   if (out_binary)
+      write_binary(out_binary);
+   if (out_callgrind)
+      write_callgrind(out_callgrind);
+   if (out_massif)
+      write_massif(out_massif);
+   return 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*--- end                                   valgrind-xtree-merge.c ---*/
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,762 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Benchmark of the VEX translation pipeline.       vex-bench.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* vex-bench translates the code of a real binary with LibVEX_Translate,
+   without running anything, and reports how much time each phase of
+   the pipeline took and how many guest instructions per second it
+   processed.  It is meant for evaluating changes to VEX quickly: the
+   input is fixed (an ELF file), so runs are deterministic apart from
+   the timing, and a checksum of the generated code shows whether two
+   VEX builds produce the same output.
+
+   The guest code is taken from the function symbols of the ELF file:
+   a superblock is translated at the start of each function, then at
+   the end of the previous superblock, until the end of the function.
+   Without a symbol table, the executable sections are swept linearly.
+   The guest architecture is that of the ELF file; the host is the
+   machine's own by default, and can be any other one VEX supports.
+
+   Tool instrumentation is simulated with stubs: "light" adds a helper
+   call per guest instruction (like lackey's or exp-bbv's counting),
+   "heavy" additionally adds a helper call per memory access with its
+   address (like lackey --trace-mem=yes).  The helpers are never run. */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libvex_basictypes.h"
+#include "libvex.h"
+#include "libvex_ir.h"
+
+/* ------------------------------------------------------------------ */
+/* --- ELF reading                                                  --- */
+/* ------------------------------------------------------------------ */
+
+/* The few ELF definitions needed; <elf.h> is not available everywhere
+   and the file may be for another architecture and byte order. */
+#define ELFCLASS64      2
+#define ELFDATA2MSB     2
+#define SHT_SYMTAB      2
+#define SHF_EXECINSTR   0x4
+#define STT_FUNC        2
+
+#define EM_386          3
+#define EM_MIPS         8
+#define EM_PPC          20
+#define EM_PPC64        21
+#define EM_S390         22
+#define EM_ARM          40
+#define EM_X86_64       62
+#define EM_AARCH64      183
+#define EM_RISCV        243
+
+/* The front ends may read a little past the end of the code they are
+   given; the file image is followed by this many zero bytes. */
+#define IMAGE_PADDING   4096
+
+/* ARM Thumb decoding looks at up to 18 bytes before the instruction. */
+#define ARM_LOOKBEHIND  18
+
+typedef
+   struct {
+      UChar* img;
+      SizeT  size;
+      Bool   is64;
+      Bool   bigendian;
+   }
+   ElfImage;
+
+typedef
+   struct {
+      Addr   addr;    /* guest address of the code */
+      SizeT  offset;  /* and its offset in the file */
+      SizeT  size;
+   }
+   CodeRange;
+
+static ULong get_uint ( const ElfImage* ei, SizeT off, Int nbytes )
+{
+   ULong v = 0;
+   Int i;
+
+   if (off + nbytes > ei->size) {
+      fprintf(stderr, "vex-bench: truncated ELF file\n");
+      exit(1);
+   }
+   for (i = 0; i < nbytes; i++) {
+      Int b = ei->bigendian ? i : nbytes - 1 - i;
+      v = (v << 8) | ei->img[off + b];
+   }
+   return v;
+}
+
+/* Field accessors for the parts of the headers that differ between
+   32 and 64 bit files. */
+#define E16(off)        ((UInt)get_uint(ei, (off), 2))
+#define E32(off)        ((UInt)get_uint(ei, (off), 4))
+#define EWORD(off)      get_uint(ei, (off), ei->is64 ? 8 : 4)
+
+static void read_file ( const HChar* fname, ElfImage* ei )
+{
+   FILE* f = fopen(fname, "rb");
+   long size;
+
+   if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0) {
+      fprintf(stderr, "vex-bench: cannot read %s\n", fname);
+      exit(1);
+   }
+   rewind(f);
+   ei->size = size;
+   ei->img  = calloc(1, ei->size + IMAGE_PADDING);
+   if (ei->img == NULL || fread(ei->img, 1, ei->size, f) != ei->size) {
+      fprintf(stderr, "vex-bench: cannot read %s\n", fname);
+      exit(1);
+   }
+   fclose(f);
+
+   if (ei->size < 52 || memcmp(ei->img, "\177ELF", 4) != 0) {
+      fprintf(stderr, "vex-bench: %s is not an ELF file\n", fname);
+      exit(1);
+   }
+   ei->is64      = ei->img[4] == ELFCLASS64;
+   ei->bigendian = ei->img[5] == ELFDATA2MSB;
+   if (ei->is64 && ei->size < 64) {
+      fprintf(stderr, "vex-bench: truncated ELF file\n");
+      exit(1);
+   }
+}
+
+/* Whether [off, off + size) lies within the image. */
+static Bool in_image ( const ElfImage* ei, SizeT off, SizeT size )
+{
+   return off <= ei->size && size <= ei->size - off;
+}
+
+static VexArch elf_arch ( const ElfImage* ei )
+{
+   switch (E16(18)) {
+      case EM_386:     return VexArchX86;
+      case EM_X86_64:  return VexArchAMD64;
+      case EM_ARM:     return VexArchARM;
+      case EM_AARCH64: return VexArchARM64;
+      case EM_PPC:     return VexArchPPC32;
+      case EM_PPC64:   return VexArchPPC64;
+      case EM_S390:    return VexArchS390X;
+      case EM_MIPS:    return ei->is64 ? VexArchMIPS64 : VexArchMIPS32;
+      case EM_RISCV:   return VexArchRISCV64;
+      default:
+         fprintf(stderr, "vex-bench: unsupported ELF machine %u\n", E16(18));
+         exit(1);
+   }
+}
+
+/* Appends the code ranges to translate to *ranges: the function symbols
+   that lie in executable sections or, if there are none, the
+   executable sections themselves.  Returns the number of ranges. */
+static Int find_code ( const ElfImage* ei, CodeRange** ranges )
+{
+   SizeT shoff     = EWORD(ei->is64 ? 40 : 32);
+   UInt  shentsize = E16(ei->is64 ? 58 : 46);
+   UInt  shnum     = E16(ei->is64 ? 60 : 48);
+   Int   n = 0, n_max = 1024;
+   UInt  i, j;
+
+   /* The symbols and sections are trusted below only once their tables
+      are known to fit in the file. */
+   if (shnum > 0
+       && (shentsize < (ei->is64 ? 64 : 40)
+           || shoff > ei->size
+           || (ei->size - shoff) / shentsize < shnum)) {
+      fprintf(stderr, "vex-bench: bad section header table\n");
+      exit(1);
+   }
+
+   *ranges = malloc(n_max * sizeof(CodeRange));
+
+#  define SH(k, field32, field64) \
+      (shoff + (SizeT)(k) * shentsize + (ei->is64 ? (field64) : (field32)))
+#  define SH_TYPE(k)   E32(SH(k, 4, 4))
+#  define SH_FLAGS(k)  EWORD(SH(k, 8, 8))
+#  define SH_ADDR(k)   EWORD(SH(k, 12, 16))
+#  define SH_OFFSET(k) EWORD(SH(k, 16, 24))
+#  define SH_SIZE(k)   EWORD(SH(k, 20, 32))
+#  define SH_ENTSIZE(k) EWORD(SH(k, 36, 56))
+
+   for (i = 0; i < shnum; i++) {
+      SizeT symoff, symsize, entsize;
+
+      if (SH_TYPE(i) != SHT_SYMTAB)
+         continue;
+      symoff  = SH_OFFSET(i);
+      symsize = SH_SIZE(i);
+      entsize = SH_ENTSIZE(i);
+      if (entsize < (ei->is64 ? 24 : 16)
+          || !in_image(ei, symoff, symsize)) {
+         fprintf(stderr, "vex-bench: ignoring bad symbol table\n");
+         continue;
+      }
+      for (j = 1; j < symsize / entsize; j++) {
+         SizeT s = symoff + j * entsize;
+         UInt  info  = ei->img[s + (ei->is64 ? 4 : 12)];
+         UInt  shndx = E16(s + (ei->is64 ? 6 : 14));
+         Addr  value = EWORD(s + (ei->is64 ? 8 : 4));
+         SizeT size  = EWORD(s + (ei->is64 ? 16 : 8));
+         Addr  start;
+
+         if ((info & 0xf) != STT_FUNC || size == 0
+             || shndx == 0 || shndx >= shnum
+             || !(SH_FLAGS(shndx) & SHF_EXECINSTR))
+            continue;
+         /* The Thumb bit is not part of the address. */
+         start = value & ~(Addr)1;
+         if (start < SH_ADDR(shndx)
+             || size > SH_SIZE(shndx)
+             || start - SH_ADDR(shndx) > SH_SIZE(shndx) - size
+             || !in_image(ei, SH_OFFSET(shndx), SH_SIZE(shndx)))
+            continue;
+         if (n == n_max) {
+            n_max *= 2;
+            *ranges = realloc(*ranges, n_max * sizeof(CodeRange));
+         }
+         (*ranges)[n].addr   = value;
+         (*ranges)[n].offset = SH_OFFSET(shndx) + (start - SH_ADDR(shndx));
+         (*ranges)[n].size   = size;
+         n++;
+      }
+   }
+
+   if (n == 0) {
+      for (i = 0; i < shnum; i++) {
+         if (!(SH_FLAGS(i) & SHF_EXECINSTR)
+             || !in_image(ei, SH_OFFSET(i), SH_SIZE(i)))
+            continue;
+         if (n == n_max) {
+            n_max *= 2;
+            *ranges = realloc(*ranges, n_max * sizeof(CodeRange));
+         }
+         (*ranges)[n].addr   = SH_ADDR(i);
+         (*ranges)[n].offset = SH_OFFSET(i);
+         (*ranges)[n].size   = SH_SIZE(i);
+         n++;
+      }
+   }
+
+#  undef SH
+#  undef SH_TYPE
+#  undef SH_FLAGS
+#  undef SH_ADDR
+#  undef SH_OFFSET
+#  undef SH_SIZE
+#  undef SH_ENTSIZE
+
+   return n;
+}
+
+/* ------------------------------------------------------------------ */
+/* --- Architectures                                                --- */
+/* ------------------------------------------------------------------ */
+
+static const struct {
+   const HChar* name;
+   VexArch      arch;
+   Bool         mode64;
+}
+arch_table[] = {
+   { "x86",      VexArchX86,      False },
+   { "amd64",    VexArchAMD64,    True  },
+   { "arm",      VexArchARM,      False },
+   { "arm64",    VexArchARM64,    True  },
+   { "ppc32",    VexArchPPC32,    False },
+   { "ppc64",    VexArchPPC64,    True  },
+   { "s390x",    VexArchS390X,    True  },
+   { "mips32",   VexArchMIPS32,   False },
+   { "mips64",   VexArchMIPS64,   True  },
+   { "nanomips", VexArchNANOMIPS, False },
+   { "riscv64",  VexArchRISCV64,  True  },
+};
+#define N_ARCHS (sizeof(arch_table) / sizeof(arch_table[0]))
+
+static Int arch_index ( VexArch va )
+{
+   UInt i;
+   for (i = 0; i < N_ARCHS; i++)
+      if (arch_table[i].arch == va)
+         return i;
+   return -1;
+}
+
+static VexArch native_arch ( void )
+{
+#if defined(VGA_x86)
+   return VexArchX86;
+#elif defined(VGA_amd64)
+   return VexArchAMD64;
+#elif defined(VGA_arm)
+   return VexArchARM;
+#elif defined(VGA_arm64)
+   return VexArchARM64;
+#elif defined(VGA_ppc32)
+   return VexArchPPC32;
+#elif defined(VGA_ppc64be) || defined(VGA_ppc64le)
+   return VexArchPPC64;
+#elif defined(VGA_s390x)
+   return VexArchS390X;
+#elif defined(VGA_mips32)
+   return VexArchMIPS32;
+#elif defined(VGA_mips64)
+   return VexArchMIPS64;
+#elif defined(VGA_nanomips)
+   return VexArchNANOMIPS;
+#elif defined(VGA_riscv64)
+   return VexArchRISCV64;
+#else
+#  error "Unknown arch"
+#endif
+}
+
+/* Hardware capabilities that let the front ends decode the code that
+   compilers commonly emit, and the back ends use it. */
+static void set_archinfo ( VexArch va, VexEndness endness, VexArchInfo* vai )
+{
+   LibVEX_default_VexArchInfo(vai);
+   vai->endness = endness;
+   switch (va) {
+      case VexArchX86:
+         vai->hwcaps = VEX_HWCAPS_X86_MMXEXT | VEX_HWCAPS_X86_SSE1
+                       | VEX_HWCAPS_X86_SSE2 | VEX_HWCAPS_X86_SSE3;
+         break;
+      case VexArchAMD64:
+         vai->hwcaps = VEX_HWCAPS_AMD64_SSE3 | VEX_HWCAPS_AMD64_SSSE3
+                       | VEX_HWCAPS_AMD64_CX16 | VEX_HWCAPS_AMD64_LZCNT
+                       | VEX_HWCAPS_AMD64_AVX | VEX_HWCAPS_AMD64_RDTSCP
+                       | VEX_HWCAPS_AMD64_BMI | VEX_HWCAPS_AMD64_AVX2;
+         break;
+      case VexArchARM:
+         vai->hwcaps = VEX_HWCAPS_ARM_VFP3 | VEX_HWCAPS_ARM_NEON | 7;
+         break;
+      case VexArchARM64:
+         vai->arm64_dMinLine_lg2_szB = 6;
+         vai->arm64_iMinLine_lg2_szB = 6;
+         break;
+      case VexArchPPC32:
+      case VexArchPPC64:
+         vai->ppc_icache_line_szB = 128;
+         break;
+      case VexArchS390X:
+         vai->hwcaps = VEX_HWCAPS_S390X_LDISP;
+         break;
+      case VexArchMIPS32:
+      case VexArchMIPS64:
+         vai->hwcaps = VEX_PRID_COMP_MIPS;
+         break;
+      default:
+         break;
+   }
+}
+
+/* ------------------------------------------------------------------ */
+/* --- Instrumentation stubs                                        --- */
+/* ------------------------------------------------------------------ */
+
+typedef enum { Instr_None, Instr_Light, Instr_Heavy } InstrKind;
+
+static InstrKind instr_kind = Instr_None;
+
+/* Never called: the generated code is not run. */
+static void helper_insn ( void ) { }
+static void helper_mem ( HWord addr ) { (void)addr; }
+
+static void add_mem_call ( IRSB* sbOut, IRExpr* addr )
+{
+   IRDirty* di = unsafeIRDirty_0_N(1, "helper_mem", (void*)helper_mem,
+                                   mkIRExprVec_1(addr));
+   addStmtToIRSB(sbOut, IRStmt_Dirty(di));
+}
+
+static IRSB* instrument ( void* opaque, IRSB* sbIn,
+                          const VexGuestLayout* layout,
+                          const VexGuestExtents* vge,
+                          const VexArchInfo* archinfo_host,
+                          IRType gWordTy, IRType hWordTy )
+{
+   IRSB* sbOut = deepCopyIRSBExceptStmts(sbIn);
+   Int i;
+
+   for (i = 0; i < sbIn->stmts_used; i++) {
+      IRStmt* st = sbIn->stmts[i];
+
+      if (st->tag == Ist_IMark) {
+         IRDirty* di = unsafeIRDirty_0_N(0, "helper_insn",
+                                         (void*)helper_insn,
+                                         mkIRExprVec_0());
+         addStmtToIRSB(sbOut, st);
+         addStmtToIRSB(sbOut, IRStmt_Dirty(di));
+         continue;
+      }
+      if (instr_kind == Instr_Heavy) {
+         if (st->tag == Ist_Store)
+            add_mem_call(sbOut, st->Ist.Store.addr);
+         else if (st->tag == Ist_WrTmp
+                  && st->Ist.WrTmp.data->tag == Iex_Load)
+            add_mem_call(sbOut, st->Ist.WrTmp.data->Iex.Load.addr);
+      }
+      addStmtToIRSB(sbOut, st);
+   }
+   return sbOut;
+}
+
+/* ------------------------------------------------------------------ */
+/* --- Translation                                                  --- */
+/* ------------------------------------------------------------------ */
+
+static const HChar* const phase_names[VexPhase_N] = {
+   [VexPhase_Decode]      = "decode",
+   [VexPhase_Opt1]        = "iropt1",
+   [VexPhase_Instrument1] = "instrument",
+   [VexPhase_Instrument2] = "instrument2",
+   [VexPhase_Opt2]        = "iropt2",
+   [VexPhase_ISel]        = "isel",
+   [VexPhase_RegAlloc]    = "regalloc",
+   [VexPhase_Assemble]    = "assemble"
+};
+
+typedef
+   struct {
+      ULong n_blocks;
+      ULong n_failed;     /* translations abandoned by a VEX failure */
+      ULong n_guest_insns;
+      ULong n_guest_bytes;
+      ULong n_host_bytes;
+      ULong checksum;
+      ULong ticks[VexPhase_N];
+      ULong ticks_total;
+   }
+   Totals;
+
+static jmp_buf failure_jmp;
+static Bool    quiet_failures = True;
+
+__attribute__((noreturn))
+static void failure_exit ( void )
+{
+   longjmp(failure_jmp, 1);
+}
+
+static void log_bytes ( const HChar* bytes, SizeT nbytes )
+{
+   if (!quiet_failures)
+      fwrite(bytes, 1, nbytes, stdout);
+}
+
+static void dispatcher_called ( void )
+{
+   fprintf(stderr, "vex-bench: unexpected call to a dispatcher entry\n");
+   exit(1);
+}
+
+static Bool chase_into_not_ok ( void* opaque, Addr dst )
+{
+   return False;
+}
+
+static UInt needs_self_check ( void* opaque, VexRegisterUpdates* pxControl,
+                               const VexGuestExtents* vge )
+{
+   return 0;
+}
+
+static ULong read_timer_ns ( void )
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (ULong)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static UChar           host_bytes[65536];
+static Int             host_bytes_used;
+static VexGuestExtents vge;
+
+/* Translates the code of all ranges once, adding to *tot. */
+static void translate_all ( const ElfImage* ei, const CodeRange* ranges,
+                            Int n_ranges, VexTranslateArgs* vta,
+                            Totals* tot )
+{
+   Int r, i;
+
+   vta->guest_extents   = &vge;
+   vta->host_bytes      = host_bytes;
+   vta->host_bytes_size = sizeof(host_bytes);
+   vta->host_bytes_used = &host_bytes_used;
+
+   for (r = 0; r < n_ranges; r++) {
+      /* Offsets relative to the range start, of the guest address
+         (which carries the Thumb bit, if any) and of the code. */
+      Addr  thumb = ranges[r].addr & (vta->arch_guest == VexArchARM ? 1 : 0);
+      SizeT done  = 0;
+
+      if (thumb && ranges[r].offset < ARM_LOOKBEHIND)
+         continue;
+
+      while (done < ranges[r].size) {
+         volatile ULong t0 = read_timer_ns();
+         VexTranslateResult res;
+
+         vta->guest_bytes      = ei->img + ranges[r].offset + done + thumb;
+         vta->guest_bytes_addr = ranges[r].addr + done;
+
+         if (setjmp(failure_jmp) != 0) {
+            /* Skip the rest of this function: it is probably data or
+               an instruction VEX does not handle. */
+            tot->n_failed++;
+            break;
+         }
+         res = LibVEX_Translate(vta);
+         tot->ticks_total += read_timer_ns() - t0;
+         if (res.status != VexTransOK) {
+            tot->n_failed++;
+            break;
+         }
+
+         tot->n_blocks++;
+         tot->n_guest_insns += res.n_guest_instrs;
+         tot->n_guest_bytes += vge.len[0];
+         tot->n_host_bytes  += host_bytes_used;
+         for (i = 0; i < VexPhase_N; i++)
+            tot->ticks[i] += res.phase_ticks[i];
+         for (i = 0; i < host_bytes_used; i++)
+            tot->checksum = tot->checksum * 31 + host_bytes[i];
+
+         /* An empty extent means the first instruction did not decode;
+            step over one byte (or halfword) so as to make progress. */
+         done += vge.len[0] > 0 ? vge.len[0]
+                 : (vta->arch_guest == VexArchX86
+                    || vta->arch_guest == VexArchAMD64) ? 1 : 2;
+      }
+   }
+}
+
+static void print_totals ( const HChar* guest, const HChar* host,
+                           const Totals* tot, Int reps )
+{
+   ULong phases = 0;
+   Int i;
+
+   for (i = 0; i < VexPhase_N; i++)
+      phases += tot->ticks[i];
+
+   printf("\n%s -> %s: %llu blocks (%llu failed), %llu guest insns, "
+          "%llu guest bytes, %llu host bytes (%.2fx), checksum %016llx\n",
+          guest, host, tot->n_blocks / reps, tot->n_failed / reps,
+          tot->n_guest_insns / reps, tot->n_guest_bytes / reps,
+          tot->n_host_bytes / reps,
+          tot->n_guest_bytes ? (double)tot->n_host_bytes
+                               / (double)tot->n_guest_bytes : 0.0,
+          tot->checksum);
+   printf("  %-12s %10s %6s %14s\n", "phase", "ms/rep", "%", "Minsns/s");
+   for (i = 0; i < VexPhase_N; i++) {
+      /* Skip the instrumentation phases that have no callback; all
+         they would show is the cost of reading the timer. */
+      if (i == VexPhase_Instrument2
+          || (i == VexPhase_Instrument1 && instr_kind == Instr_None))
+         continue;
+      /* A phase that never ran, e.g. register allocation when every
+         block failed, has no rate. */
+      printf("  %-12s %10.2f %6.1f %14.2f\n", phase_names[i],
+             (double)tot->ticks[i] / 1e6 / reps,
+             tot->ticks_total ? 100.0 * (double)tot->ticks[i]
+                                / (double)tot->ticks_total : 0.0,
+             tot->ticks[i] ? (double)tot->n_guest_insns * 1e3
+                             / (double)tot->ticks[i] : 0.0);
+   }
+   printf("  %-12s %10.2f %6.1f %14.2f\n", "(other)",
+          (double)(tot->ticks_total - phases) / 1e6 / reps,
+          tot->ticks_total ? 100.0 * (double)(tot->ticks_total - phases)
+                             / (double)tot->ticks_total : 0.0,
+          0.0);
+   printf("  %-12s %10.2f %6.1f %14.2f\n", "total",
+          (double)tot->ticks_total / 1e6 / reps, 100.0,
+          tot->ticks_total ? (double)tot->n_guest_insns * 1e3
+                             / (double)tot->ticks_total : 0.0);
+}
+
+/* ------------------------------------------------------------------ */
+/* --- main                                                         --- */
+/* ------------------------------------------------------------------ */
+
+static void usage ( void )
+{
+   fprintf(stderr,
+"usage: vex-bench [options] elf-file\n"
+"  --host=<arch>|all       host to generate code for [the native one];\n"
+"                          'all' tries every host with the same word size\n"
+"                          and byte order as the guest\n"
+"  --instrument=none|light|heavy\n"
+"                          instrumentation stubs to add [none]\n"
+"  --iropt-level=0|1|2     IR optimisation level [2]\n"
+"  --max-insns=<n>         maximum guest insns per superblock [60]\n"
+"  --reps=<n>              translate everything <n> times [1]\n"
+"  --verbose               show VEX messages when a translation fails\n"
+"  archs: x86 amd64 arm arm64 ppc32 ppc64 s390x mips32 mips64 nanomips\n"
+"         riscv64 (only the native one unless VEX is multiarch)\n");
+   exit(1);
+}
+
+int main ( int argc, char** argv )
+{
+   const HChar* fname = NULL;
+   const HChar* host_name = NULL;
+   Int  reps = 1, iropt_level = 2, max_insns = 60;
+   Bool all_hosts = False;
+   ElfImage ei;
+   CodeRange* ranges;
+   Int n_ranges, i, r, g;
+   VexControl vcon;
+   VexTranslateArgs vta;
+   VexEndness endness;
+   VexArch guest, host;
+
+   for (i = 1; i < argc; i++) {
+      if (strncmp(argv[i], "--host=", 7) == 0)
+         host_name = argv[i] + 7;
+      else if (strcmp(argv[i], "--instrument=none") == 0)
+         instr_kind = Instr_None;
+      else if (strcmp(argv[i], "--instrument=light") == 0)
+         instr_kind = Instr_Light;
+      else if (strcmp(argv[i], "--instrument=heavy") == 0)
+         instr_kind = Instr_Heavy;
+      else if (strncmp(argv[i], "--iropt-level=", 14) == 0)
+         iropt_level = atoi(argv[i] + 14);
+      else if (strncmp(argv[i], "--max-insns=", 12) == 0)
+         max_insns = atoi(argv[i] + 12);
+      else if (strncmp(argv[i], "--reps=", 7) == 0)
+         reps = atoi(argv[i] + 7);
+      else if (strcmp(argv[i], "--verbose") == 0)
+         quiet_failures = False;
+      else if (argv[i][0] == '-' || fname != NULL)
+         usage();
+      else
+         fname = argv[i];
+   }
+   if (fname == NULL || reps < 1 || iropt_level < 0 || iropt_level > 2
+       || max_insns < 1 || max_insns > 100)
+      usage();
+
+   read_file(fname, &ei);
+   guest    = elf_arch(&ei);
+   endness  = ei.bigendian ? VexEndnessBE : VexEndnessLE;
+   n_ranges = find_code(&ei, &ranges);
+   g        = arch_index(guest);
+
+   if (host_name == NULL) {
+      host = native_arch();
+   } else if (strcmp(host_name, "all") == 0) {
+      all_hosts = True;
+      host = native_arch();
+   } else {
+      for (i = 0; i < (Int)N_ARCHS; i++)
+         if (strcmp(host_name, arch_table[i].name) == 0)
+            break;
+      if (i == (Int)N_ARCHS)
+         usage();
+      host = arch_table[i].arch;
+   }
+
+   LibVEX_default_VexControl(&vcon);
+   vcon.iropt_level     = iropt_level;
+   vcon.guest_max_insns = max_insns;
+   LibVEX_Init(failure_exit, log_bytes, 0, &vcon);
+
+   memset(&vta, 0, sizeof(vta));
+   LibVEX_default_VexAbiInfo(&vta.abiinfo_both);
+   vta.abiinfo_both.guest_stack_redzone_size
+      = guest == VexArchAMD64 || guest == VexArchPPC64 ? 128 : 0;
+   if (guest == VexArchAMD64)
+      vta.abiinfo_both.guest_amd64_assume_fs_is_const = True;
+   vta.arch_guest = guest;
+   set_archinfo(guest, endness, &vta.archinfo_guest);
+   vta.chase_into_ok     = chase_into_not_ok;
+   vta.instrument1       = instr_kind == Instr_None ? NULL : instrument;
+   vta.instrument2       = NULL;
+   vta.finaltidy         = NULL;
+   vta.needs_self_check  = needs_self_check;
+   vta.preamble_function = NULL;
+   vta.read_timer        = read_timer_ns;
+   vta.traceflags        = 0;
+   vta.sigill_diag       = False;
+   vta.addProfInc        = False;
+   vta.disp_cp_chain_me_to_slowEP = (const void*)dispatcher_called;
+   vta.disp_cp_chain_me_to_fastEP = (const void*)dispatcher_called;
+   vta.disp_cp_xindir             = (const void*)dispatcher_called;
+   vta.disp_cp_xassisted          = (const void*)dispatcher_called;
+
+   printf("%s: %s %s, %d code ranges, instrumentation %s, iropt-level %d\n",
+          fname, arch_table[g].name, LibVEX_ppVexEndness(endness), n_ranges,
+          instr_kind == Instr_None ? "none"
+          : instr_kind == Instr_Light ? "light" : "heavy",
+          iropt_level);
+
+   for (i = 0; i < (Int)N_ARCHS; i++) {
+      Totals tot;
+
+      if (all_hosts) {
+         /* Mixing word sizes or byte orders is not supported by VEX. */
+         if (arch_table[i].mode64 != arch_table[g].mode64)
+            continue;
+         if (arch_table[i].arch == VexArchS390X
+             || arch_table[i].arch == VexArchPPC32)
+            continue;     /* big endian only */
+         if (endness == VexEndnessBE
+             && arch_table[i].arch != guest)
+            continue;
+      } else if (arch_table[i].arch != host) {
+         continue;
+      }
+
+      vta.arch_host = arch_table[i].arch;
+      set_archinfo(vta.arch_host, endness, &vta.archinfo_host);
+
+      memset(&tot, 0, sizeof(tot));
+      for (r = 0; r < reps; r++)
+         translate_all(&ei, ranges, n_ranges, &vta, &tot);
+      if (tot.n_blocks == 0) {
+         printf("\n%s -> %s: no block could be translated "
+                "(is this VEX multiarch?)\n",
+                arch_table[g].name, arch_table[i].name);
+         continue;
+      }
+      print_totals(arch_table[g].name, arch_table[i].name, &tot, reps);
+   }
+
+   free(ranges);
+   free(ei.img);
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*--- end                                               vex-bench.c ---*/
+/*--------------------------------------------------------------------*/
@@ -487,6 +487,9 @@ Bool VG_(is_action_requested) ( const HChar* action, Bool* clo )
       "---- %s ? --- [Return/N/n/Y/y/C/c] ---- ", 
       VG_(getpid)(), action
    );
+   /* The log is buffered, so write out the error and the prompt
+      before waiting for the answer. */
+   VG_(flush_output_buffers)();
 
    res = VG_(read)(VG_(clo_input_fd), &ch, 1);
    if (res != 1) goto ioerror;
@@ -256,17 +256,40 @@ typedef
    GS_Watch;
 
 /* gs_watches contains a list of all addresses+len+kind that are being
-   watched. */
+   watched, sorted by increasing addr.  gs_watches_max_len is an upper
+   bound on the len of all of them, so that the watches overlapping a
+   range can be found with a binary search followed by a scan of the
+   watches starting less than gs_watches_max_len bytes before it.
+   This keeps VG_(is_watched) cheap even with hundreds of watchpoints. */
 static XArray* gs_watches = NULL;
+static SizeT gs_watches_max_len = 0;
 
 static inline GS_Watch* index_gs_watches(Word i)
 {
    return *(GS_Watch **) VG_(indexXA) (gs_watches, i);
 }
 
+/* Returns the index of the first GS_Watch with g->addr >= addr,
+   or the number of watches if there is none. */
+static Word first_gs_watch_from (Addr addr)
+{
+   Word lo = 0;
+   Word hi = VG_(sizeXA) (gs_watches);
+
+   while (lo < hi) {
+      const Word mid = lo + (hi - lo) / 2;
+      if (index_gs_watches(mid)->addr < addr)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
 /* Returns the GS_Watch matching addr/len/kind and sets *g_ix to its
    position in gs_watches.
-   If no matching GS_Watch is found, returns NULL and sets g_ix to -1. */
+   If no matching GS_Watch is found, returns NULL and sets *g_ix to the
+   position at which such a GS_Watch should be inserted. */
 static GS_Watch* lookup_gs_watch (Addr addr, SizeT len, PointKind kind,
                                   Word* g_ix)
 {
@@ -274,11 +297,11 @@ static GS_Watch* lookup_gs_watch (Addr addr, SizeT len, PointKind kind,
    Word i;
    GS_Watch *g;
 
-   /* Linear search. If we have many watches, this might be optimised
-      by having the array sorted and using VG_(lookupXA) */
-   for (i = 0; i < n_elems; i++) {
+   for (i = first_gs_watch_from (addr); i < n_elems; i++) {
       g = index_gs_watches(i);
-      if (g->addr == addr && g->len == len && g->kind == kind) {
+      if (g->addr != addr)
+         break;
+      if (g->len == len && g->kind == kind) {
          // Found.
          *g_ix = i;
          return g;
@@ -286,10 +309,22 @@ static GS_Watch* lookup_gs_watch (Addr addr, SizeT len, PointKind kind,
    }
 
    // Not found.
-   *g_ix = -1;
+   *g_ix = i;
    return NULL;
 }
 
+/* Recomputes gs_watches_max_len, after a watch has been removed. */
+static void recompute_gs_watches_max_len (void)
+{
+   const Word n_elems = VG_(sizeXA) (gs_watches);
+   Word i;
+
+   gs_watches_max_len = 0;
+   for (i = 0; i < n_elems; i++)
+      if (index_gs_watches(i)->len > gs_watches_max_len)
+         gs_watches_max_len = index_gs_watches(i)->len;
+}
+
 
 /* protocol spec tells the below must be idempotent. */
 static void breakpoint (Bool insert, CORE_ADDR addr)
@@ -378,7 +413,9 @@ Bool VG_(gdbserver_point) (PointKind kind, Bool insert,
          g->addr = addr;
          g->len  = len;
          g->kind = kind;
-         VG_(addToXA)(gs_watches, &g);
+         VG_(insertIndexXA)(gs_watches, g_ix, &g);
+         if (len > gs_watches_max_len)
+            gs_watches_max_len = len;
       } else {
          dlog(1,
               "VG_(gdbserver_point) addr %p len %d kind %s already inserted\n",
@@ -387,6 +424,8 @@ Bool VG_(gdbserver_point) (PointKind kind, Bool insert,
    } else {
       if (g != NULL) {
          VG_(removeIndexXA) (gs_watches, g_ix);
+         if (g->len == gs_watches_max_len)
+            recompute_gs_watches_max_len();
          VG_(free) (g);
       } else {
          dlog(1,
@@ -408,17 +447,14 @@ Bool VG_(has_gdbserver_breakpoint) (Addr addr)
 
 Bool VG_(is_watched)(PointKind kind, Addr addr, Int szB)
 {
-   Word n_elems;
+   Word i, i_end;
    GS_Watch* g;
-   Word i;
    Bool watched = False;
    const ThreadId tid = VG_(running_tid);
 
    if (!gdbserver_called)
       return False;
 
-   n_elems = VG_(sizeXA) (gs_watches);
-
    Addr to = addr + szB; // semi-open interval [addr, to[
 
    vg_assert (kind == access_watchpoint
@@ -427,7 +463,17 @@ Bool VG_(is_watched)(PointKind kind, Addr addr, Int szB)
    dlog(1, "tid %u VG_(is_watched) %s addr %p szB %d\n",
         tid, VG_(ppPointKind) (kind), C2v(addr), szB);
 
-   for (i = 0; i < n_elems; i++) {
+   /* Only the watches starting in
+      ]addr - gs_watches_max_len, to[ can overlap [addr, to[. */
+   i_end = first_gs_watch_from (to);
+   if (i_end == 0)
+      return False;
+   if (addr >= gs_watches_max_len)
+      i = first_gs_watch_from (addr - gs_watches_max_len + 1);
+   else
+      i = 0;
+
+   for (; i < i_end; i++) {
       g = index_gs_watches(i);
       switch (g->kind) {
       case software_breakpoint:
@@ -555,14 +601,15 @@ static void clear_watched_addresses(void)
 {
    GS_Watch* g;
    const Word n_elems = VG_(sizeXA) (gs_watches);
-   Word i;
 
    dlog(1,
         "clear_watched_addresses: %ld elements\n",
         n_elems);
 
-   for (i = 0; i < n_elems; i++) {
-      g = index_gs_watches(i);
+   /* VG_(gdbserver_point) removes g from gs_watches, so always take
+      the last one. */
+   while (VG_(sizeXA) (gs_watches) > 0) {
+      g = index_gs_watches(VG_(sizeXA) (gs_watches) - 1);
       if (!VG_(gdbserver_point) (g->kind,
                                  /* insert */ False,
                                  g->addr,
@@ -573,6 +620,7 @@ static void clear_watched_addresses(void)
 
    VG_(deleteXA) (gs_watches);
    gs_watches = NULL;
+   gs_watches_max_len = 0;
 }
 
 static void invalidate_if_jump_not_yet_gdbserved (Addr addr, const HChar* from)
@@ -672,6 +720,11 @@ static void call_gdbserver ( ThreadId tid , CallReason reason)
         VG_(getpid) (), tid, VG_(name_of_ThreadStatus)(tst->status),
         tst->sched_jmpbuf_valid);
 
+   /* The user may be about to act on what was just printed, e.g. the
+      "vgdb me" message and the error before it, so write it out
+      before possibly blocking while waiting for gdb. */
+   VG_(flush_output_buffers)();
+
    /* If we are about to die, then just run server_main() once to get
       the resume reply out and return immediately because most of the state
       of this tid and process is about to be torn down. */
@@ -105,6 +105,7 @@ void remote_utils_output_status(void);
 static int remote_desc = INVALID_DESCRIPTOR;
 
 static VgdbShared *shared;
+VgdbShared* VG_(gdbserver_shared) = NULL;
 static int  last_looked_cntr = -1;
 static struct vki_pollfd remote_desc_pollfdread_activity;
 
@@ -426,6 +427,7 @@ void remote_open (const HChar *name)
          addr_shared = sr_Res (res);
       }
       shared = (VgdbShared*) addr_shared;
+      VG_(gdbserver_shared) = shared;
       VG_(close) (shared_mem_fd);
 
       safe_mknod(to_gdb);
@@ -976,7 +978,10 @@ int readchar (int single)
       return -1;
 
    /* No characters available in buf =>
-      wait for some characters to arrive */
+      wait for some characters to arrive.  Anything still buffered for
+      the log (such as the instructions to attach) must be written out
+      first, as the user may be waiting for it. */
+   VG_(flush_output_buffers)();
    remote_desc_pollfdread_activity.revents = 0;
    ret = VG_(poll_no_eintr)(&remote_desc_pollfdread_activity, 1, -1);
    if (sr_isError(ret) || sr_Res(ret) != 1) {
@@ -0,0 +1,495 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Sampling guest code with hardware counters.       m_hwprof.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2023 The Valgrind developers.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+#include "pub_core_basics.h"
+#include "pub_core_vki.h"
+#include "pub_core_vkiscnums.h"
+#include "pub_core_libcbase.h"
+#include "pub_core_libcassert.h"
+#include "pub_core_libcfile.h"
+#include "pub_core_libcprint.h"
+#include "pub_core_libcproc.h"
+#include "pub_core_aspacemgr.h"
+#include "pub_core_syscall.h"
+#include "pub_core_mallocfree.h"
+#include "pub_core_hashtable.h"
+#include "pub_core_debuginfo.h"
+#include "pub_core_transtab.h"
+#include "pub_core_xarray.h"
+#include "pub_core_clientstate.h"
+#include "pub_core_options.h"
+#include "pub_core_threadstate.h"   // VG_N_THREADS
+#include "pub_core_hwprof.h"      // self
+
+/* For each thread, the kernel writes a record every
+   --hw-profile-period events into a ring buffer shared with us.  The
+   buffers are read at each scheduler timeslice and before translations
+   are discarded: the sampled host PC is looked up in the host extents
+   of the translation table, and the sample is counted against the
+   guest address of the superblock it falls in.  Samples outside the
+   translation cache -- the dispatcher, the scheduler, tool helpers
+   called from generated code, the JIT itself -- are counted together
+   as Valgrind's own cost.
+
+   Attribution is therefore per superblock rather than per guest
+   instruction: VEX does not keep a map from host instructions back to
+   guest instructions, and the superblock is the unit in which the
+   translated code is laid out.
+
+   The kernel does not allow a ring buffer on a per-task event that is
+   inherited by new threads, so each thread opens its own event when
+   it enters the scheduler.  The event of an exited thread is kept
+   until its ThreadId is reused, as it may still hold samples. */
+
+#if defined(VGO_linux)
+
+/* Number of data pages in each ring buffer.  Must be a power of 2.
+   With the default period, this holds several timeslices' worth of
+   samples. */
+#define HWPROF_DATA_PAGES 16
+#define HWPROF_DATA_SZB   (HWPROF_DATA_PAGES * VKI_PAGE_SIZE)
+#define HWPROF_MAP_SZB    (VKI_PAGE_SIZE + HWPROF_DATA_SZB)
+
+typedef
+   struct _HwProfNode {
+      struct _HwProfNode* next;
+      UWord   key;       /* guest address of the superblock */
+      ULong   samples;
+      DiEpoch ep;        /* to describe key, even if since unloaded */
+   }
+   HwProfNode;
+
+typedef
+   struct {
+      Int fd;            /* -1 if no event */
+      struct vki_perf_event_mmap_page* page;  /* followed by the data */
+   }
+   HwProfThread;
+
+static const struct {
+   UInt         type;
+   ULong        config;
+   const HChar* name;    /* as shown in the "events:" line */
+} hw_events[] = {
+   [Vg_HwProfCycles]       = { VKI_PERF_TYPE_HARDWARE,
+                               VKI_PERF_COUNT_HW_CPU_CYCLES, "Cycles" },
+   [Vg_HwProfInstructions] = { VKI_PERF_TYPE_HARDWARE,
+                               VKI_PERF_COUNT_HW_INSTRUCTIONS, "Instr" },
+   [Vg_HwProfBranchMisses] = { VKI_PERF_TYPE_HARDWARE,
+                               VKI_PERF_COUNT_HW_BRANCH_MISSES, "BrMiss" },
+   [Vg_HwProfCacheMisses]  = { VKI_PERF_TYPE_HARDWARE,
+                               VKI_PERF_COUNT_HW_CACHE_MISSES, "CacheMiss" },
+   [Vg_HwProfCpuClock]     = { VKI_PERF_TYPE_SOFTWARE,
+                               VKI_PERF_COUNT_SW_CPU_CLOCK, "CpuNs" },
+};
+
+/* Indexed by ThreadId.  NULL if --hw-profile is not active. */
+static HwProfThread* hw_threads = NULL;
+
+static VgHashTable* hw_table = NULL;   /* of HwProfNode */
+static ULong  hw_n_samples;     /* samples taken */
+static ULong  hw_n_outside;     /* of which not in a translation */
+static ULong  hw_n_lost;        /* samples the kernel had to drop */
+
+/* Open an event counting the calling thread, for tid. */
+static Bool open_event ( ThreadId tid )
+{
+   struct vki_perf_event_attr attr;
+   SysRes sres;
+   Int    fd;
+
+   VG_(memset)(&attr, 0, sizeof attr);
+   attr.type           = hw_events[VG_(clo_hw_profile)].type;
+   attr.size           = sizeof attr;
+   attr.config         = hw_events[VG_(clo_hw_profile)].config;
+   attr.sample_period  = VG_(clo_hw_profile_period);
+   attr.sample_type    = VKI_PERF_SAMPLE_IP;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv     = 1;
+
+   sres = VG_(do_syscall5)(__NR_perf_event_open, (UWord)&attr,
+                           0/*this thread*/, -1/*any cpu*/, -1/*no group*/,
+                           VKI_PERF_FLAG_FD_CLOEXEC);
+   if (sr_isError(sres)) {
+      VG_(umsg)("Warning: --hw-profile: perf_event_open failed"
+                " (error %lu)\n", sr_Err(sres));
+      VG_(umsg)("   Hardware profiling is disabled."
+                "  Check /proc/sys/kernel/perf_event_paranoid,\n");
+      VG_(umsg)("   or try --hw-profile=cpu-clock"
+                " if the system has no PMU.\n");
+      return False;
+   }
+   fd = VG_(safe_fd)(sr_Res(sres));
+
+   sres = VG_(am_shared_mmap_file_float_valgrind)
+             (HWPROF_MAP_SZB, VKI_PROT_READ|VKI_PROT_WRITE, fd, 0);
+   if (sr_isError(sres)) {
+      VG_(umsg)("Warning: --hw-profile: cannot map the perf ring buffer"
+                " (error %lu)\n", sr_Err(sres));
+      VG_(umsg)("   Hardware profiling is disabled.\n");
+      VG_(close)(fd);
+      return False;
+   }
+   hw_threads[tid].fd   = fd;
+   hw_threads[tid].page = (struct vki_perf_event_mmap_page*)sr_Res(sres);
+   return True;
+}
+
+static void close_event ( ThreadId tid )
+{
+   if (hw_threads[tid].fd < 0)
+      return;
+   VG_(am_munmap_valgrind)((Addr)hw_threads[tid].page, HWPROF_MAP_SZB);
+   VG_(close)(hw_threads[tid].fd);
+   hw_threads[tid].fd   = -1;
+   hw_threads[tid].page = NULL;
+}
+
+/* Copy szB bytes at position pos of a ring buffer, which may wrap
+   around its end. */
+static void copy_from_ring ( void* dst, const UChar* data,
+                             ULong pos, SizeT szB )
+{
+   SizeT off   = pos & (HWPROF_DATA_SZB - 1);
+   SizeT first = HWPROF_DATA_SZB - off;
+
+   if (first >= szB) {
+      VG_(memcpy)(dst, data + off, szB);
+   } else {
+      VG_(memcpy)(dst, data + off, first);
+      VG_(memcpy)((UChar*)dst + first, data, szB - first);
+   }
+}
+
+static void add_sample ( Addr hcode )
+{
+   Addr        guest;
+   HwProfNode* node;
+
+   hw_n_samples++;
+   if (!VG_(search_transtab_by_hcode)(&guest, hcode)) {
+      hw_n_outside++;
+      return;
+   }
+   node = VG_(HT_lookup)(hw_table, guest);
+   if (node == NULL) {
+      node = VG_(malloc)("hwprof.add_sample.1", sizeof(HwProfNode));
+      node->key     = guest;
+      node->samples = 0;
+      node->ep      = VG_(current_DiEpoch)();
+      VG_(HT_add_node)(hw_table, node);
+   }
+   node->samples++;
+}
+
+static void drain_thread ( ThreadId tid )
+{
+   struct vki_perf_event_mmap_page* page = hw_threads[tid].page;
+   const UChar* data = (const UChar*)page + VKI_PAGE_SIZE;
+   ULong head, tail;
+
+   head = page->data_head;
+   /* Read the records only after having read data_head. */
+   __sync_synchronize();
+   tail = page->data_tail;
+
+   while (tail < head) {
+      struct vki_perf_event_header hdr;
+      /* Only sample and lost records are of interest; both are small. */
+      ULong rec[4];
+
+      copy_from_ring(&hdr, data, tail, sizeof hdr);
+      if (hdr.size < sizeof hdr)
+         break; /* cannot happen: don't loop for ever if it does */
+      if (hdr.size <= sizeof rec) {
+         copy_from_ring(rec, data, tail, hdr.size);
+         if (hdr.type == VKI_PERF_RECORD_SAMPLE) {
+            /* { header; u64 ip; } */
+            add_sample((Addr)rec[1]);
+         } else if (hdr.type == VKI_PERF_RECORD_LOST) {
+            /* { header; u64 id; u64 lost; } */
+            hw_n_lost += rec[2];
+         }
+      }
+      tail += hdr.size;
+   }
+
+   /* The space can be given back only once the records are read. */
+   __sync_synchronize();
+   page->data_tail = tail;
+}
+
+/* Give up profiling altogether, e.g. when a thread's event cannot be
+   opened: a profile missing some of the threads would be misleading.
+   The warning is thus printed once. */
+static void disable_hwprof ( void )
+{
+   ThreadId tid;
+
+   for (tid = 1; tid < VG_N_THREADS; tid++)
+      close_event(tid);
+   VG_(free)(hw_threads);
+   hw_threads = NULL;
+   VG_(HT_destruct)(hw_table, VG_(free));
+   hw_table = NULL;
+   VG_(clo_hw_profile) = Vg_HwProfNone;
+}
+
+void VG_(hwprof_drain) ( void )
+{
+   ThreadId tid;
+
+   if (LIKELY(hw_threads == NULL))
+      return;
+   for (tid = 1; tid < VG_N_THREADS; tid++)
+      if (hw_threads[tid].fd >= 0)
+         drain_thread(tid);
+}
+
+void VG_(hwprof_thread_start) ( ThreadId tid )
+{
+   if (LIKELY(hw_threads == NULL))
+      return;
+   if (hw_threads[tid].fd >= 0) {
+      /* Left by an exited thread that had the same ThreadId. */
+      drain_thread(tid);
+      close_event(tid);
+   }
+   if (!open_event(tid))
+      disable_hwprof();
+}
+
+static void hwprof_atfork_pre ( ThreadId tid )
+{
+   VG_(hwprof_drain)();
+}
+
+/* The child has a copy of the parent's samples so far, and a shared
+   mapping of the parent's ring buffers: it must not consume them.
+   Start afresh with an event for the only thread left. */
+static void hwprof_atfork_child ( ThreadId tid )
+{
+   ThreadId t;
+
+   if (hw_threads == NULL)
+      return;
+   for (t = 1; t < VG_N_THREADS; t++)
+      close_event(t);
+   VG_(HT_destruct)(hw_table, VG_(free));
+   hw_table = VG_(HT_construct)("hwprof");
+   hw_n_samples = hw_n_outside = hw_n_lost = 0;
+   if (!open_event(tid))
+      disable_hwprof();
+}
+
+void VG_(hwprof_init) ( void )
+{
+   ThreadId tid;
+
+   if (VG_(clo_hw_profile) == Vg_HwProfNone)
+      return;
+
+   vg_assert(VG_(clo_hw_profile) < sizeof(hw_events)/sizeof(hw_events[0]));
+   hw_threads = VG_(malloc)("hwprof.init.1",
+                            VG_N_THREADS * sizeof(HwProfThread));
+   for (tid = 0; tid < VG_N_THREADS; tid++) {
+      hw_threads[tid].fd   = -1;
+      hw_threads[tid].page = NULL;
+   }
+   hw_table = VG_(HT_construct)("hwprof");
+   VG_(atfork)(hwprof_atfork_pre, NULL, hwprof_atfork_child);
+}
+
+/* ----------- Output ----------------------------------------------------- */
+
+typedef
+   struct {
+      Addr         addr;
+      ULong        samples;
+      HChar*       obj;
+      HChar*       file;
+      HChar*       fn;
+      UInt         line;
+   }
+   HwProfLine;
+
+static Int cmp_HwProfLine ( const void* v1, const void* v2 )
+{
+   const HwProfLine* l1 = v1;
+   const HwProfLine* l2 = v2;
+   Int r;
+
+   if ((r = VG_(strcmp)(l1->obj, l2->obj)) != 0)
+      return r;
+   if ((r = VG_(strcmp)(l1->file, l2->file)) != 0)
+      return r;
+   if ((r = VG_(strcmp)(l1->fn, l2->fn)) != 0)
+      return r;
+   return l1->addr < l2->addr ? -1 : l1->addr > l2->addr ? 1 : 0;
+}
+
+static HChar* dup_or_unknown ( Bool ok, const HChar* s )
+{
+   return VG_(strdup)("hwprof.dup_or_unknown.1", ok && s[0] ? s : "???");
+}
+
+#define FP(format, args...) ({ VG_(fprintf)(fp, format, ##args); })
+
+static void write_profile ( const HChar* outfilename )
+{
+   const ULong   period = VG_(clo_hw_profile_period);
+   VgFile*       fp;
+   HwProfNode**  nodes;
+   HwProfLine*   lines;
+   UInt          n_nodes, i;
+   const HChar  *obj = NULL, *file = NULL, *fn = NULL;
+
+   fp = VG_(fopen)(outfilename, VKI_O_CREAT|VKI_O_WRONLY|VKI_O_TRUNC,
+                   VKI_S_IRUSR|VKI_S_IWUSR|VKI_S_IRGRP|VKI_S_IROTH);
+   if (fp == NULL) {
+      VG_(message)(Vg_UserMsg,
+                   "Error: can not open hw profile output file `%s'\n",
+                   outfilename);
+      return;
+   }
+
+   nodes = (HwProfNode**)VG_(HT_to_array)(hw_table, &n_nodes);
+   lines = VG_(malloc)("hwprof.write_profile.1",
+                       (n_nodes + 1) * sizeof(HwProfLine));
+   for (i = 0; i < n_nodes; i++) {
+      const HChar *s, *dir;
+      Bool ok;
+      lines[i].addr    = nodes[i]->key;
+      lines[i].samples = nodes[i]->samples;
+      ok = VG_(get_objname)(nodes[i]->ep, nodes[i]->key, &s);
+      lines[i].obj = dup_or_unknown(ok, s);
+      ok = VG_(get_fnname)(nodes[i]->ep, nodes[i]->key, &s);
+      lines[i].fn = dup_or_unknown(ok, s);
+      ok = VG_(get_filename_linenum)(nodes[i]->ep, nodes[i]->key,
+                                     &s, &dir, &lines[i].line);
+      lines[i].file = dup_or_unknown(ok, s);
+      if (!ok)
+         lines[i].line = 0;
+   }
+   VG_(free)(nodes);
+   VG_(ssort)(lines, n_nodes, sizeof(HwProfLine), cmp_HwProfLine);
+
+   FP("# callgrind format\n");
+   FP("version: 1\n");
+   FP("creator: valgrind-hwprof\n");
+   FP("pid: %d\n", VG_(getpid)());
+   FP("cmd: %s", VG_(args_the_exename));
+   for (i = 0; i < VG_(sizeXA)(VG_(args_for_client)); i++)
+      FP(" %s", *(HChar**)VG_(indexXA)(VG_(args_for_client), i));
+   FP("\n");
+   FP("# %llu samples, one every %llu events; %llu lost\n",
+      hw_n_samples, period, hw_n_lost);
+   FP("\npositions: instr line\n");
+   FP("events: %s\n", hw_events[VG_(clo_hw_profile)].name);
+   FP("summary: %llu\n\n", hw_n_samples * period);
+
+   for (i = 0; i < n_nodes; i++) {
+      if (obj == NULL || VG_(strcmp)(obj, lines[i].obj) != 0) {
+         obj = lines[i].obj;
+         FP("ob=%s\n", obj);
+         file = fn = NULL;
+      }
+      if (file == NULL || VG_(strcmp)(file, lines[i].file) != 0) {
+         file = lines[i].file;
+         FP("fl=%s\n", file);
+         fn = NULL;
+      }
+      if (fn == NULL || VG_(strcmp)(fn, lines[i].fn) != 0) {
+         fn = lines[i].fn;
+         FP("fn=%s\n", fn);
+      }
+      FP("%#lx %u %llu\n", lines[i].addr, lines[i].line,
+         lines[i].samples * period);
+   }
+   if (hw_n_outside > 0) {
+      FP("ob=(valgrind)\n");
+      FP("fl=???\n");
+      FP("fn=(outside translated code)\n");
+      FP("0 0 %llu\n", hw_n_outside * period);
+   }
+   VG_(fclose)(fp);
+
+   for (i = 0; i < n_nodes; i++) {
+      VG_(free)(lines[i].obj);
+      VG_(free)(lines[i].file);
+      VG_(free)(lines[i].fn);
+   }
+   VG_(free)(lines);
+}
+
+#undef FP
+
+void VG_(hwprof_fini) ( void )
+{
+   HChar*   outfilename;
+   ThreadId tid;
+
+   if (hw_threads == NULL)
+      return;
+
+   for (tid = 1; tid < VG_N_THREADS; tid++)
+      if (hw_threads[tid].fd >= 0)
+         VG_(do_syscall3)(__NR_ioctl, hw_threads[tid].fd,
+                          VKI_PERF_EVENT_IOC_DISABLE, 0);
+   VG_(hwprof_drain)();
+
+   outfilename = VG_(expand_file_name)("--hw-profile-out-file",
+                                       VG_(clo_hw_profile_file));
+   write_profile(outfilename);
+   if (VG_(clo_verbosity) > 1)
+      VG_(message)(Vg_DebugMsg,
+                   "hwprof: %'llu samples (%'llu outside translations,"
+                   " %'llu lost) written to %s\n",
+                   hw_n_samples, hw_n_outside, hw_n_lost, outfilename);
+   VG_(free)(outfilename);
+
+   for (tid = 1; tid < VG_N_THREADS; tid++)
+      close_event(tid);
+   VG_(free)(hw_threads);
+   hw_threads = NULL;
+   VG_(HT_destruct)(hw_table, VG_(free));
+   hw_table = NULL;
+}
+
+#else /* !defined(VGO_linux) */
+
+/* The options are only accepted on Linux. */
+void VG_(hwprof_init)         ( void ) { }
+void VG_(hwprof_thread_start) ( ThreadId tid ) { }
+void VG_(hwprof_drain)        ( void ) { }
+void VG_(hwprof_fini)         ( void ) { }
+
+#endif
+
+/*--------------------------------------------------------------------*/
+/*--- end                                               m_hwprof.c ---*/
+/*--------------------------------------------------------------------*/
@@ -739,6 +739,15 @@ Addr setup_client_stack( void*  init_sp,
             }
 #           endif
             break;
+#        if defined(VGP_arm64_linux)
+         case AT_HWCAP2:
+            /* None of the AT_HWCAP2 features (SVE2 and its crypto
+               extensions, BF16, I8MM, MTE, ...) is supported by VEX.
+               Hide them, so that libraries select their NEON code
+               paths instead of SVE ones. */
+            auxv->u.a_val = 0;
+            break;
+#        endif
 #        if defined(VGP_ppc64be_linux) || defined(VGP_ppc64le_linux)
          case AT_HWCAP2:  {
             Bool auxv_2_07, hw_caps_2_07;
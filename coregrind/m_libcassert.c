@@ -320,12 +320,15 @@ static void exit_wrk( Int status, Bool gdbserver_call_allowed)
    VG_(exit_now) (status);
 }
 
-/* Call the appropriate system call and nothing else. This function should
-   be called in places where the dependencies of VG_(exit) need to be
-   avoided. */
+/* Write out the buffered output, call the appropriate system call and
+   nothing else. This function should be called in places where the
+   dependencies of VG_(exit) need to be avoided, e.g. on the fatal
+   paths of m_aspacemgr: the output buffered before them is often what
+   explains the failure.  Flushing only writes to the sinks' fds. */
 __attribute__ ((__noreturn__))
 void VG_(exit_now)( Int status )
 {
+   VG_(flush_output_buffers)();
 #if defined(VGO_linux)
    (void)VG_(do_syscall1)(__NR_exit_group, status );
 #elif defined(VGO_darwin) || defined(VGO_solaris) || defined(VGO_freebsd)
@@ -350,6 +350,68 @@ static void revert_sink_to_stderr ( OutputSink *sink )
    sink->fsname_expanded = NULL;
 }
 
+/* Output to the sinks is buffered, so that error-heavy runs (in
+   particular with --xml=yes) do not pay for a write syscall per line.
+   The pending bytes are tagged with the fd they were produced for: if
+   the sink changes in the meantime (e.g. its fd is set to -2 to send
+   output to gdb, or reverted to stderr after a socket error), what is
+   pending still goes to the old destination, and before anything is
+   sent to the new one.  See VG_(flush_output_buffers) for the other
+   points at which the buffers are written out. */
+#define SINK_BUF_SIZE 65536
+
+typedef
+   struct {
+      OutputSink* sink;
+      Int         fd;    // fd and type the pending bytes are for
+      VgLogTo     type;
+      Int         used;
+      HChar       buf[SINK_BUF_SIZE];
+   }
+   SinkBuf;
+
+static SinkBuf log_sink_buf = { &VG_(log_output_sink), -1, VgLogTo_Fd, 0 };
+static SinkBuf xml_sink_buf = { &VG_(xml_output_sink), -1, VgLogTo_Fd, 0 };
+
+/* Do the low-level write of bytes to fd, of the given type, on behalf
+   of sink. */
+static void write_to_sink_fd ( OutputSink* sink, Int fd, VgLogTo type,
+                               const HChar* msg, Int nbytes )
+{
+   if (type == VgLogTo_Socket) {
+      Int rc = VG_(write_socket)( fd, msg, nbytes );
+      if (rc == -1) {
+         // For example, the listener process died.  Switch back to stderr.
+         if (sink->fd == fd && sink->type == VgLogTo_Socket)
+            revert_sink_to_stderr(sink);
+         VG_(write)( 2, msg, nbytes );
+      }
+   } else {
+      VG_(write)( fd, msg, nbytes );
+   }
+}
+
+static void flush_sink_buf ( SinkBuf* sb )
+{
+   Int used = sb->used;
+
+   if (used > 0) {
+      sb->used = 0;
+      write_to_sink_fd( sb->sink, sb->fd, sb->type, sb->buf, used );
+   }
+}
+
+/* Called before each client syscall (so that the client's own output
+   to the same file stays in order with ours), at the end of each
+   timeslice (so that output does not lag behind by more than that when
+   the client does no syscalls), before fork and exec, and from
+   VG_(exit_now) and VG_(kill_self). */
+void VG_(flush_output_buffers)(void)
+{
+   flush_sink_buf(&log_sink_buf);
+   flush_sink_buf(&xml_sink_buf);
+}
+
 static Int prepare_sink_fd(const HChar *clo_fname_unexpanded, OutputSink *sink,
                            Bool is_xml)
 {
@@ -398,8 +460,9 @@ static Int prepare_sink_socket(const HChar *clo_fname_unexpanded,
                 (is_xml) ? "XML " : "",
                 clo_fname_unexpanded,
                 (is_xml) ? "XML output" : "Logging messages");
-      /* We don't change anything here. */
-      vg_assert(sink->fd == 2);
+      /* We don't change anything here.  The XML sink is disabled (-1)
+         until now, the caller makes it use stderr. */
+      vg_assert(sink->fd == 2 || (is_xml && sink->fd == -1));
       vg_assert(sink->type == VgLogTo_Fd);
       return 2;
    } else {
@@ -446,6 +509,12 @@ static Bool reopen_sink_if_needed(const HChar *clo_fname_unexpanded,
    return False;
 }
 
+void VG_(logging_atfork_pre)(ThreadId tid)
+{
+   /* Otherwise both parent and child would write what is pending. */
+   VG_(flush_output_buffers)();
+}
+
 void VG_(logging_atfork_child)(ThreadId tid)
 {
    /* If --child-silent-after-fork=yes was specified, set the output file
@@ -584,29 +653,42 @@ void VG_(init_log_xml_sinks)(VgLogTo log_to, VgLogTo xml_to,
    }
 }
 
-/* Do the low-level send of a message to the logging sink. */
+/* Send a message to the logging sink. */
 static
 void send_bytes_to_logging_sink ( OutputSink* sink, const HChar* msg, Int nbytes )
 {
-   if (sink->type == VgLogTo_Socket) {
-      Int rc = VG_(write_socket)( sink->fd, msg, nbytes );
-      if (rc == -1) {
-         // For example, the listener process died.  Switch back to stderr.
-         revert_sink_to_stderr(sink);
-         VG_(write)( sink->fd, msg, nbytes );
+   SinkBuf* sb    = sink == &VG_(xml_output_sink) ? &xml_sink_buf : &log_sink_buf;
+   SinkBuf* other = sb == &xml_sink_buf ? &log_sink_buf : &xml_sink_buf;
+
+   /* Keep the order of what is sent to each destination. */
+   if (sb->used > 0 && (sb->fd != sink->fd || sb->type != sink->type))
+      flush_sink_buf(sb);
+   if (other->used > 0 && other->fd == sink->fd && sink->fd >= 0)
+      flush_sink_buf(other);
+
+   if (sink->fd >= 0) {
+      /* Debug logging writes directly to stderr, so buffering our
+         output would make the two hard to relate. */
+      if (nbytes > SINK_BUF_SIZE || VG_(debugLog_getLevel)() > 0) {
+         flush_sink_buf(sb);
+         write_to_sink_fd( sink, sink->fd, sink->type, msg, nbytes );
+         return;
       }
-   } else {
-      /* sink->fd could have been set to -1 in the various
-         sys-wrappers for sys_fork, if --child-silent-after-fork=yes
-         is in effect.  That is a signal that we should not produce
-         any more output. */
-      if (sink->fd >= 0)
-         VG_(write)( sink->fd, msg, nbytes );
-      else if (sink->fd == -2 && nbytes > 0)
-         /* send to gdb the provided data, which must be
-            a null terminated string with len >= 1 */
-         VG_(gdb_printf)("%s", msg);
+      if (sb->used + nbytes > SINK_BUF_SIZE)
+         flush_sink_buf(sb);
+      sb->fd   = sink->fd;
+      sb->type = sink->type;
+      VG_(memcpy)(&sb->buf[sb->used], msg, nbytes);
+      sb->used += nbytes;
    }
+   /* sink->fd could have been set to -1 in the various
+      sys-wrappers for sys_fork, if --child-silent-after-fork=yes
+      is in effect.  That is a signal that we should not produce
+      any more output. */
+   else if (sink->fd == -2 && nbytes > 0)
+      /* send to gdb the provided data, which must be
+         a null terminated string with len >= 1 */
+      VG_(gdb_printf)("%s", msg);
 }
 
 
@@ -673,6 +673,21 @@ Int VG_(prctl) (Int option,
    return sr_isError(res) ? -1 : sr_Res(res);
 }
 
+/* ---------------------------------------------------------------------
+   Memory residency
+   ------------------------------------------------------------------ */
+
+Int VG_(mincore) ( Addr start, SizeT length, UChar* vec )
+{
+   SysRes res = VG_(mk_SysRes_Error)(VKI_ENOSYS);
+#  if defined(VGO_linux) || defined(VGO_darwin) || defined(VGO_freebsd)
+   /* res = mincore( start, length, vec ); */
+   res = VG_(do_syscall3)(__NR_mincore, start, length, (UWord)vec);
+#  endif
+
+   return sr_isError(res) ? -1 : 0;
+}
+
 /* ---------------------------------------------------------------------
    pids, etc
    ------------------------------------------------------------------ */
@@ -1059,6 +1074,34 @@ UInt VG_(read_millisecond_timer) ( void )
    return (now - base) / 1000;
 }
 
+/* A cheap, monotonic, high resolution timer, for measuring short
+   intervals such as the phases of a translation.  The unit is whatever
+   the hardware provides (cycles, or timebase ticks), so only ratios of
+   its results are meaningful.  Falls back to nanoseconds on platforms
+   without a directly readable counter. */
+ULong VG_(read_cycle_counter) ( void )
+{
+#  if defined(VGA_x86) || defined(VGA_amd64)
+   UInt lo, hi;
+   __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+   return ((ULong)hi << 32) | lo;
+#  elif defined(VGA_arm64)
+   ULong ticks;
+   __asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (ticks));
+   return ticks;
+#  elif defined(VGA_riscv64)
+   ULong ticks;
+   __asm__ __volatile__("rdtime %0" : "=r" (ticks));
+   return ticks;
+#  elif defined(VGO_linux) || defined(VGO_solaris) || defined(VGO_freebsd)
+   struct vki_timespec ts;
+   VG_(clock_gettime)(&ts, VKI_CLOCK_MONOTONIC);
+   return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#  else
+#    error "Unknown platform"
+#  endif
+}
+
 #  if defined(VGO_linux) || defined(VGO_solaris) || defined(VGO_freebsd)
 void VG_(clock_gettime) ( struct vki_timespec *ts, vki_clockid_t clk_id )
 {
@@ -40,6 +40,7 @@
 #include "pub_core_errormgr.h"
 #include "pub_core_execontext.h"
 #include "pub_core_gdbserver.h"
+#include "pub_core_hwprof.h"
 #include "pub_core_initimg.h"
 #include "pub_core_libcbase.h"
 #include "pub_core_libcassert.h"
@@ -247,6 +248,13 @@ static void usage_NORETURN ( int need_help )
 "                              should calls to realloc with a size of 0\n"
 "                              free memory and return NULL or\n"
 "                              allocate/resize and return non-NULL\n"
+#if defined(VGO_linux)
+"    --hw-profile=none|cycles|instructions|branch-misses|cache-misses|cpu-clock\n"
+"                              sample the program with this perf event, and\n"
+"                              write counts per guest code block [none]\n"
+"    --hw-profile-period=<number>  sample every <number> events [100000]\n"
+"    --hw-profile-out-file=<file>  hw profile output file [hwprof.out.%%p]\n"
+#endif
 "\n";
 
    const HChar usage2[] =
@@ -259,6 +267,8 @@ static void usage_NORETURN ( int need_help )
 "    --profile-flags=<XXXXXXXX> ditto, but for profiling (X = 0|1) [00000000]\n"
 "    --profile-interval=<number> show profile every <number> event checks\n"
 "                                [0, meaning only at the end of the run]\n"
+"    --sb-profile-file=<file>  write the execution count of each superblock\n"
+"                              to <file> at exit\n"
 "    --trace-notbelow=<number> only show BBs above <number> [999999999]\n"
 "    --trace-notabove=<number> only show BBs below <number> [0]\n"
 "    --trace-syscalls=no|yes   show all system calls? [no]\n"
@@ -278,6 +288,7 @@ static void usage_NORETURN ( int need_help )
 "    --sym-offsets=yes|no      show syms in form 'name+offset'? [no]\n"
 "    --progress-interval=<number>  report progress every <number>\n"
 "                                  CPU seconds [0, meaning disabled]\n"
+"    --progress-file=<file>    write progress reports as JSON lines to <file>\n"
 "    --command-line-only=no|yes  only use command line options [no]\n"
 "\n"
 "  Vex options for all Valgrind tools:\n"
@@ -678,6 +689,26 @@ else if VG_INT_CLOM(cloPD, arg, "--scheduling-quantum",
    else if VG_BOOL_CLOM(cloPD, arg, "--sym-offsets",      VG_(clo_sym_offsets)) {}
    else if VG_BINT_CLOM(cloPD, arg, "--progress-interval",
                         VG_(clo_progress_interval), 0, 3600) {}
+   else if VG_STR_CLO(arg, "--progress-file",
+                      VG_(clo_progress_fname_unexpanded)) {}
+#if defined(VGO_linux)
+   else if VG_XACT_CLO(arg, "--hw-profile=none",
+                       VG_(clo_hw_profile), Vg_HwProfNone) {}
+   else if VG_XACT_CLO(arg, "--hw-profile=cycles",
+                       VG_(clo_hw_profile), Vg_HwProfCycles) {}
+   else if VG_XACT_CLO(arg, "--hw-profile=instructions",
+                       VG_(clo_hw_profile), Vg_HwProfInstructions) {}
+   else if VG_XACT_CLO(arg, "--hw-profile=branch-misses",
+                       VG_(clo_hw_profile), Vg_HwProfBranchMisses) {}
+   else if VG_XACT_CLO(arg, "--hw-profile=cache-misses",
+                       VG_(clo_hw_profile), Vg_HwProfCacheMisses) {}
+   else if VG_XACT_CLO(arg, "--hw-profile=cpu-clock",
+                       VG_(clo_hw_profile), Vg_HwProfCpuClock) {}
+   else if VG_BINT_CLO(arg, "--hw-profile-period",
+                       VG_(clo_hw_profile_period), 1000, 1000000000) {}
+   else if VG_STR_CLO(arg, "--hw-profile-out-file",
+                      VG_(clo_hw_profile_file)) {}
+#endif
    else if VG_BOOL_CLO(arg, "--read-inline-info", VG_(clo_read_inline_info)) {}
    else if VG_BOOL_CLO(arg, "--read-var-info",    VG_(clo_read_var_info)) {}
 
@@ -865,6 +896,8 @@ else if VG_INT_CLOM(cloPD, arg, "--scheduling-quantum",
 
    else if VG_INT_CLO (arg, "--profile-interval",
                        VG_(clo_profyle_interval)) {}
+   else if VG_STR_CLO (arg, "--sb-profile-file",
+                       VG_(clo_sb_profile_file)) {}
 
    else if VG_XACT_CLOM(cloPD, arg, "--gen-suppressions=no",
                        VG_(clo_gen_suppressions), 0) {}
@@ -1115,7 +1148,7 @@ void main_process_cmd_line_options( void )
    /* Register child at-fork handler which will take care of handling
       --child-silent-after-fork clo and also reopening output sinks for forked
       children, if requested via --log|xml-file= options. */
-   VG_(atfork)(NULL, NULL, VG_(logging_atfork_child));
+   VG_(atfork)(VG_(logging_atfork_pre), NULL, VG_(logging_atfork_child));
 
    // Suppressions related stuff
 
@@ -1815,6 +1848,13 @@ Int valgrind_main ( Int argc, HChar **argv, HChar **envp )
    VG_(debugLog)(1, "main", "Initialise TT/TC\n");
    VG_(init_tt_tc)();
 
+   //--------------------------------------------------------------
+   // Set up --hw-profile sampling
+   //   p: init_tt_tc [samples are looked up in the TT/TC]
+   //--------------------------------------------------------------
+   VG_(debugLog)(1, "main", "Initialise hw profiling\n");
+   VG_(hwprof_init)();
+
    //--------------------------------------------------------------
    // Initialise the redirect table.
    //   p: init_tt_tc [so it can call VG_(search_transtab) safely]
@@ -2265,6 +2305,10 @@ void shutdown_actions_NORETURN( ThreadId tid,
    }
    VG_(threads)[tid].status = VgTs_Empty;
 
+   /* Stop sampling before the tool's finalisation, whose cost is not
+      the client's. */
+   VG_(hwprof_fini)();
+
    //--------------------------------------------------------------
    // Finalisation: cleanup, messages, etc.  Order not so important, only
    // affects what order the messages come.
@@ -2339,6 +2383,10 @@ void shutdown_actions_NORETURN( ThreadId tid,
       VG_(get_and_show_SB_profile)(0/*denoting end-of-run*/);
    }
 
+   /* Export the per-superblock execution counts, if requested. */
+   if (VG_(clo_sb_profile_file) != NULL)
+      VG_(write_SB_profile)();
+
    /* Print Vex storage stats */
    if (0)
        LibVEX_ShowAllocStats();
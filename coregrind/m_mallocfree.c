@@ -2433,6 +2433,16 @@ void VG_(mallinfo) ( ThreadId tid, struct vg_mallinfo* mi )
    mi->keepcost = 0; // may want some value in here
 }
 
+void VG_(arena_stats) ( ArenaId aid, /*OUT*/SizeT* bytes_on_loan,
+                        /*OUT*/SizeT* bytes_mmaped )
+{
+   Arena* a;
+   ensure_mm_init(aid);
+   a = arenaId_to_ArenaP(aid);
+   *bytes_on_loan = a->stats__bytes_on_loan;
+   *bytes_mmaped  = a->stats__bytes_mmaped;
+}
+
 SizeT VG_(arena_redzone_size) ( ArenaId aid )
 {
    ensure_mm_init (VG_AR_CLIENT);
@@ -137,6 +137,7 @@ UChar  VG_(clo_trace_flags)    = 0; // 00000000b
 Bool   VG_(clo_profyle_sbs)    = False;
 UChar  VG_(clo_profyle_flags)  = 0; // 00000000b
 ULong  VG_(clo_profyle_interval) = 0;
+const HChar* VG_(clo_sb_profile_file) = NULL;
 Int    VG_(clo_trace_notbelow) = -1;  // unspecified
 Int    VG_(clo_trace_notabove) = -1;  // unspecified
 Bool   VG_(clo_trace_syscalls) = False;
@@ -159,6 +160,10 @@ Bool   VG_(clo_trace_sched)    = False;
 Bool   VG_(clo_profile_heap)   = False;
 UInt   VG_(clo_progress_interval) = 0; /* in seconds, 1 .. 3600,
                                           or 0 == disabled */
+const HChar *VG_(clo_progress_fname_unexpanded) = NULL;
+VgHwProfEvent VG_(clo_hw_profile) = Vg_HwProfNone;
+UInt   VG_(clo_hw_profile_period) = 100000;
+const HChar* VG_(clo_hw_profile_file) = "hwprof.out.%p";
 Int    VG_(clo_core_redzone_size) = CORE_REDZONE_DEFAULT_SZB;
 // A value != -1 overrides the tool-specific value
 // VG_(needs_malloc_replacement).tool_client_redzone_szB
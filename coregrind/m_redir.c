@@ -244,6 +244,9 @@ typedef
       /* VARIABLE PARTS -- used transiently whilst processing redirections */
       Bool   mark; /* set if spec requires further processing */
       Bool   done; /* set if spec was successfully matched */
+      Int    order; /* position among the marked specs */
+      struct _Spec* next_match; /* next marked spec in the same hash
+                                   chain, or in the wildcard list */
    }
    Spec;
 
@@ -803,6 +806,23 @@ void VG_(redir_add_ifunc_target)( Addr old_from, Addr new_from )
     }
 }
 
+/* Does |fnpatt| match only the name equal to it? */
+static Bool is_wildcard_free ( const HChar* fnpatt )
+{
+   for (; *fnpatt; fnpatt++)
+      if (*fnpatt == '*' || *fnpatt == '?')
+         return False;
+   return True;
+}
+
+static UInt fnname_hash ( const HChar* name )
+{
+   UInt h = 5381;
+   for (; *name; name++)
+      h = h * 33 + (UChar)*name;
+   return h;
+}
+
 /* Do one element of the basic cross product: add to the active set,
    all matches resulting from comparing all the given specs against
    all the symbols in the given seginfo.  If a conflicting binding
@@ -819,20 +839,29 @@ void generate_and_add_actives (
      )
 {
    Spec*   sp;
+   Spec*   exact;
+   Spec*   wild;
+   Spec**  wildTail;
+   Spec**  chains;
    Bool    anyMark, isText, isIFunc, isGlobal;
    Active  act;
-   Int     nsyms, i;
+   Int     nsyms, i, nMarked, nExact;
+   UInt    nChains;
    SymAVMAs  sym_avmas;
    const HChar*  sym_name_pri;
    const HChar** sym_names_sec;
+   const HChar*  soname = VG_(DebugInfo_get_soname)(di);
+   const HChar*  prev_sopatt = NULL;
+   Bool          prev_mark = False;
 
    /* First figure out which of the specs match the seginfo's soname.
       Also clear the 'done' bits, so that after the main loop below
-      tell which of the Specs really did get done. */
+      tell which of the Specs really did get done.  The specs of a
+      preload object come in runs with the same soname pattern, so
+      the previous match is remembered. */
    anyMark = False;
    for (sp = specs; sp; sp = sp->next) {
       sp->done = False;
-      const HChar *soname = VG_(DebugInfo_get_soname)(di);
 
       /* When searching for global public symbols (like for the somalloc
          synonym symbols), exclude the dynamic (runtime) linker as it is very
@@ -844,7 +873,12 @@ void generate_and_add_actives (
          continue;
       }
 
-      sp->mark = VG_(string_match)( sp->from_sopatt, soname );
+      if (prev_sopatt == NULL
+          || VG_(strcmp)(sp->from_sopatt, prev_sopatt) != 0) {
+         prev_sopatt = sp->from_sopatt;
+         prev_mark   = VG_(string_match)( sp->from_sopatt, soname );
+      }
+      sp->mark = prev_mark;
       anyMark = anyMark || sp->mark;
    }
 
@@ -852,6 +886,41 @@ void generate_and_add_actives (
    if (!anyMark)
       return;
 
+   /* Index the marked specs, so that each symbol name is compared
+      only with those that can match it: the specs whose fnpatt has
+      no wildcard are put in hash chains keyed by the fnpatt, and the
+      others in a single list.  Both keep the order of |specs|, and
+      are merged on that order below, so the actives are added in the
+      same order as when trying every spec in turn. */
+   nMarked  = 0;
+   nExact   = 0;
+   wild     = NULL;
+   wildTail = &wild;
+   for (sp = specs; sp; sp = sp->next) {
+      if (!sp->mark)
+         continue;
+      sp->order      = nMarked++;
+      sp->next_match = NULL;
+      if (is_wildcard_free(sp->from_fnpatt)) {
+         nExact++;
+      } else {
+         *wildTail = sp;
+         wildTail  = &sp->next_match;
+      }
+   }
+   nChains = 16;
+   while (nChains < 2 * nExact)
+      nChains *= 2;
+   chains = dinfo_zalloc("redir.gaaa.1", nChains * sizeof(Spec*));
+   for (sp = specs; sp; sp = sp->next) {
+      if (!sp->mark || !is_wildcard_free(sp->from_fnpatt))
+         continue;
+      Spec** tail = &chains[fnname_hash(sp->from_fnpatt) & (nChains - 1)];
+      while (*tail)
+         tail = &(*tail)->next_match;
+      *tail = sp;
+   }
+
    /* Iterate outermost over the symbols in the seginfo, in the hope
       of trashing the caches less. */
    nsyms = VG_(DebugInfo_syms_howmany)( di );
@@ -869,10 +938,20 @@ void generate_and_add_actives (
          if (!isText)
             continue;
 
-         for (sp = specs; sp; sp = sp->next) {
-            if (!sp->mark)
-               continue; /* soname doesn't match */
-            if (VG_(string_match)( sp->from_fnpatt, *names )
+         exact = chains[fnname_hash(*names) & (nChains - 1)];
+         Spec* wsp = wild;
+         while (exact || wsp) {
+            Bool match;
+            if (exact && (!wsp || exact->order < wsp->order)) {
+               sp    = exact;
+               exact = exact->next_match;
+               match = VG_(strcmp)( sp->from_fnpatt, *names ) == 0;
+            } else {
+               sp    = wsp;
+               wsp   = wsp->next_match;
+               match = VG_(string_match)( sp->from_fnpatt, *names );
+            }
+            if (match
 		&& (sp->isGlobal == False || isGlobal == True)) {
                /* got a new binding.  Add to collection. */
                act.from_addr   = sym_avmas.main;
@@ -898,11 +977,12 @@ void generate_and_add_actives (
                }
 
             }
-         } /* for (sp = specs; sp; sp = sp->next) */
+         } /* while (exact || wsp) */
 
       } /* iterating over names[] */
       free_symname_array(names_init, &twoslots[0]);
    } /* for (i = 0; i < nsyms; i++)  */
+   dinfo_free(chains);
 
    /* Now, finally, look for Specs which were marked to be done, but
       didn't get matched.  If any such are mandatory we must abort the
@@ -35,6 +35,12 @@
 #include "pub_core_debuginfo.h"
 #include "pub_core_translate.h"
 #include "pub_core_options.h"
+#include "pub_core_hashtable.h"
+#include "pub_core_mallocfree.h"
+#include "pub_core_libcproc.h"     // VG_(getpid)
+#include "pub_core_vki.h"
+#include "pub_core_xarray.h"
+#include "pub_core_clientstate.h"  // VG_(args_the_exename)
 #include "pub_core_sbprofile.h"    // self
 
 /*====================================================================*/
@@ -214,6 +220,132 @@ void VG_(get_and_show_SB_profile) ( ULong ecs_done )
 }
 
 
+/*====================================================================*/
+/*=== SB profile export                                            ===*/
+/*====================================================================*/
+
+/* For --sb-profile-file.  m_transtab hands over the execution count of
+   each translation before the translation is discarded, and of the
+   remaining ones at exit, so the profile covers the whole run.
+   Counts are summed per guest address. */
+
+typedef
+   struct _SBCountNode {
+      struct _SBCountNode* next;
+      UWord   key;          /* guest address of the superblock */
+      ULong   count;        /* number of executions */
+      UInt    guest_bytes;  /* guest code size, largest seen */
+      DiEpoch ep;           /* to describe key, even if since unloaded */
+   }
+   SBCountNode;
+
+static VgHashTable* sb_counts = NULL;
+
+void VG_(add_SB_profile_count) ( Addr guest_addr, UInt guest_bytes,
+                                 ULong count )
+{
+   SBCountNode* node;
+
+   if (sb_counts == NULL)
+      sb_counts = VG_(HT_construct)("sbprofile.sb_counts");
+   node = VG_(HT_lookup)(sb_counts, guest_addr);
+   if (node == NULL) {
+      node = VG_(malloc)("sbprofile.add_SB_profile_count.1",
+                         sizeof(SBCountNode));
+      node->key         = guest_addr;
+      node->count       = 0;
+      node->guest_bytes = 0;
+      node->ep          = VG_(current_DiEpoch)();
+      VG_(HT_add_node)(sb_counts, node);
+   }
+   node->count += count;
+   if (guest_bytes > node->guest_bytes)
+      node->guest_bytes = guest_bytes;
+}
+
+/* Most executed first. */
+static Int cmp_SBCountNode ( const void* v1, const void* v2 )
+{
+   const SBCountNode* n1 = *(const SBCountNode* const*)v1;
+   const SBCountNode* n2 = *(const SBCountNode* const*)v2;
+
+   if (n1->count != n2->count)
+      return n1->count > n2->count ? -1 : 1;
+   return n1->key < n2->key ? -1 : n1->key > n2->key ? 1 : 0;
+}
+
+void VG_(write_SB_profile) ( void )
+{
+   HChar*        outfilename;
+   VgFile*       fp;
+   SBCountNode** nodes;
+   UInt          n_nodes, i;
+   ULong         total = 0;
+
+   vg_assert(VG_(clo_sb_profile_file) != NULL);
+
+   VG_(save_SB_profile_counts)();
+   if (sb_counts == NULL)
+      sb_counts = VG_(HT_construct)("sbprofile.sb_counts");
+
+   outfilename = VG_(expand_file_name)("--sb-profile-file",
+                                       VG_(clo_sb_profile_file));
+   fp = VG_(fopen)(outfilename, VKI_O_CREAT|VKI_O_WRONLY|VKI_O_TRUNC,
+                   VKI_S_IRUSR|VKI_S_IWUSR|VKI_S_IRGRP|VKI_S_IROTH);
+   if (fp == NULL) {
+      VG_(message)(Vg_UserMsg,
+                   "Error: can not open SB profile output file `%s'\n",
+                   outfilename);
+      VG_(free)(outfilename);
+      return;
+   }
+
+   nodes = (SBCountNode**)VG_(HT_to_array)(sb_counts, &n_nodes);
+   VG_(ssort)(nodes, n_nodes, sizeof(SBCountNode*), cmp_SBCountNode);
+   for (i = 0; i < n_nodes; i++)
+      total += nodes[i]->count;
+
+   /* One tab-separated line per superblock.  obj_vaddr is the address
+      in the object's own (ELF) address space, which does not change
+      from run to run; "-" if no object is known. */
+   VG_(fprintf)(fp, "# Valgrind superblock profile, version 1\n");
+   VG_(fprintf)(fp, "# pid: %d\n", VG_(getpid)());
+   VG_(fprintf)(fp, "# cmd: %s", VG_(args_the_exename));
+   for (i = 0; i < VG_(sizeXA)(VG_(args_for_client)); i++)
+      VG_(fprintf)(fp, " %s",
+                   *(HChar**)VG_(indexXA)(VG_(args_for_client), i));
+   VG_(fprintf)(fp, "\n");
+   VG_(fprintf)(fp, "# superblocks: %u, executions: %llu\n",
+                n_nodes, total);
+   VG_(fprintf)(fp, "# guest_addr\tcount\tguest_bytes\tobject"
+                    "\tobj_vaddr\tfunction\n");
+   for (i = 0; i < n_nodes; i++) {
+      const SBCountNode* node = nodes[i];
+      const DebugInfo*   di   = VG_(find_DebugInfo)(node->ep, node->key);
+      const HChar*       fn;
+
+      VG_(fprintf)(fp, "%#lx\t%llu\t%u\t", node->key, node->count,
+                   node->guest_bytes);
+      if (di != NULL)
+         VG_(fprintf)(fp, "%s\t%#lx\t", VG_(DebugInfo_get_filename)(di),
+                      node->key - VG_(DebugInfo_get_text_bias)(di));
+      else
+         VG_(fprintf)(fp, "???\t-\t");
+      if (!VG_(get_fnname)(node->ep, node->key, &fn) || fn[0] == 0)
+         fn = "???";
+      VG_(fprintf)(fp, "%s\n", fn);
+   }
+   VG_(fclose)(fp);
+
+   if (VG_(clo_verbosity) > 1)
+      VG_(message)(Vg_DebugMsg,
+                   "sbprofile: %u superblocks, %'llu executions,"
+                   " written to %s\n", n_nodes, total, outfilename);
+   VG_(free)(nodes);
+   VG_(free)(outfilename);
+}
+
+
 /*--------------------------------------------------------------------*/
 /*--- end                                            m_sbprofile.c ---*/
 /*--------------------------------------------------------------------*/
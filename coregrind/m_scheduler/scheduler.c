@@ -67,8 +67,10 @@
 #include "pub_core_dispatch.h"
 #include "pub_core_errormgr.h"   // For VG_(get_n_errs_found)()
 #include "pub_core_gdbserver.h"  // for VG_(gdbserver)/VG_(gdbserver_activity)
+#include "pub_core_hwprof.h"     // VG_(hwprof_*)
 #include "pub_core_libcbase.h"
 #include "pub_core_libcassert.h"
+#include "pub_core_libcfile.h"
 #include "pub_core_libcprint.h"
 #include "pub_core_libcproc.h"
 #include "pub_core_libcsignal.h"
@@ -107,6 +109,11 @@ Bool VG_(in_generated_code) = False;
 /* 64-bit counter for the number of basic blocks done. */
 static ULong bbs_done = 0;
 
+/* How often, in blocks, to poll for signals when the client catches
+   async ones.  This is a tenth of the default timeslice; the cost of
+   the extra trips through the scheduler is lost in the noise. */
+#define SIGNAL_POLL_INTERVAL 10000
+
 /* Counter to see if vgdb activity is to be verified.
    When nr of bbs done reaches vgdb_next_poll, scheduler will
    poll for gdbserver activity. VG_(force_vgdb_poll) and 
@@ -132,6 +139,18 @@ static ULong stats__n_xIndir_hits2 = 0;
 static ULong stats__n_xIndir_hits3 = 0;
 static ULong stats__n_xIndir_misses = 0;
 
+/* Stats: number of chainings done, and the time spent doing them (in
+   VG_(read_cycle_counter) units; only measured with --stats=yes). */
+static ULong stats__n_chainings = 0;
+static ULong stats__chaining_ticks = 0;
+
+/* Stats: number of XIndir inline caches filled in, and the number of
+   hits in them (only counted with --stats=yes).  Transfers which hit
+   an inline cache never reach VG_(disp_cp_xindir), so aren't included
+   in stats__n_xIndirs. */
+static ULong stats__n_xIndir_cache_fills = 0;
+static ULong stats__n_xIndir_cache_hits = 0;
+
 /* And 32-bit temp bins for the above, so that 32-bit platforms don't
    have to do 64 bit incs on the hot path through
    VG_(disp_cp_xindir). */
@@ -140,11 +159,25 @@ static ULong stats__n_xIndir_misses = 0;
 /*global*/ UInt VG_(stats__n_xIndir_hits2_32) = 0;
 /*global*/ UInt VG_(stats__n_xIndir_hits3_32) = 0;
 /*global*/ UInt VG_(stats__n_xIndir_misses_32) = 0;
+/*global*/ UInt VG_(stats__n_xIndir_cache_hits_32) = 0;
+
+/* Counts for the --progress-file metrics stream.  They are only
+   updated and read by the thread holding the BigLock, so plain
+   increments are safe.  Whether an acquire was contended is however
+   guessed before taking the lock; see VG_(acquire_BigLock_LL). */
+static ULong stats__n_syscalls = 0;
+static ULong stats__n_BigLock_acquires = 0;
+static ULong stats__n_BigLock_contended = 0;
 
 /* Sanity checking counts. */
 static UInt sanity_fast_count = 0;
 static UInt sanity_slow_count = 0;
 
+ULong VG_(get_bbs_done) ( void )
+{
+   return bbs_done;
+}
+
 void VG_(print_scheduler_stats)(void)
 {
    VG_(message)(Vg_DebugMsg,
@@ -168,9 +201,24 @@ void VG_(print_scheduler_stats)(void)
                 stats__n_xIndir_hits3,
                 stats__n_xIndir_misses);
 
+   if (stats__n_xIndir_cache_fills > 0) {
+      const ULong n_cache_uses
+         = stats__n_xIndir_cache_hits + stats__n_xIndirs;
+      VG_(message)(Vg_DebugMsg,
+                   "scheduler: %'llu xindir inline caches filled, "
+                   "%'llu hits (%llu%% of indir transfers)\n",
+                   stats__n_xIndir_cache_fills,
+                   stats__n_xIndir_cache_hits,
+                   stats__n_xIndir_cache_hits * 100
+                      / (n_cache_uses ? n_cache_uses : 1));
+   }
+
    VG_(message)(Vg_DebugMsg,
       "scheduler: %'llu/%'llu major/minor sched events.\n",
       n_scheduling_events_MAJOR, n_scheduling_events_MINOR);
+   VG_(message)(Vg_DebugMsg,
+      "scheduler: %'llu chainings, %'llu ticks.\n",
+      stats__n_chainings, stats__chaining_ticks);
    VG_(message)(Vg_DebugMsg, 
                 "   sanity: %u cheap, %u expensive checks.\n",
                 sanity_fast_count, sanity_slow_count );
@@ -186,6 +234,60 @@ static struct sched_lock *the_BigLock;
    Helper functions for the scheduler.
    ------------------------------------------------------------------ */
 
+/* Append one line of JSON describing the current state of the run to
+   the --progress-file.  The file is (re)created on the first record
+   written by each process, so that a forked child given a %p file name
+   gets its own stream. */
+static void write_progress_record ( UInt user_ms )
+{
+   static Int progress_fd  = -1;
+   static Int progress_pid = -1;
+
+   if (progress_pid != VG_(getpid)()) {
+      if (progress_fd >= 0)
+         VG_(close)(progress_fd);
+      progress_fd  = -1;
+      progress_pid = VG_(getpid)();
+      HChar* fname = VG_(expand_file_name)("--progress-file",
+                                           VG_(clo_progress_fname_unexpanded));
+      SysRes sres = VG_(open)(fname, VKI_O_CREAT|VKI_O_WRONLY|VKI_O_TRUNC,
+                              VKI_S_IRUSR|VKI_S_IWUSR|VKI_S_IRGRP|VKI_S_IROTH);
+      if (sr_isError(sres)) {
+         VG_(umsg)("Warning: cannot create progress file '%s': %s\n",
+                   fname, VG_(strerror)(sr_Err(sres)));
+      } else {
+         progress_fd = VG_(safe_fd)(sr_Res(sres));
+      }
+      VG_(free)(fname);
+   }
+   if (progress_fd < 0)
+      return;
+
+   /* Only tools replacing malloc use the client arena.  Blocks in the
+      tool's queue of freed blocks are still on loan, but not in use. */
+   SizeT heap_in_use = 0, heap_arena = 0;
+   if (VG_(needs).malloc_replacement) {
+      VG_(arena_stats)(VG_AR_CLIENT, &heap_in_use, &heap_arena);
+      heap_in_use -= VG_(free_queue_volume);
+   }
+
+   HChar buf[512];
+   Int len = VG_(snprintf)(buf, sizeof(buf),
+      "{\"pid\":%d,\"user_ms\":%u,\"wall_ms\":%u,\"threads\":%u,"
+      "\"event_checks\":%llu,\"sb_translated\":%llu,"
+      "\"sb_discarded\":%llu,\"errors_found\":%u,\"errors_shown\":%u,"
+      "\"heap_in_use\":%lu,\"heap_arena\":%lu,\"syscalls\":%llu,"
+      "\"biglock_acquires\":%llu,\"biglock_contended\":%llu}\n",
+      VG_(getpid)(), user_ms, VG_(read_millisecond_timer)(),
+      (UInt)VG_(count_living_threads)(),
+      bbs_done, VG_(get_bbs_translated)(), VG_(get_bbs_discarded_or_dumped)(),
+      VG_(get_n_errs_found)(), VG_(get_n_errs_shown)(),
+      heap_in_use, heap_arena, stats__n_syscalls,
+      stats__n_BigLock_acquires, stats__n_BigLock_contended);
+   vg_assert(len < sizeof(buf));
+   VG_(write)(progress_fd, buf, len);
+}
+
 static void maybe_progress_report ( UInt reporting_interval_seconds )
 {
    /* This is when the next report is due, in user cpu milliseconds since
@@ -224,7 +326,9 @@ static void maybe_progress_report ( UInt reporting_interval_seconds )
    Double thousandTOuts = ((Double)VG_(get_bbs_discarded_or_dumped)()) / 1000.0;
    UInt   nThreads      = VG_(count_living_threads)();
 
-   if (VG_(clo_verbosity) > 0) {
+   if (VG_(clo_progress_fname_unexpanded) != NULL) {
+      write_progress_record(user_ms);
+   } else if (VG_(clo_verbosity) > 0) {
       VG_(dmsg)("PROGRESS: U %'us, W %'us, %.1f%% CPU, EvC %.2fM, "
                 "TIn %.1fk, TOut %.1fk, #thr %u\n",
                 user_cpu_seconds, wallclock_seconds,
@@ -294,6 +398,7 @@ const HChar* name_of_sched_event ( UInt event )
       case VG_TRC_INVARIANT_FAILED:    return "INVFAILED";
       case VG_TRC_CHAIN_ME_TO_SLOW_EP: return "CHAIN_ME_SLOW";
       case VG_TRC_CHAIN_ME_TO_FAST_EP: return "CHAIN_ME_FAST";
+      case VG_TRC_PATCH_ME_XINDIR:     return "PATCH_ME_XINDIR";
       default:                         return "??UNKNOWN??";
   }
 }
@@ -417,7 +522,16 @@ static void deinit_BigLock(void)
 /* See pub_core_scheduler.h for description */
 void VG_(acquire_BigLock_LL) ( const HChar* who )
 {
+   /* The owner is > 0 iff some thread holds the lock.  This is looked
+      at without the lock, so the count of contended acquires is only
+      approximate: the lock can be released or taken by another thread
+      between the check and the acquire.  The counters themselves are
+      updated once the lock is held. */
+   const Bool contended = ML_(get_sched_lock_owner)(the_BigLock) > 0;
    ML_(acquire_sched_lock)(the_BigLock);
+   stats__n_BigLock_acquires++;
+   if (contended)
+      stats__n_BigLock_contended++;
 }
 
 /* See pub_core_scheduler.h for description */
@@ -528,24 +642,12 @@ void VG_(vg_yield)(void)
 
 /* Set the standard set of blocked signals, used whenever we're not
    running a client syscall. */
-static void block_signals(void)
+static void block_signals(ThreadId tid)
 {
    vki_sigset_t mask;
 
-   VG_(sigfillset)(&mask);
-
-   /* Don't block these because they're synchronous */
-   VG_(sigdelset)(&mask, VKI_SIGSEGV);
-   VG_(sigdelset)(&mask, VKI_SIGBUS);
-   VG_(sigdelset)(&mask, VKI_SIGFPE);
-   VG_(sigdelset)(&mask, VKI_SIGILL);
-   VG_(sigdelset)(&mask, VKI_SIGTRAP);
-   VG_(sigdelset)(&mask, VKI_SIGSYS);
-
-   /* Can't block these anyway */
-   VG_(sigdelset)(&mask, VKI_SIGSTOP);
-   VG_(sigdelset)(&mask, VKI_SIGKILL);
-
+   VG_(get_sched_sigmask)(&mask);
+   VG_(threads)[tid].host_sig_mask_lazy = 0;
    VG_(sigprocmask)(VKI_SIG_SETMASK, &mask, NULL);
 }
 
@@ -923,8 +1025,9 @@ void VG_(force_vgdb_poll) ( void )
    translation.
 
    Return results are placed in two_words.  two_words[0] is set to the
-   TRC.  In the case where that is VG_TRC_CHAIN_ME_TO_{SLOW,FAST}_EP,
-   the address to patch is placed in two_words[1].
+   TRC.  In the case where that is VG_TRC_CHAIN_ME_TO_{SLOW,FAST}_EP
+   or VG_TRC_PATCH_ME_XINDIR, the address to patch is placed in
+   two_words[1].
 */
 static
 void run_thread_for_a_while ( /*OUT*/HWord* two_words,
@@ -954,6 +1057,7 @@ void run_thread_for_a_while ( /*OUT*/HWord* two_words,
    vg_assert(VG_(stats__n_xIndir_hits2_32) == 0);
    vg_assert(VG_(stats__n_xIndir_hits3_32) == 0);
    vg_assert(VG_(stats__n_xIndir_misses_32) == 0);
+   vg_assert(VG_(stats__n_xIndir_cache_hits_32) == 0);
 
    /* Clear return area. */
    two_words[0] = two_words[1] = 0;
@@ -1051,7 +1155,7 @@ void run_thread_for_a_while ( /*OUT*/HWord* two_words,
       vg_assert(two_words[0] == 0 && two_words[1] == 0); // correct?
       two_words[0] = VG_TRC_FAULT_SIGNAL;
       two_words[1] = 0;
-      block_signals();
+      block_signals(tid);
    } 
 
    /* Merge the 32-bit XIndir/miss counters into the 64 bit versions,
@@ -1067,6 +1171,8 @@ void run_thread_for_a_while ( /*OUT*/HWord* two_words,
    VG_(stats__n_xIndir_hits3_32) = 0;
    stats__n_xIndir_misses += (ULong)VG_(stats__n_xIndir_misses_32);
    VG_(stats__n_xIndir_misses_32) = 0;
+   stats__n_xIndir_cache_hits += (ULong)VG_(stats__n_xIndir_cache_hits_32);
+   VG_(stats__n_xIndir_cache_hits_32) = 0;
 
    /* Inspect the event counter. */
    vg_assert((Int)tst->arch.vex.host_EvC_COUNTER >= -1);
@@ -1101,7 +1207,14 @@ void run_thread_for_a_while ( /*OUT*/HWord* two_words,
    // Tell the tool this thread has stopped running client code
    VG_TRACK( stop_client_code, tid, bbs_done );
 
-   if (bbs_done >= vgdb_next_poll) {
+   /* Poll when the --vgdb-poll number of blocks have been done, or as
+      soon as vgdb has written something, which is a cheap check on the
+      memory shared with vgdb.  The latter makes the gdbserver react
+      without waiting for the poll or for vgdb to invoke it via
+      ptrace, so --vgdb-poll can be large. */
+   if (bbs_done >= vgdb_next_poll
+       || (vgdb_next_poll != NO_VGDB_POLL
+           && VG_(gdbserver_activity_pending)())) {
       if (VG_(clo_vgdb_poll))
          vgdb_next_poll = bbs_done + (ULong)VG_(clo_vgdb_poll);
       else
@@ -1116,7 +1229,8 @@ void run_thread_for_a_while ( /*OUT*/HWord* two_words,
       VG_(run_innerloop). */
    /* Stay sane .. */
    if (two_words[0] == VG_TRC_CHAIN_ME_TO_SLOW_EP
-       || two_words[0] == VG_TRC_CHAIN_ME_TO_FAST_EP) {
+       || two_words[0] == VG_TRC_CHAIN_ME_TO_FAST_EP
+       || two_words[0] == VG_TRC_PATCH_ME_XINDIR) {
       vg_assert(two_words[1] != 0); /* we have a legit patch addr */
    } else {
       vg_assert(two_words[1] == 0); /* nobody messed with it */
@@ -1155,41 +1269,74 @@ static void handle_tt_miss ( ThreadId tid )
    }
 }
 
+/* Find the translation for the current IP, making one if needed,
+   for patching through to it.  Returns False if no translation could
+   be made. */
 static
-void handle_chain_me ( ThreadId tid, void* place_to_chain, Bool toFastEP )
+Bool find_patch_target ( ThreadId tid, /*OUT*/SECno* to_sNo,
+                         /*OUT*/TTEno* to_tteNo )
 {
    Bool found          = False;
    Addr ip             = VG_(get_IP)(tid);
-   SECno to_sNo         = INV_SNO;
-   TTEno to_tteNo       = INV_TTE;
 
-   found = VG_(search_transtab)( NULL, &to_sNo, &to_tteNo,
+   found = VG_(search_transtab)( NULL, to_sNo, to_tteNo,
                                  ip, False/*dont_upd_fast_cache*/ );
    if (!found) {
       /* Not found; we need to request a translation. */
       if (VG_(translate)( tid, ip, /*debug*/False, 0/*not verbose*/, 
                           bbs_done, True/*allow redirection*/ )) {
-         found = VG_(search_transtab)( NULL, &to_sNo, &to_tteNo,
+         found = VG_(search_transtab)( NULL, to_sNo, to_tteNo,
                                        ip, False ); 
-         vg_assert2(found, "handle_chain_me: missing tt_fast entry");
+         vg_assert2(found, "find_patch_target: missing tt_fast entry");
       } else {
 	 // If VG_(translate)() fails, it's because it had to throw a
 	 // signal because the client jumped to a bad address.  That
 	 // means that either a signal has been set up for delivery,
 	 // or the thread has been marked for termination.  Either
 	 // way, we just need to go back into the scheduler loop.
-        return;
+        return False;
       }
    }
    vg_assert(found);
-   vg_assert(to_sNo != INV_SNO);
-   vg_assert(to_tteNo != INV_TTE);
+   vg_assert(*to_sNo != INV_SNO);
+   vg_assert(*to_tteNo != INV_TTE);
+   return True;
+}
+
+static
+void handle_chain_me ( ThreadId tid, void* place_to_chain, Bool toFastEP )
+{
+   SECno to_sNo         = INV_SNO;
+   TTEno to_tteNo       = INV_TTE;
+
+   if (!find_patch_target(tid, &to_sNo, &to_tteNo))
+      return;
 
    /* So, finally we know where to patch through to.  Do the patching
       and update the various admin tables that allow it to be undone
       in the case that the destination block gets deleted. */
+   ULong ticks_start = VG_(clo_stats) ? VG_(read_cycle_counter)() : 0;
    VG_(tt_tc_do_chaining)( place_to_chain,
                            to_sNo, to_tteNo, toFastEP );
+   stats__n_chainings++;
+   if (VG_(clo_stats))
+      stats__chaining_ticks += VG_(read_cycle_counter)() - ticks_start;
+}
+
+/* Fill in an empty XIndir inline cache, so that it remembers the
+   translation for the current IP.  The cache stays filled until that
+   translation is deleted. */
+static
+void handle_patch_me_xindir ( ThreadId tid, void* place_to_patch )
+{
+   SECno to_sNo         = INV_SNO;
+   TTEno to_tteNo       = INV_TTE;
+
+   if (!find_patch_target(tid, &to_sNo, &to_tteNo))
+      return;
+
+   VG_(tt_tc_do_xindir_patching)( place_to_patch, to_sNo, to_tteNo );
+   stats__n_xIndir_cache_fills++;
 }
 
 static void handle_syscall(ThreadId tid, UInt trc)
@@ -1209,6 +1356,7 @@ static void handle_syscall(ThreadId tid, UInt trc)
       vg_assert(ok);
    }
 
+   stats__n_syscalls++;
    SCHEDSETJMP(tid, jumped, VG_(client_syscall)(tid, trc));
 
    if (VG_(clo_sanity_level) >= 3) {
@@ -1224,7 +1372,7 @@ static void handle_syscall(ThreadId tid, UInt trc)
    vg_assert(VG_(is_running_thread)(tid));
    
    if (jumped != (UWord)0) {
-      block_signals();
+      block_signals(tid);
       VG_(poll_signals)(tid);
    }
 }
@@ -1290,6 +1438,9 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
    if (VG_(clo_trace_sched))
       print_sched_event(tid, "entering VG_(scheduler)");      
 
+   /* Each thread has its own --hw-profile event. */
+   VG_(hwprof_thread_start)(tid);
+
    /* Do vgdb initialization (but once). Only the first (main) task
       starting up will do the below.
       Initialize gdbserver earlier than at the first 
@@ -1386,7 +1537,7 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
    }
 
    /* set the proper running signal mask */
-   block_signals();
+   block_signals(tid);
    
    vg_assert(VG_(is_running_thread)(tid));
 
@@ -1422,6 +1573,8 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
 	 /* ------------ now we do have The Lock ------------ */
 
 	 /* OK, do some relatively expensive housekeeping stuff */
+	 VG_(flush_output_buffers)();
+	 VG_(hwprof_drain)();
 	 scheduler_sanity(tid);
 	 VG_(sanity_check_general)(False);
 
@@ -1455,10 +1608,21 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
          VG_(message)(Vg_DebugMsg, "thread %u: running for %d bbs\n", 
                                    tid, dispatch_ctr - 1 );
 
+      /* If the client catches async signals, come back every
+         SIGNAL_POLL_INTERVAL blocks to look for them, rather than
+         letting them wait for the end of the timeslice. */
+      Int deferred_ctr = 0;
+      if (VG_(client_catches_async_signals)
+          && dispatch_ctr > SIGNAL_POLL_INTERVAL) {
+         deferred_ctr = dispatch_ctr - SIGNAL_POLL_INTERVAL;
+         dispatch_ctr = SIGNAL_POLL_INTERVAL;
+      }
+
       HWord trc[2]; /* "two_words" */
       run_thread_for_a_while( &trc[0],
                               &dispatch_ctr,
                               tid, 0/*ignored*/, False );
+      dispatch_ctr += deferred_ctr;
 
       if (VG_(clo_trace_sched) && VG_(clo_verbosity) > 2) {
          const HChar *name = name_of_sched_event(trc[0]);
@@ -1516,7 +1680,8 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
             request, since chaining in the no-redir cache is too
             complex. */
          vg_assert(trc[0] != VG_TRC_CHAIN_ME_TO_SLOW_EP
-                   && trc[0] != VG_TRC_CHAIN_ME_TO_FAST_EP);
+                   && trc[0] != VG_TRC_CHAIN_ME_TO_FAST_EP
+                   && trc[0] != VG_TRC_PATCH_ME_XINDIR);
       }
 
       switch (trc[0]) {
@@ -1544,6 +1709,12 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
          break;
       }
 
+      case VG_TRC_PATCH_ME_XINDIR: {
+         if (0) VG_(printf)("sched: PATCH_ME_XINDIR: %p\n", (void*)trc[1] );
+         handle_patch_me_xindir(tid, (void*)trc[1]);
+         break;
+      }
+
       case VEX_TRC_JMP_CLIENTREQ:
 	 do_client_request(tid);
 	 break;
@@ -1573,6 +1744,11 @@ VgSchedReturnCode VG_(scheduler) ( ThreadId tid )
 	 break;
 
       case VG_TRC_INNER_COUNTERZERO:
+         if (deferred_ctr > 0) {
+            /* Only the signal poll interval is out. */
+            VG_(poll_signals)(tid);
+            break;
+         }
 	 /* Timeslice is out.  Let a new thread be scheduled. */
 	 vg_assert(dispatch_ctr == 0);
 	 break;
@@ -251,6 +251,21 @@ typedef struct SigQueue {
 /* Hash table of PIDs from which SIGCHLD is ignored.  */
 VgHashTable *ht_sigchld_ignore = NULL;
 
+/* See pub_core_signals.h. */
+Bool VG_(client_catches_async_signals) = False;
+
+/* Stats, for --stats=yes. */
+static ULong stats__n_polls           = 0;
+static ULong stats__n_polls_unmasked  = 0; /* no host mask change needed */
+static ULong stats__n_delivered       = 0;
+static ULong stats__n_delivered_poll  = 0; /* fetched from the kernel */
+static ULong stats__n_delivered_queue = 0; /* from a thread's queue */
+static ULong stats__n_delivered_sys   = 0; /* to a thread in a syscall */
+static ULong stats__n_deferred        = 0; /* arrived outside a syscall */
+static ULong stats__poll_gap_sum      = 0; /* blocks run between polls */
+static ULong stats__poll_gap_max      = 0;
+static ULong stats__poll_last_bbs     = 0;
+
 /* ------ Macros for pulling stuff out of ucontexts ------ */
 
 /* Q: what does VG_UCONTEXT_SYSCALL_SYSRES do?  A: let's suppose the
@@ -1115,6 +1130,15 @@ static void handle_SCSS_change ( Bool force_update )
    skss_old = skss;
    calculate_SKSS_from_SCSS ( &skss );
 
+   /* Does the client now catch any async signal? */
+   VG_(client_catches_async_signals) = False;
+   for (sig = 1; sig <= VG_(max_signal); sig++) {
+      if (skss.skss_per_sig[sig].skss_handler == async_signalhandler
+          && scss.scss_per_sig[sig].scss_handler != VKI_SIG_DFL
+          && scss.scss_per_sig[sig].scss_handler != VKI_SIG_IGN)
+         VG_(client_catches_async_signals) = True;
+   }
+
    /* Compare the new SKSS entries vs the old ones, and update kernel
       where they differ. */
    for (sig = 1; sig <= VG_(max_signal); sig++) {
@@ -1505,9 +1529,14 @@ static void restore_all_host_signals ( /* IN */ vki_sigset_t* saved_mask )
    vg_assert(ret == 0);
 }
 
+static void queue_signal(ThreadId tid, const vki_siginfo_t *si);
+static void drain_deferred_signals(void);
+
 void VG_(clear_out_queued_signals)( ThreadId tid, vki_sigset_t* saved_mask )
 {
    block_all_host_signals(saved_mask);
+   /* Not this thread's to lose: see defer_async_signal. */
+   drain_deferred_signals();
    if (VG_(threads)[tid].sig_queue != NULL) {
       VG_(free)(VG_(threads)[tid].sig_queue);
       VG_(threads)[tid].sig_queue = NULL;
@@ -1677,6 +1706,8 @@ void VG_(kill_self)(Int sigNo)
    vki_sigaction_toK_t   sa, origsa2;
    vki_sigaction_fromK_t origsa;   
 
+   VG_(flush_output_buffers)();
+
    sa.ksa_handler = VKI_SIG_DFL;
    sa.sa_flags = 0;
 #  if !defined(VGP_riscv64_linux) && !defined(VGO_darwin) && \
@@ -2089,6 +2120,8 @@ static void deliver_signal ( ThreadId tid, const vki_siginfo_t *info,
    void			*handler_fn;
    ThreadState		*tst = VG_(get_ThreadState)(tid);
 
+   stats__n_delivered++;
+
 #if defined(VGO_linux)
    /* If this signal is SIGCHLD and it came from a process which valgrind
       created for some internal use, then it should not be delivered to
@@ -2432,6 +2465,55 @@ static vki_siginfo_t *next_queued(ThreadId tid, const vki_sigset_t *set)
    return ret;
 }
 
+/* Number of signals left in deferred_sigs by defer_async_signal, in
+   any thread, and not yet moved to the process-wide queue. */
+static volatile UInt n_deferred_sigs = 0;
+
+/* Move the signals left by defer_async_signal in all threads to the
+   process-wide queue, in the order each thread got them.  This is done
+   before anything else is taken from the queues or the kernel, so that
+   a deferred signal is not overtaken by one sent after it, which the
+   kernel still holds.  The handler filling deferred_sigs may run
+   concurrently in its own thread, so an entry is only read once
+   deferred_sigs_in says it is complete.  Must be called with the lock
+   held and host signals blocked. */
+static void drain_deferred_signals(void)
+{
+   ThreadId tid;
+
+   if (n_deferred_sigs == 0)
+      return;
+   for (tid = 1; tid < VG_N_THREADS; tid++) {
+      ThreadState *tst = &VG_(threads)[tid];
+      while (tst->deferred_sigs_out != tst->deferred_sigs_in) {
+         __sync_synchronize();
+         queue_signal(0, &tst->deferred_sigs[tst->deferred_sigs_out
+                                             % N_DEFERRED_SIGNALS]);
+         __sync_synchronize();
+         tst->deferred_sigs_out++;
+         __sync_fetch_and_sub(&n_deferred_sigs, 1);
+      }
+   }
+}
+
+/* Cheap check for whether next_queued(tid, set) might find
+   something.  Needs no signals blocked: a stale answer is harmless,
+   as the caller blocks them before really looking. */
+static Bool maybe_queued(ThreadId tid, const vki_sigset_t *set)
+{
+   const SigQueue *sq = VG_(get_ThreadState)(tid)->sig_queue;
+   Int idx;
+
+   if (sq == NULL)
+      return False;
+   for (idx = 0; idx < N_QUEUED_SIGNALS; idx++) {
+      Int sigNo = sq->sigs[idx].si_signo;
+      if (sigNo != 0 && VG_(sigismember)(set, sigNo))
+         return True;
+   }
+   return False;
+}
+
 static int sanitize_si_code(int si_code)
 {
 #if defined(VGO_linux)
@@ -2555,11 +2637,64 @@ static void async_signalhandler_solaris_preprocess(ThreadId tid, Int *signo,
 }
 #endif
 
+#if VG_LAZY_SYSCALL_SIGMASK
+/* With the client's mask left installed after a blocking syscall (see
+   pub_core_syswrap.h), an async signal can arrive anywhere, possibly
+   while this thread is in the middle of Valgrind's own code, or waiting
+   for the lock.  If it is not in a syscall, make the signal pending
+   again and return with async signals blocked, so that it is polled
+   for, or interrupts the next blocking syscall, as usual.  Only
+   thread-local state is touched, as the thread may not hold the
+   lock. */
+static Bool defer_async_signal ( ThreadId tid, Int sigNo,
+                                 vki_siginfo_t *info,
+                                 struct vki_ucontext *uc )
+{
+   ThreadState *tst = VG_(get_ThreadState)(tid);
+   SysRes sres;
+
+   if (VG_(is_ip_in_blocking_syscall)(tid, VG_UCONTEXT_INSTR_PTR(uc)))
+      return False;
+
+   stats__n_deferred++;
+   tst->host_sig_mask_lazy = 0;
+   VG_(get_sched_sigmask)(&uc->uc_sigmask);
+
+   /* The mask left installed may be stale: the client can have
+      blocked the signal since.  Then, unless it was sent to this
+      thread in particular, it must go where another thread can take
+      it, as natively.  The kernel refuses to requeue it for the
+      process (rt_sigqueueinfo gives EPERM for si_code >= 0 unless
+      called by the main thread), so keep it for VG_(poll_signals) to
+      put on our own process-wide queue.  Only a poll makes room
+      again; making the signal pending for this thread instead would
+      strand it, so running out of room is fatal. */
+   if (info->si_code != VKI_SI_TKILL
+       && VG_(sigismember)(&tst->sig_mask, sigNo)) {
+      UInt in = tst->deferred_sigs_in;
+      if (in - tst->deferred_sigs_out >= N_DEFERRED_SIGNALS)
+         VG_(core_panic)("defer_async_signal: too many signals deferred "
+                         "before a poll");
+      __sync_fetch_and_add(&n_deferred_sigs, 1);
+      tst->deferred_sigs[in % N_DEFERRED_SIGNALS] = *info;
+      __sync_synchronize();
+      tst->deferred_sigs_in = in + 1;
+      return True;
+   }
+
+   sres = VG_(do_syscall4)(__NR_rt_tgsigqueueinfo, VG_(getpid)(),
+                           VG_(gettid)(), sigNo, (UWord)info);
+   vg_assert(!sr_isError(sres));
+   return True;
+}
+#endif
+
 /* 
    Receive an async signal from the kernel.
 
    This should only happen when the thread is blocked in a syscall,
-   since that's the only time this set of signals is unblocked.
+   since that's the only time this set of signals is unblocked
+   (but see defer_async_signal).
 */
 static 
 void async_signalhandler ( Int sigNo,
@@ -2569,6 +2704,11 @@ void async_signalhandler ( Int sigNo,
    ThreadState* tst = VG_(get_ThreadState)(tid);
    SysRes       sres;
 
+#  if VG_LAZY_SYSCALL_SIGMASK
+   if (defer_async_signal(tid, sigNo, info, uc))
+      return;
+#  endif
+
    vg_assert(tst->status == VgTs_WaitSys);
 
 #  if defined(VGO_solaris)
@@ -2645,8 +2785,10 @@ void async_signalhandler ( Int sigNo,
       => resume the scheduler for such a thread, so that the scheduler
       can let the thread die. */
    if (tst->exitreason != VgSrc_FatalSig 
-       && !is_sig_ign(info, tid))
+       && !is_sig_ign(info, tid)) {
+      stats__n_delivered_sys++;
       deliver_signal(tid, info, uc);
+   }
 
    /* It's crucial that (1) and (2) happen in the order (1) then (2)
       and not the other way around.  (1) fixes up the guest thread
@@ -2751,7 +2893,7 @@ void sync_signalhandler_from_user ( ThreadId tid,
       arrives... */
 
    if (VG_(threads)[tid].status == VgTs_WaitSys
-#     if defined(VGO_solaris)
+#     if defined(VGO_solaris) || VG_LAZY_SYSCALL_SIGMASK
       /* Check if the signal was really received while doing a blocking
          syscall.  Only then the async_signalhandler() path can be used. */
        && VG_(is_ip_in_blocking_syscall)(tid, VG_UCONTEXT_INSTR_PTR(uc))
@@ -3035,6 +3177,11 @@ static void sigvgkill_handler(int signo, vki_siginfo_t *si,
    ThreadId     tid = VG_(lwpid_to_vgtid)(VG_(gettid)());
    ThreadStatus at_signal = VG_(threads)[tid].status;
 
+#  if VG_LAZY_SYSCALL_SIGMASK
+   if (defer_async_signal(tid, signo, si, uc))
+      return;
+#  endif
+
    if (VG_(clo_trace_signals))
       VG_(dmsg)("sigvgkill for lwp %d tid %u\n", VG_(gettid)(), tid);
 
@@ -3083,6 +3230,23 @@ void pp_ksigaction ( vki_sigaction_toK_t* sa )
    VG_(printf)("}\n");
 }
 
+void VG_(get_sched_sigmask) ( vki_sigset_t* mask )
+{
+   VG_(sigfillset)(mask);
+
+   /* Don't block these because they're synchronous */
+   VG_(sigdelset)(mask, VKI_SIGSEGV);
+   VG_(sigdelset)(mask, VKI_SIGBUS);
+   VG_(sigdelset)(mask, VKI_SIGFPE);
+   VG_(sigdelset)(mask, VKI_SIGILL);
+   VG_(sigdelset)(mask, VKI_SIGTRAP);
+   VG_(sigdelset)(mask, VKI_SIGSYS);
+
+   /* Can't block these anyway */
+   VG_(sigdelset)(mask, VKI_SIGSTOP);
+   VG_(sigdelset)(mask, VKI_SIGKILL);
+}
+
 /* 
    Force signal handler to default
  */
@@ -3126,24 +3290,66 @@ void VG_(poll_signals)(ThreadId tid)
       return;
    }
 
+   stats__n_polls++;
+   if (VG_(clo_stats)) {
+      ULong bbs = VG_(get_bbs_done)();
+      ULong gap = bbs - stats__poll_last_bbs;
+      stats__poll_gap_sum += gap;
+      if (gap > stats__poll_gap_max)
+         stats__poll_gap_max = gap;
+      stats__poll_last_bbs = bbs;
+   }
+
    /* look for all the signals this thread isn't blocking */
    /* pollset = ~tst->sig_mask */
    VG_(sigcomplementset)( &pollset, &tst->sig_mask );
 
+   /* Most polls find nothing, and nothing can be queued unless a
+      signal arrived while the thread was in a syscall or faulted, so
+      only block host signals to protect the queues when there is
+      something in them.  A signal queued by a handler just after the
+      check is found by the next poll, as it would have been had the
+      handler run after restore_all_host_signals.  A signal fetched
+      from the kernel lives in si, so its delivery needs no
+      protection either. */
+   if (n_deferred_sigs == 0
+       && !maybe_queued(tid, &pollset) && !maybe_queued(0, &pollset)) {
+      stats__n_polls_unmasked++;
+      if (VG_(sigtimedwait_zero)(&pollset, &si) > 0) {
+         if (VG_(clo_trace_signals))
+            VG_(dmsg)("poll_signals: got signal %d for thread %u "
+                      "exitreason %s\n", si.si_signo, tid,
+                      VG_(name_of_VgSchedReturnCode)(tst->exitreason));
+         stats__n_delivered_poll++;
+         if (!is_sig_ign(&si, tid))
+            deliver_signal(tid, &si, NULL);
+         else if (VG_(clo_trace_signals))
+            VG_(dmsg)("   signal %d ignored\n", si.si_signo);
+      }
+      return;
+   }
+
    block_all_host_signals(&saved_mask); // protect signal queue
 
+   /* Signals left by defer_async_signal are for the whole process. */
+   drain_deferred_signals();
+
    /* First look for any queued pending signals */
    sip = next_queued(tid, &pollset); /* this thread */
 
    if (sip == NULL)
       sip = next_queued(0, &pollset); /* process-wide */
 
+   if (sip != NULL)
+      stats__n_delivered_queue++;
+
    /* If there was nothing queued, ask the kernel for a pending signal */
    if (sip == NULL && VG_(sigtimedwait_zero)(&pollset, &si) > 0) {
       if (VG_(clo_trace_signals))
          VG_(dmsg)("poll_signals: got signal %d for thread %u exitreason %s\n",
                    si.si_signo, tid,
                    VG_(name_of_VgSchedReturnCode)(tst->exitreason));
+      stats__n_delivered_poll++;
       sip = &si;
    }
 
@@ -3165,6 +3371,27 @@ void VG_(poll_signals)(ThreadId tid)
    restore_all_host_signals(&saved_mask);
 }
 
+void VG_(print_signal_stats) ( void )
+{
+   VG_(message)(Vg_DebugMsg,
+                "signals: %'llu polls, %'llu without host mask changes\n",
+                stats__n_polls, stats__n_polls_unmasked);
+   VG_(message)(Vg_DebugMsg,
+                "signals: %'llu delivered: %'llu polled, %'llu queued, "
+                "%'llu in syscalls\n",
+                stats__n_delivered, stats__n_delivered_poll,
+                stats__n_delivered_queue, stats__n_delivered_sys);
+   if (VG_LAZY_SYSCALL_SIGMASK)
+      VG_(message)(Vg_DebugMsg,
+                   "signals: %'llu made pending again, "
+                   "having arrived outside a syscall\n", stats__n_deferred);
+   VG_(message)(Vg_DebugMsg,
+                "signals: latency bound: %'llu blocks between polls avg, "
+                "%'llu max\n",
+                stats__poll_gap_sum / (stats__n_polls ? stats__n_polls : 1),
+                stats__poll_gap_max);
+}
+
 /* At startup, copy the process' real signal state to the SCSS.
    Whilst doing this, block all real signals.  Then calculate SKSS and
    set the kernel to that.  Also initialise DCSS. 
@@ -3217,6 +3217,8 @@ void handle_pre_sys_execve(ThreadId tid, SyscallStatus *status, Addr pathname,
             VG_(printf)("env: %s\n", *cpp);
    }
 
+   VG_(flush_output_buffers)();
+
    // always execute this because it's executing valgrind, not the "target" exe
    SET_STATUS_from_SysRes( 
       VG_(do_syscall3)(__NR_execve, (UWord)path, (UWord)argv, (UWord)envp));
@@ -1562,6 +1562,16 @@ PRE(sys_prctl)
    case VKI_PR_CAPBSET_DROP:
       PRE_REG_READ2(int, "prctl", int, option, int, capability);
       break;
+   case VKI_PR_SVE_SET_VL:
+   case VKI_PR_SVE_GET_VL:
+      PRE_REG_READ2(int, "prctl", int, option, unsigned long, arg2);
+#     if defined(VGA_arm64)
+      /* SVE is not supported by VEX, and AT_HWCAP does not advertise
+         it.  Behave like a kernel running on a CPU without SVE, so
+         that callers probing the vector length fall back to NEON. */
+      SET_STATUS_Failure( VKI_EINVAL );
+#     endif
+      break;
    default:
       PRE_REG_READ5(long, "prctl",
                     int, option, unsigned long, arg2, unsigned long, arg3,
@@ -299,7 +299,8 @@ UWord ML_(do_syscall_for_client_WRK)( Word syscallno,
                                       void* guest_state,
                                       const vki_sigset_t *syscall_mask,
                                       const vki_sigset_t *restore_mask,
-                                      Word sigsetSzB );
+                                      Word sigsetSzB,
+                                      UInt *lazy );
 #elif defined(VGO_freebsd)
 extern
 UWord ML_(do_syscall_for_client_WRK)( Word syscallno, 
@@ -343,6 +344,18 @@ UWord ML_(do_syscall_for_client_dret_WRK)( Word syscallno,
 #endif
 
 
+#if VG_LAZY_SYSCALL_SIGMASK
+static Bool blocks_sync_signals ( const vki_sigset_t* mask )
+{
+   return VG_(sigismember)(mask, VKI_SIGSEGV)
+          || VG_(sigismember)(mask, VKI_SIGBUS)
+          || VG_(sigismember)(mask, VKI_SIGFPE)
+          || VG_(sigismember)(mask, VKI_SIGILL)
+          || VG_(sigismember)(mask, VKI_SIGTRAP)
+          || VG_(sigismember)(mask, VKI_SIGSYS);
+}
+#endif
+
 static
 void do_syscall_for_client ( Int syscallno,
                              ThreadState* tst,
@@ -354,9 +367,25 @@ void do_syscall_for_client ( Int syscallno,
    Int real_syscallno;
 #  endif
 #  if defined(VGO_linux)
+   const vki_sigset_t* restore_mask = &saved;
+   UInt* lazy = NULL;
+#  if VG_LAZY_SYSCALL_SIGMASK
+   /* Leave the client's mask installed afterwards, unless it blocks
+      signals we need to catch while running Valgrind and generated
+      code.  The mask left by the last blocking syscall will do if
+      the client has not changed its mask since. */
+   if (!blocks_sync_signals(syscall_mask)) {
+      if (!VG_(iseqsigset)(syscall_mask, &tst->host_sig_mask)) {
+         tst->host_sig_mask_lazy = 0;
+         tst->host_sig_mask = *syscall_mask;
+      }
+      restore_mask = NULL;
+      lazy = &tst->host_sig_mask_lazy;
+   }
+#  endif
    err = ML_(do_syscall_for_client_WRK)(
             syscallno, &tst->arch.vex, 
-            syscall_mask, &saved, sizeof(vki_sigset_t)
+            syscall_mask, restore_mask, sizeof(vki_sigset_t), lazy
          );
 #  elif defined(VGO_freebsd)
    if (tst->arch.vex.guest_SC_CLASS == VG_FREEBSD_SYSCALL0)
@@ -2362,6 +2391,10 @@ void VG_(client_syscall) ( ThreadId tid, UInt trc )
          and PostOnFail are ok. */
       vg_assert(0 == (sci->flags & ~(SfMayBlock | SfPostOnFail | SfPollAfter | SfKernelRestart)));
 
+      /* The client may write to the same file as our output, or wait
+         for a long time, so write out what we have buffered. */
+      VG_(flush_output_buffers)();
+
       if (sci->flags & SfMayBlock) {
 
          /* Syscall may block, so run it asynchronously */
@@ -3380,6 +3413,16 @@ Bool VG_(is_ip_in_blocking_syscall)(ThreadId tid, Addr ip)
 }
 #endif
 
+#if defined(VGO_linux) && VG_LAZY_SYSCALL_SIGMASK
+/* Returns True if ip is inside a fixable syscall code in syscall-*-*.S.  This
+   function can be called by a 'non-running' thread, and from a signal
+   handler. */
+Bool VG_(is_ip_in_blocking_syscall)(ThreadId tid, Addr ip)
+{
+   return ip >= ML_(blksys_setup) && ip < ML_(blksys_finished);
+}
+#endif
+
 
 #if defined(VGO_darwin)
 // Clean up after workq_ops(WQOPS_THREAD_RETURN) jumped to wqthread_hijack. 
@@ -3923,6 +3923,8 @@ PRE(sys_execve)
             VG_(printf)("env: %s\n", *cpp);
    }
 
+   VG_(flush_output_buffers)();
+
 #if defined(SOLARIS_EXECVE_SYSCALL_TAKES_FLAGS)
    res = VG_(do_syscall4)(__NR_execve, (UWord) path, (UWord) argv,
                           (UWord) envp, ARG4 & ~VKI_EXEC_DESCRIPTOR);
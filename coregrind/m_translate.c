@@ -37,7 +37,10 @@
 #include "pub_core_libcbase.h"
 #include "pub_core_libcassert.h"
 #include "pub_core_libcprint.h"
+#include "pub_core_libcproc.h"   // VG_(read_cycle_counter)
+#include "pub_core_mallocfree.h"
 #include "pub_core_options.h"
+#include "pub_core_xarray.h"
 
 #include "pub_core_debuginfo.h"  // VG_(get_fnname_w_offset)
 #include "pub_core_redir.h"      // VG_(redir_do_lookup)
@@ -57,6 +60,7 @@
 #include "pub_core_execontext.h"  // VG_(make_depth_1_ExeContext_from_Addr)
 
 #include "pub_core_gdbserver.h"   // VG_(instrument_for_gdbserver_if_needed)
+#include "pub_core_scheduler.h"   // VG_(stats__n_xIndir_cache_hits_32)
 
 #include "libvex_emnote.h"        // For PPC, EmWarn_PPC64_redir_underflow
 
@@ -80,6 +84,124 @@ static ULong n_PX_VexRegUpdUnwindregsAtMemAccess = 0;
 static ULong n_PX_VexRegUpdAllregsAtMemAccess    = 0;
 static ULong n_PX_VexRegUpdAllregsAtEachInsn     = 0;
 
+/* Translation time profile, only collected with --stats=yes.  Times
+   are in VG_(read_cycle_counter) units.  ticks_total covers the whole
+   of VG_(translate), so the part not accounted for by the VEX phases
+   is the core's own overhead (redirection, self-check decisions,
+   adding to the translation table). */
+static ULong ticks_total = 0;
+static ULong ticks_phase[VexPhase_N];
+
+static const HChar* const phase_names[VexPhase_N] = {
+   [VexPhase_Decode]      = "decode",
+   [VexPhase_Opt1]        = "iropt1",
+   [VexPhase_Instrument1] = "instrument",
+   [VexPhase_Instrument2] = "SP-update",
+   [VexPhase_Opt2]        = "iropt2",
+   [VexPhase_ISel]        = "isel",
+   [VexPhase_RegAlloc]    = "regalloc",
+   [VexPhase_Assemble]    = "assemble"
+};
+
+/* Translation time, per object the guest code came from. */
+typedef
+   struct {
+      const HChar* name;
+      ULong n_traces;
+      ULong ticks;
+      ULong ticks_instrument;
+   }
+   ObjTransCost;
+
+static XArray* obj_trans_costs = NULL; /* of ObjTransCost */
+static Word    obj_trans_costs_last = -1; /* cache of last used index */
+
+static void note_translation_cost ( Addr addr, ULong ticks,
+                                    const VexTranslateResult* tres )
+{
+   NSegment const* seg = VG_(am_find_nsegment)(addr);
+   const HChar* name = seg ? VG_(am_get_filename)(seg) : NULL;
+   ObjTransCost* cost = NULL;
+   Word i, n;
+
+   if (name == NULL)
+      name = "???";
+   if (obj_trans_costs == NULL)
+      obj_trans_costs = VG_(newXA)(VG_(malloc), "transl.ntc.1",
+                                   VG_(free), sizeof(ObjTransCost));
+
+   n = VG_(sizeXA)(obj_trans_costs);
+   if (obj_trans_costs_last >= 0 && obj_trans_costs_last < n) {
+      cost = VG_(indexXA)(obj_trans_costs, obj_trans_costs_last);
+      if (!VG_STREQ(cost->name, name))
+         cost = NULL;
+   }
+   for (i = 0; cost == NULL && i < n; i++) {
+      ObjTransCost* c = VG_(indexXA)(obj_trans_costs, i);
+      if (VG_STREQ(c->name, name)) {
+         cost = c;
+         obj_trans_costs_last = i;
+      }
+   }
+   if (cost == NULL) {
+      ObjTransCost c = { VG_(strdup)("transl.ntc.2", name), 0, 0, 0 };
+      obj_trans_costs_last = VG_(addToXA)(obj_trans_costs, &c);
+      cost = VG_(indexXA)(obj_trans_costs, obj_trans_costs_last);
+   }
+
+   cost->n_traces++;
+   cost->ticks += ticks;
+   cost->ticks_instrument += tres->phase_ticks[VexPhase_Instrument1];
+}
+
+static Int cmp_ObjTransCost_by_ticks ( const void* v1, const void* v2 )
+{
+   const ObjTransCost* c1 = v1;
+   const ObjTransCost* c2 = v2;
+   if (c1->ticks > c2->ticks) return -1;
+   if (c1->ticks < c2->ticks) return 1;
+   return 0;
+}
+
+static void print_translation_time_stats ( void )
+{
+   ULong ticks_vex = 0;
+   Int   i;
+   HChar buf[256];
+   Int   n = 0;
+
+   for (i = 0; i < VexPhase_N; i++)
+      ticks_vex += ticks_phase[i];
+
+   VG_(message)(Vg_DebugMsg,
+                "translate: time: %'llu ticks, of which %'llu (%3.1f%%) "
+                "in VEX\n",
+                ticks_total, ticks_vex, ticks_vex * 100.0 / ticks_total);
+   for (i = 0; i < VexPhase_N; i++) {
+      n += VG_(snprintf)(buf + n, sizeof(buf) - n, " %s %3.1f%%%s",
+                         phase_names[i], ticks_phase[i] * 100.0 / ticks_total,
+                         i < VexPhase_N - 1 ? "," : "");
+      if (i == VexPhase_Instrument2 || i == VexPhase_N - 1) {
+         VG_(message)(Vg_DebugMsg, "translate:  %s\n", buf);
+         n = 0;
+      }
+   }
+
+   /* Show the objects whose code took longest to translate. */
+   VG_(setCmpFnXA)(obj_trans_costs, cmp_ObjTransCost_by_ticks);
+   VG_(sortXA)(obj_trans_costs);
+   obj_trans_costs_last = -1;
+   for (i = 0; i < VG_(sizeXA)(obj_trans_costs) && i < 10; i++) {
+      const ObjTransCost* c = VG_(indexXA)(obj_trans_costs, i);
+      VG_(message)(Vg_DebugMsg,
+                   "translate: %5.1f%% (instrument %4.1f%%) %'9llu traces "
+                   "%s\n",
+                   c->ticks * 100.0 / ticks_total,
+                   c->ticks_instrument * 100.0 / ticks_total,
+                   c->n_traces, c->name);
+   }
+}
+
 void VG_(print_translation_stats) ( void )
 {
    VG_(message)
@@ -121,6 +243,9 @@ void VG_(print_translation_stats) ( void )
        "  AllRegs %'llu,  AllRegsAllInsns %'llu\n",
        n_PX_VexRegUpdSpAtMemAccess, n_PX_VexRegUpdUnwindregsAtMemAccess,
        n_PX_VexRegUpdAllregsAtMemAccess, n_PX_VexRegUpdAllregsAtEachInsn);
+
+   if (ticks_total > 0)
+      print_translation_time_stats();
 }
 
 /*------------------------------------------------------------*/
@@ -1510,12 +1635,20 @@ Bool VG_(translate) ( ThreadId tid,
    VexTranslateArgs   vta;
    VexTranslateResult tres;
    VgCallbackClosure  closure;
+   ULong              ticks_start;
+
+   ticks_start = VG_(clo_stats) ? VG_(read_cycle_counter)() : 0;
 
    /* Make sure Vex is initialised right. */
 
    static Bool vex_init_done = False;
 
    if (!vex_init_done) {
+      /* With --stats=yes, have the XIndir inline caches count their
+         hits. */
+      if (VG_(clo_stats))
+         VG_(clo_vex_control).xindir_cache_hits
+            = &VG_(stats__n_xIndir_cache_hits_32);
       LibVEX_Init ( &failure_exit, &log_bytes, 
                     1,     /* debug_paranoia */ 
                     &VG_(clo_vex_control) );
@@ -1799,9 +1932,12 @@ Bool VG_(translate) ( ThreadId tid,
                               : NULL;
    vta.needs_self_check  = needs_self_check;
    vta.preamble_function = preamble_fn;
+   vta.read_timer        = VG_(clo_stats) ? VG_(read_cycle_counter) : NULL;
    vta.traceflags        = verbosity;
    vta.sigill_diag       = VG_(clo_sigill_diag);
-   vta.addProfInc        = VG_(clo_profyle_sbs) && kind != T_NoRedir;
+   vta.addProfInc        = (VG_(clo_profyle_sbs)
+                            || VG_(clo_sb_profile_file) != NULL)
+                           && kind != T_NoRedir;
 
    /* Set up the dispatch continuation-point info.  If this is a
       no-redir translation then it cannot be chained, and the chain-me
@@ -1880,6 +2016,14 @@ Bool VG_(translate) ( ThreadId tid,
       }
    }
 
+   if (VG_(clo_stats) && !debugging_translation) {
+      ULong ticks = VG_(read_cycle_counter)() - ticks_start;
+      ticks_total += ticks;
+      for (i = 0; i < VexPhase_N; i++)
+         ticks_phase[i] += tres.phase_ticks[i];
+      note_translation_cost(addr, ticks, &tres);
+   }
+
    return True;
 }
 
@@ -42,6 +42,8 @@
 #include "pub_core_mallocfree.h" // VG_(out_of_memory_NORETURN)
 #include "pub_core_xarray.h"
 #include "pub_core_dispatch.h"   // For VG_(disp_cp*) addresses
+#include "pub_core_hwprof.h"     // VG_(hwprof_drain)
+#include "pub_core_sbprofile.h"  // VG_(add_SB_profile_count)
 
 
 #define DEBUG_TRANSTAB 0
@@ -107,9 +109,10 @@ typedef
    struct {
       SECno from_sNo;   /* sector number */
       TTEno from_tteNo; /* TTE number in given sector */
-      UInt  from_offs: (sizeof(UInt)*8)-1;  /* code offset from TCEntry::tcptr
+      UInt  from_offs: (sizeof(UInt)*8)-2;  /* code offset from TCEntry::tcptr
                                                where the patch is */
       Bool  to_fastEP:1; /* Is the patch to a fast or slow entry point? */
+      Bool  is_xindir:1; /* Is the patch an XIndir inline cache fill? */
    }
    InEdge;
 
@@ -217,7 +220,10 @@ typedef
          that we can undo the chaining of each mentioned patch point.
          The 'out_edges' list exists only so that we can visit the
          'in_edges' entries of all blocks we're patched through to, in
-         order to remove ourselves from then when we're deleted. */
+         order to remove ourselves from then when we're deleted.
+         Filled-in XIndir inline caches (see
+         VG_(tt_tc_do_xindir_patching)) are recorded as edges too, so
+         that they get emptied again when their target is deleted. */
 
       /* A translation can disappear for two reasons:
           1. erased (as part of the oldest sector cleanup) when the
@@ -566,6 +572,7 @@ static void InEdge__init ( InEdge* ie )
    ie->from_tteNo = 0;
    ie->from_offs  = 0;
    ie->to_fastEP  = False;
+   ie->is_xindir  = False;
 }
 
 static void OutEdge__init ( OutEdge* oe )
@@ -843,6 +850,21 @@ Bool find_TTEntry_from_hcode( /*OUT*/SECno* from_sNo,
 }
 
 
+/* Find the translation in the main code cache whose host code
+   contains hcode, and return the guest address its code starts at. */
+Bool VG_(search_transtab_by_hcode) ( /*OUT*/Addr* guest_addr, Addr hcode )
+{
+   SECno sNo;
+   TTEno tteNo;
+
+   vg_assert(init_done);
+   if (!find_TTEntry_from_hcode(&sNo, &tteNo, (void*)hcode))
+      return False;
+   *guest_addr = sectors[sNo].ttH[tteNo].vge_base[0];
+   return True;
+}
+
+
 /* Figure out whether or not hcode is jitted code present in the main
    code cache (but not in the no-redir cache).  Used for sanity
    checking. */
@@ -862,6 +884,41 @@ static Bool is_in_the_main_TC ( const void* hcode )
 }
 
 
+/* Record a patched jump from from__patch_addr (inside from_sNo/
+   from_tteNo) to to_sNo/to_tteNo, in both blocks' edge sets. */
+static void add_edge ( void* from__patch_addr,
+                       SECno from_sNo, TTEno from_tteNo,
+                       SECno to_sNo, TTEno to_tteNo,
+                       Bool to_fastEP, Bool is_xindir )
+{
+   TTEntryC* from_tteC = index_tteC(from_sNo, from_tteNo);
+   TTEntryC* to_tteC   = index_tteC(to_sNo, to_tteNo);
+
+   /* This is the new from_ -> to_ link to add. */
+   InEdge ie;
+   InEdge__init(&ie);
+   ie.from_sNo   = from_sNo;
+   ie.from_tteNo = from_tteNo;
+   ie.to_fastEP  = to_fastEP;
+   ie.is_xindir  = is_xindir;
+   HWord from_offs = (HWord)( (UChar*)from__patch_addr
+                              - (UChar*)from_tteC->tcptr );
+   vg_assert(from_offs < 100000/* let's say */);
+   ie.from_offs  = (UInt)from_offs;
+
+   /* This is the new to_ -> from_ backlink to add. */
+   OutEdge oe;
+   OutEdge__init(&oe);
+   oe.to_sNo    = to_sNo;
+   oe.to_tteNo  = to_tteNo;
+   oe.from_offs = (UInt)from_offs;
+
+   /* Add .. */
+   InEdgeArr__add(&to_tteC->in_edges, &ie);
+   OutEdgeArr__add(&from_tteC->out_edges, &oe);
+}
+
+
 /* Fulfill a chaining request, and record admin info so we
    can undo it later, if required.
 */
@@ -910,8 +967,6 @@ void VG_(tt_tc_do_chaining) ( void* from__patch_addr,
       return;
    }
 
-   TTEntryC* from_tteC = index_tteC(from_sNo, from_tteNo);
-
    /* Get VEX to do the patching itself.  We have to hand it off
       since it is host-dependent. */
    VexInvalRange vir
@@ -929,39 +984,69 @@ void VG_(tt_tc_do_chaining) ( void* from__patch_addr,
       for the two translations involved, so we can undo the chaining
       later, which we will have to do if the to_ block gets removed
       for whatever reason. */
+   add_edge( from__patch_addr, from_sNo, from_tteNo,
+             to_sNo, to_tteNo, to_fastEP, False/*!is_xindir*/ );
+}
 
-   /* This is the new from_ -> to_ link to add. */
-   InEdge ie;
-   InEdge__init(&ie);
-   ie.from_sNo   = from_sNo;
-   ie.from_tteNo = from_tteNo;
-   ie.to_fastEP  = to_fastEP;
-   HWord from_offs = (HWord)( (UChar*)from__patch_addr
-                              - (UChar*)from_tteC->tcptr );
-   vg_assert(from_offs < 100000/* let's say */);
-   ie.from_offs  = (UInt)from_offs;
 
-   /* This is the new to_ -> from_ backlink to add. */
-   OutEdge oe;
-   OutEdge__init(&oe);
-   oe.to_sNo    = to_sNo;
-   oe.to_tteNo  = to_tteNo;
-   oe.from_offs = (UInt)from_offs;
+/* Fulfill a request to fill in the inline cache of an XIndir, and
+   record admin info so we can undo it later, if required.  This is
+   the same as chaining, except that the patched site still checks
+   the guest address before jumping, and always jumps to the slow
+   entry point.
+*/
+void VG_(tt_tc_do_xindir_patching) ( void* from__patch_addr,
+                                     SECno to_sNo,
+                                     TTEno to_tteNo )
+{
+   /* Get the CPU info established at startup. */
+   VexArch     arch_host = VexArch_INVALID;
+   VexArchInfo archinfo_host;
+   VG_(bzero_inline)(&archinfo_host, sizeof(archinfo_host));
+   VG_(machine_get_VexArchInfo)( &arch_host, &archinfo_host );
+   VexEndness endness_host = archinfo_host.endness;
 
-   /* Add .. */
-   InEdgeArr__add(&to_tteC->in_edges, &ie);
-   OutEdgeArr__add(&from_tteC->out_edges, &oe);
+   TTEntryC* to_tteC   = index_tteC(to_sNo, to_tteNo);
+   void*     host_code = to_tteC->tcptr;
+
+   // stay sane -- the patch point (dst) is in this sector's code cache
+   vg_assert( (UChar*)host_code >= (UChar*)sectors[to_sNo].tc );
+   vg_assert( (UChar*)host_code <= (UChar*)sectors[to_sNo].tc_next
+                                   + sizeof(ULong) - 1 );
+
+   /* As for chaining, the from_ block may have disappeared in the
+      meantime, in which case there is nothing to do. */
+   SECno from_sNo   = INV_SNO;
+   TTEno from_tteNo = INV_TTE;
+   Bool from_found
+      = find_TTEntry_from_hcode( &from_sNo, &from_tteNo,
+                                 from__patch_addr );
+   if (!from_found) {
+      VG_(debugLog)(1,"transtab",
+                    "host code %p not found (discarded? sector recycled?)"
+                    " => no xindir patching done\n",
+                    from__patch_addr);
+      return;
+   }
+
+   VexInvalRange vir
+      = LibVEX_PatchXIndir( arch_host, endness_host, from__patch_addr,
+                            to_tteC->entry, host_code );
+   VG_(invalidate_icache)( (void*)vir.start, vir.len );
+
+   add_edge( from__patch_addr, from_sNo, from_tteNo,
+             to_sNo, to_tteNo, False/*!to_fastEP*/, True/*is_xindir*/ );
 }
 
 
 /* Unchain one patch, as described by the specified InEdge.  For
    sanity check purposes only (to check that the patched location is
-   as expected) it also requires the fast and slow entry point
-   addresses of the destination block (that is, the block that owns
-   this InEdge). */
+   as expected) it also requires the guest address and the fast and
+   slow entry point addresses of the destination block (that is, the
+   block that owns this InEdge). */
 __attribute__((noinline))
 static void unchain_one ( VexArch arch_host, VexEndness endness_host,
-                          InEdge* ie,
+                          InEdge* ie, Addr to_guest,
                           void* to_fastEPaddr, void* to_slowEPaddr )
 {
    vg_assert(ie);
@@ -969,6 +1054,16 @@ static void unchain_one ( VexArch arch_host, VexEndness endness_host,
       = index_tteC(ie->from_sNo, ie->from_tteNo);
    UChar* place_to_patch
       = ((UChar*)tteC->tcptr) + ie->from_offs;
+   if (ie->is_xindir) {
+      vg_assert(!ie->to_fastEP);
+      vg_assert( is_in_the_main_TC(place_to_patch) );
+      vg_assert( is_in_the_main_TC(to_slowEPaddr) );
+      VexInvalRange vir
+         = LibVEX_UnPatchXIndir( arch_host, endness_host, place_to_patch,
+                                 to_guest, to_slowEPaddr );
+      VG_(invalidate_icache)( (void*)vir.start, vir.len );
+      return;
+   }
    UChar* disp_cp_chain_me
       = VG_(fnptr_to_fnentry)(
            ie->to_fastEP ? &VG_(disp_cp_chain_me_to_fastEP)
@@ -1017,7 +1112,8 @@ void unchain_in_preparation_for_deletion ( VexArch arch_host,
       // Undo the chaining.
       UChar* here_slow_EP = (UChar*)here_tteC->tcptr;
       UChar* here_fast_EP = here_slow_EP + evCheckSzB;
-      unchain_one(arch_host, endness_host, ie, here_fast_EP, here_slow_EP);
+      unchain_one(arch_host, endness_host, ie, here_tteC->entry,
+                  here_fast_EP, here_slow_EP);
       // Find the corresponding entry in the "from" node's out_edges,
       // and remove it.
       TTEntryC* from_tteC = index_tteC(ie->from_sNo, ie->from_tteNo);
@@ -1541,6 +1637,23 @@ static void add_to_empty_tt_list (SECno sNo, TTEno tteno)
    sectors[sNo].empty_tt_list = tteno;
 }
 
+/* With --sb-profile-file, pass the execution count of a translation to
+   m_sbprofile before it is lost, so that the exported profile covers
+   the whole run and not only the translations alive at the end. */
+static void save_SB_profile_count ( TTEntryC* tteC, const TTEntryH* tteH )
+{
+   UInt i, guest_bytes = 0;
+
+   if (LIKELY(VG_(clo_sb_profile_file) == NULL)
+       || tteC->usage.prof.count == 0)
+      return;
+   for (i = 0; i < tteH->vge_n_used; i++)
+      guest_bytes += tteH->vge_len[i];
+   VG_(add_SB_profile_count)(tteH->vge_base[0], guest_bytes,
+                             tteC->usage.prof.count);
+   tteC->usage.prof.count = 0;
+}
+
 static void initialiseSector ( SECno sno )
 {
    UInt i;
@@ -1642,6 +1755,9 @@ static void initialiseSector ( SECno sno )
          VG_(dmsg)("transtab: " "recycle  sector %d\n", sno);
       n_sectors_recycled++;
 
+      /* Pending --hw-profile samples may fall in this sector. */
+      VG_(hwprof_drain)();
+
       vg_assert(sec->ttC != NULL);
       vg_assert(sec->ttH != NULL);
       vg_assert(sec->tc_next != NULL);
@@ -1662,6 +1778,7 @@ static void initialiseSector ( SECno sno )
             vg_assert(sec->ttC[ei].n_tte2ec >= 1);
             vg_assert(sec->ttC[ei].n_tte2ec <= 3);
             n_dump_osize += TTEntryH__osize(&sec->ttH[ei]);
+            save_SB_profile_count(&sec->ttC[ei], &sec->ttH[ei]);
             /* Tell the tool too. */
             if (VG_(needs).superblock_discards) {
                VexGuestExtents vge_tmp;
@@ -2039,6 +2156,8 @@ static void delete_tte ( /*OUT*/Addr* ga_deleted,
    vg_assert(tteH->vge_base[0] != TRANSTAB_BOGUS_GUEST_ADDR);
    *ga_deleted = tteH->vge_base[0];
 
+   save_SB_profile_count(tteC, tteH);
+
    /* Unchain .. */
    unchain_in_preparation_for_deletion(arch_host, endness_host, secNo, tteno);
 
@@ -2186,6 +2305,10 @@ void VG_(discard_translations) ( Addr guest_start, ULong range,
 
    vg_assert(init_done);
 
+   /* Attribute pending --hw-profile samples while their translations
+      still exist. */
+   VG_(hwprof_drain)();
+
    VG_(debugLog)(2, "transtab",
                     "discard_translations(0x%lx, %llu) req by %s\n",
                     guest_start, range, who );
@@ -2783,6 +2906,7 @@ ULong VG_(get_SB_profile) ( SBProfEntry tops[], UInt n_tops )
       for (i = 0; i < N_TTES_PER_SECTOR; i++) {
          if (sectors[sno].ttH[i].status != InUse)
             continue;
+         save_SB_profile_count(&sectors[sno].ttC[i], &sectors[sno].ttH[i]);
          sectors[sno].ttC[i].usage.prof.count = 0;
       }
    }
@@ -2790,6 +2914,22 @@ ULong VG_(get_SB_profile) ( SBProfEntry tops[], UInt n_tops )
    return score_total;
 }
 
+void VG_(save_SB_profile_counts) ( void )
+{
+   SECno sno;
+   TTEno i;
+
+   for (sno = 0; sno < n_sectors; sno++) {
+      if (sectors[sno].tc == NULL)
+         continue;
+      for (i = 0; i < N_TTES_PER_SECTOR; i++) {
+         if (sectors[sno].ttH[i].status != InUse)
+            continue;
+         save_SB_profile_count(&sectors[sno].ttC[i], &sectors[sno].ttH[i]);
+      }
+   }
+}
+
 /*--------------------------------------------------------------------*/
 /*--- end                                                          ---*/
 /*--------------------------------------------------------------------*/
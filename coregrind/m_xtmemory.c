@@ -220,6 +220,14 @@ static ULong XT_Allocs_report_value(const void* xt_allocs)
    }
 }
 
+// The report_value function used for a binary report.
+static ULong (*binary_report_value_fn)(const void* value);
+static ULong binary_report_value(const void* value, UInt ev)
+{
+   event_report_value_id = ev;
+   return (*binary_report_value_fn)(value);
+}
+
 static void produce_report(XTree* xt, const HChar* filename,
                            const HChar* events,
                            const HChar* (*img_value) (const void* value),
@@ -265,6 +273,9 @@ static void produce_report(XTree* xt, const HChar* filename,
       }
 
       VG_(XT_massif_close)(fp);
+   } else if (VG_(strstr)(filename, ".xtb")) {
+      binary_report_value_fn = report_value;
+      VG_(XT_binary_print)(xt, filename, events, binary_report_value);
    } else
       VG_(XT_callgrind_print)(xt,
                              filename,
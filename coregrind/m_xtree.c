@@ -607,6 +607,258 @@ void VG_(XT_callgrind_print)
 }
 
 
+/* ----------- Binary output --------------------------------------------- */
+
+/* The binary xtree format is a compact alternative to the callgrind and
+   massif text formats, for big trees and for trees that must be merged
+   offline with valgrind-xtree-merge.  All integers are in the byte order
+   of the host.  A string is a UInt length followed by that many chars
+   (no terminating zero).
+      magic        8 chars "VGXTREE1"
+      pid          UInt
+      cmd          string
+      events       string (same syntax as for VG_(XT_callgrind_print))
+      n_strings    UInt, followed by n_strings strings
+      n_frames     UInt, followed by n_frames frames:
+                      ip ULong, fn UInt, file UInt, line UInt
+                   fn and file are string indexes
+      n_stacks     UInt, followed by n_stacks stacks:
+                      n_ips UInt, n_ips frame indexes (UInt), the
+                      innermost frame first, then one ULong value
+                      per event.
+   Strings and frames are numbered from 0 in the order they appear. */
+
+#define XT_BINARY_MAGIC "VGXTREE1"
+
+typedef
+   struct {
+      Int   fd;
+      UInt  used;
+      HChar buf[8192];
+   }
+   XtbFile;
+
+static void xtb_flush (XtbFile* xf)
+{
+   if (xf->used > 0)
+      VG_(write)(xf->fd, xf->buf, xf->used);
+   xf->used = 0;
+}
+
+static void xtb_put (XtbFile* xf, const void* p, UInt n)
+{
+   if (xf->used + n > sizeof(xf->buf)) {
+      xtb_flush(xf);
+      if (n > sizeof(xf->buf)) {
+         VG_(write)(xf->fd, p, n);
+         return;
+      }
+   }
+   VG_(memcpy)(xf->buf + xf->used, p, n);
+   xf->used += n;
+}
+
+static void xtb_put_UInt (XtbFile* xf, UInt v)
+{
+   xtb_put(xf, &v, sizeof(v));
+}
+
+static void xtb_put_ULong (XtbFile* xf, ULong v)
+{
+   xtb_put(xf, &v, sizeof(v));
+}
+
+static void xtb_put_str (XtbFile* xf, const HChar* s)
+{
+   UInt len = VG_(strlen)(s);
+   xtb_put_UInt(xf, len);
+   xtb_put(xf, s, len);
+}
+
+/* A frame of the binary output.  Strings are given by their number in
+   the strings dedup pool, which numbers from 1. */
+typedef
+   struct {
+      Addr ip;
+      UInt fn;
+      UInt file;
+      UInt line;
+   }
+   XtbFrame;
+
+/* Returns the number of str in ddpa.  If str is new, a copy of it is
+   recorded in strs, as str might be a transient buffer. */
+static UInt xtb_str_nr (DedupPoolAlloc* ddpa, XArray* strs, const HChar* str)
+{
+   Bool is_new;
+   UInt nr = VG_(allocStrDedupPA)(ddpa, str, &is_new);
+   if (is_new) {
+      HChar* copy = VG_(strdup)("XT_binary_print.str", str);
+      vg_assert(nr == VG_(sizeXA)(strs) + 1);
+      VG_(addToXA)(strs, &copy);
+   }
+   return nr;
+}
+
+void VG_(XT_binary_print)
+     (XTree* xt,
+      const HChar* outfilename,
+      const HChar* events,
+      ULong (*report_value)(const void* value, UInt ev))
+{
+   XT_shared* shared = xt->shared;
+   const UInt n_xecu = VG_(sizeXA)(xt->data);
+   UInt n_events = 1;
+   UInt n_stacks = 0;
+   UInt i, xecu;
+   HChar* filename_buf = NULL;
+   UInt filename_buf_size = 0;
+
+   for (i = 0; events[i]; i++)
+      if (events[i] == ',')
+         n_events++;
+
+   SysRes sres = VG_(open)(outfilename, VKI_O_CREAT|VKI_O_WRONLY|VKI_O_TRUNC,
+                           VKI_S_IRUSR|VKI_S_IWUSR|VKI_S_IRGRP|VKI_S_IROTH);
+   if (sr_isError(sres)) {
+      VG_(message)(Vg_UserMsg,
+                   "Error: can not open xtree output file `%s'\n",
+                   outfilename);
+      return;
+   }
+   XtbFile* xf = xt->alloc_fn("XT_binary_print.xf", sizeof(XtbFile));
+   xf->fd = sr_Res(sres);
+   xf->used = 0;
+
+   /* First pass: number the strings and the frames (by ip) of the
+      stacks to output.  The string values are recorded in strs, so
+      that they can be output before the frames. */
+   DedupPoolAlloc* str_ddpa = VG_(newDedupPA)(16000, 1, xt->alloc_fn,
+                                              "XT_binary_print.str",
+                                              xt->free_fn);
+   DedupPoolAlloc* ip_ddpa = VG_(newDedupPA)(16000, sizeof(Addr),
+                                             xt->alloc_fn,
+                                             "XT_binary_print.ip",
+                                             xt->free_fn);
+   XArray* strs = VG_(newXA)(xt->alloc_fn, "XT_binary_print.strs",
+                             xt->free_fn, sizeof(HChar*));
+   XArray* frames = VG_(newXA)(xt->alloc_fn, "XT_binary_print.frames",
+                               xt->free_fn, sizeof(XtbFrame));
+   Bool* selected = xt->alloc_fn("XT_binary_print.sel",
+                                 (n_xecu + 1) * sizeof(Bool));
+
+   for (xecu = 0; xecu < n_xecu; xecu++) {
+      xec* xe = (xec*)VG_(indexXA)(shared->xec, xecu);
+      const void* value = VG_(indexXA)(xt->data, xecu);
+      selected[xecu] = False;
+      if (xe->n_ips_sel == 0)
+         continue;
+      for (i = 0; i < n_events; i++)
+         if ((*report_value)(value, i) != 0)
+            break;
+      if (i == n_events)
+         continue;
+      selected[xecu] = True;
+      n_stacks++;
+
+      const Addr* ips = VG_(get_ExeContext_StackTrace)(xe->ec) + xe->top;
+      const DiEpoch ep = VG_(get_ExeContext_epoch)(xe->ec);
+      for (i = 0; i < xe->n_ips_sel; i++) {
+         UInt nr = VG_(allocFixedEltDedupPA)(ip_ddpa, sizeof(Addr), &ips[i]);
+         if (nr <= VG_(sizeXA)(frames))
+            continue; // Already known.
+         vg_assert(nr == VG_(sizeXA)(frames) + 1);
+
+         const HChar* fnname;
+         const HChar* filename_dir;
+         const HChar* filename_name;
+         XtbFrame fr;
+         fr.ip = ips[i];
+         if (!VG_(get_filename_linenum)(ep, ips[i], &filename_name,
+                                        &filename_dir, &fr.line)) {
+            filename_dir = "";
+            filename_name = "UnknownFile???";
+            fr.line = 0;
+         }
+         if (!VG_(get_fnname)(ep, ips[i], &fnname))
+            fnname = "UnknownFn???";
+         fr.fn = xtb_str_nr(str_ddpa, strs, fnname);
+
+         UInt needed_size = VG_(strlen)(filename_dir) + 1
+            + VG_(strlen)(filename_name) + 1;
+         if (filename_buf_size < needed_size) {
+            filename_buf_size = needed_size;
+            filename_buf = VG_(realloc)(xt->cc, filename_buf,
+                                        filename_buf_size);
+         }
+         VG_(strcpy)(filename_buf, filename_dir);
+         if (filename_buf[0] != '\0')
+            VG_(strcat)(filename_buf, "/");
+         VG_(strcat)(filename_buf, filename_name);
+         fr.file = xtb_str_nr(str_ddpa, strs, filename_buf);
+         VG_(addToXA)(frames, &fr);
+      }
+   }
+
+   /* Output header, strings and frames. */
+   xtb_put(xf, XT_BINARY_MAGIC, 8);
+   xtb_put_UInt(xf, VG_(getpid)());
+   {
+      HChar* cmd = VG_(strdup)(xt->cc, VG_(args_the_exename));
+      for (i = 0; i < VG_(sizeXA)(VG_(args_for_client)); i++) {
+         HChar* arg = * (HChar**) VG_(indexXA)(VG_(args_for_client), i);
+         cmd = VG_(realloc)(xt->cc, cmd,
+                            VG_(strlen)(cmd) + 1 + VG_(strlen)(arg) + 1);
+         VG_(strcat)(cmd, " ");
+         VG_(strcat)(cmd, arg);
+      }
+      xtb_put_str(xf, cmd);
+      VG_(free)(cmd);
+   }
+   xtb_put_str(xf, events);
+   xtb_put_UInt(xf, VG_(sizeXA)(strs));
+   for (i = 0; i < VG_(sizeXA)(strs); i++)
+      xtb_put_str(xf, *(HChar**)VG_(indexXA)(strs, i));
+   xtb_put_UInt(xf, VG_(sizeXA)(frames));
+   for (i = 0; i < VG_(sizeXA)(frames); i++) {
+      const XtbFrame* fr = VG_(indexXA)(frames, i);
+      xtb_put_ULong(xf, (ULong)fr->ip);
+      xtb_put_UInt(xf, fr->fn - 1);
+      xtb_put_UInt(xf, fr->file - 1);
+      xtb_put_UInt(xf, fr->line);
+   }
+
+   /* Second pass: output the stacks. */
+   xtb_put_UInt(xf, n_stacks);
+   for (xecu = 0; xecu < n_xecu; xecu++) {
+      if (!selected[xecu])
+         continue;
+      xec* xe = (xec*)VG_(indexXA)(shared->xec, xecu);
+      const void* value = VG_(indexXA)(xt->data, xecu);
+      const Addr* ips = VG_(get_ExeContext_StackTrace)(xe->ec) + xe->top;
+      xtb_put_UInt(xf, xe->n_ips_sel);
+      for (i = 0; i < xe->n_ips_sel; i++)
+         xtb_put_UInt(xf, VG_(allocFixedEltDedupPA)(ip_ddpa, sizeof(Addr),
+                                                    &ips[i]) - 1);
+      for (i = 0; i < n_events; i++)
+         xtb_put_ULong(xf, (*report_value)(value, i));
+   }
+
+   xtb_flush(xf);
+   VG_(close)(xf->fd);
+
+   for (i = 0; i < VG_(sizeXA)(strs); i++)
+      VG_(free)(*(HChar**)VG_(indexXA)(strs, i));
+   VG_(deleteXA)(strs);
+   VG_(deleteXA)(frames);
+   VG_(deleteDedupPA)(str_ddpa);
+   VG_(deleteDedupPA)(ip_ddpa);
+   xt->free_fn(selected);
+   xt->free_fn(xf);
+   VG_(free)(filename_buf);
+}
+
+
 /* ----------- Massif output ---------------------------------------------- */
 
 /* For Massif output, some functions from the execontext are not output, a.o.
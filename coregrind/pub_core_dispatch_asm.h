@@ -55,6 +55,7 @@
 #define VG_TRC_INVARIANT_FAILED    47 /* TRC only; invariant violation */
 #define VG_TRC_CHAIN_ME_TO_SLOW_EP 49 /* TRC only; chain to slow EP */
 #define VG_TRC_CHAIN_ME_TO_FAST_EP 51 /* TRC only; chain to fast EP */
+#define VG_TRC_PATCH_ME_XINDIR     53 /* TRC only; fill XIndir cache */
 
 #endif   // __PUB_CORE_DISPATCH_ASM_H
 
@@ -239,6 +239,21 @@ typedef VgdbShared32 VgdbShared;
 # error "unexpected wordsize"
 #endif
 
+// The memory shared with vgdb, once the gdbserver has created it.
+// NULL before that.
+extern VgdbShared* VG_(gdbserver_shared);
+
+// Cheap check for pending vgdb activity: True if vgdb has written
+// bytes that valgrind has not yet seen.  This is just a comparison of
+// two counters in the shared memory, so the scheduler can do it each
+// time it gets control back from generated code.  If it returns True,
+// VG_(gdbserver_activity) does the real check.
+static inline Bool VG_(gdbserver_activity_pending) (void)
+{
+   const VgdbShared* sh = VG_(gdbserver_shared);
+   return sh != NULL && sh->written_by_vgdb != sh->seen_by_valgrind;
+}
+
 
 #endif   // __PUB_CORE_GDBSERVER_H
 /*--------------------------------------------------------------------*/
@@ -0,0 +1,61 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Sampling guest code with hw counters.      pub_core_hwprof.h ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Valgrind, a dynamic binary instrumentation
+   framework.
+
+   Copyright (C) 2023 The Valgrind developers.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+#ifndef __PUB_CORE_HWPROF_H
+#define __PUB_CORE_HWPROF_H
+
+#include "pub_core_basics.h"   // VG_ macro
+
+//--------------------------------------------------------------------
+// PURPOSE: implements --hw-profile.  The kernel samples the process
+// with a perf event; the host PC of each sample is mapped back to
+// the translation it falls in, and so to guest code.  At exit, the
+// counts are written in callgrind format.
+//--------------------------------------------------------------------
+
+/* Set up --hw-profile, if asked for.  Sampling starts for each thread
+   as it enters the scheduler. */
+extern void VG_(hwprof_init) ( void );
+
+/* Start sampling the calling thread, which is about to run tid. */
+extern void VG_(hwprof_thread_start) ( ThreadId tid );
+
+/* Attribute the samples recorded by the kernel since the last call.
+   This must be done before translations are discarded, as the host
+   code of a sample can only be mapped back to guest code while its
+   translation is still in the translation table.  Does nothing if
+   sampling is not active. */
+extern void VG_(hwprof_drain) ( void );
+
+/* Stop sampling and write the profile. */
+extern void VG_(hwprof_fini) ( void );
+
+#endif   // __PUB_CORE_HWPROF_H
+
+/*--------------------------------------------------------------------*/
+/*--- end                                        pub_core_hwprof.h ---*/
+/*--------------------------------------------------------------------*/
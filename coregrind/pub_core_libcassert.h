@@ -67,7 +67,8 @@ extern void  VG_(core_panic_at)   ( const HChar* str, const UnwindStartRegs* );
 /* Exits with status as client exit code. */
 extern void VG_(client_exit)( Int status );
 
-/* Lightweight exit without any dependencies. */
+/* Lightweight exit: writes out the buffered output, but has none of
+   the other dependencies of VG_(exit). */
 __attribute__ ((__noreturn__))
 extern void VG_(exit_now)( Int status );
 
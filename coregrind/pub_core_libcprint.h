@@ -64,8 +64,14 @@ extern void VG_(init_log_xml_sinks)(VgLogTo log_to, VgLogTo xml_to,
 
 extern void VG_(print_preamble)(Bool logging_to_fd);
 
+extern void VG_(logging_atfork_pre)(ThreadId tid);
 extern void VG_(logging_atfork_child)(ThreadId tid);
 
+/* Output sent to the log and XML sinks is buffered.  This writes out
+   whatever is pending.  It is called before each client syscall, at
+   the end of each timeslice, before fork and exec, and on exit. */
+extern void VG_(flush_output_buffers)(void);
+
 /* Get the elapsed wallclock time since startup into buf which has size
    bufsize. The function will assert if bufsize is not large enough.
    Upon return, buf will contain the zero-terminated wallclock time as
@@ -101,6 +101,10 @@ struct auxv {
 
 #endif
 
+// Cheap monotonic timer for measuring short intervals; the unit is
+// platform dependent (usually cycles).
+extern ULong VG_(read_cycle_counter) ( void );
+
 // icache invalidation
 extern void VG_(invalidate_icache) ( void *ptr, SizeT nbytes );
 
@@ -132,6 +132,11 @@ extern SizeT VG_(arena_redzone_size) ( ArenaId aid );
 
 extern void  VG_(mallinfo) ( ThreadId tid, struct vg_mallinfo* mi );
 
+// The bytes currently on loan from, and mmap-ed for, an arena.  Unlike
+// VG_(mallinfo), which fills in int fields, these don't wrap at 2GB.
+extern void  VG_(arena_stats) ( ArenaId aid, /*OUT*/SizeT* bytes_on_loan,
+                                /*OUT*/SizeT* bytes_mmaped );
+
 // VG_(arena_perm_malloc) is for permanent allocation of small blocks.
 // See VG_(perm_malloc) in pub_tool_mallocfree.h for more details.
 // Do not call any VG_(arena_*) functions with these permanent blocks.
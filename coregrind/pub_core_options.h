@@ -183,6 +183,9 @@ extern UChar VG_(clo_profyle_flags);
    this-many back edges (event checks).  default: zero (== show
    profiling results only at the end of the run. */
 extern ULong VG_(clo_profyle_interval);
+/* If non-NULL, count the executions of each superblock, and write them
+   to this file at exit.  May contain %p/%q/%n. */
+extern const HChar* VG_(clo_sb_profile_file);
 
 /* DEBUG: if tracing codegen, be quiet until after this bb */
 extern Int   VG_(clo_trace_notbelow);
@@ -217,6 +220,26 @@ extern Bool  VG_(clo_trace_sched);
 extern Bool  VG_(clo_profile_heap);
 // DEBUG: report progress every N seconds (1 .. 3600)
 extern UInt VG_(clo_progress_interval);
+// If non-NULL, progress reports are written as JSON lines to this file
+// instead of being printed in the log.  May contain %p/%q/%n.
+extern const HChar *VG_(clo_progress_fname_unexpanded);
+/* Sample the process with this perf event (Linux only), and write
+   the counts per guest superblock to VG_(clo_hw_profile_file). */
+typedef
+   enum {
+      Vg_HwProfNone,
+      Vg_HwProfCycles,
+      Vg_HwProfInstructions,
+      Vg_HwProfBranchMisses,
+      Vg_HwProfCacheMisses,
+      Vg_HwProfCpuClock
+   }
+   VgHwProfEvent;
+extern VgHwProfEvent VG_(clo_hw_profile);
+/* Take a sample every this many events. */
+extern UInt VG_(clo_hw_profile_period);
+/* Name of the profile, may contain %p/%q/%n. */
+extern const HChar* VG_(clo_hw_profile_file);
 #define MAX_REDZONE_SZB 128
 // Maximum for the default values for core arenas and for client
 // arena given by the tool.
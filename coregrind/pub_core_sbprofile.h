@@ -38,6 +38,16 @@
    run-end profile. */
 void VG_(get_and_show_SB_profile) ( ULong ecs_done );
 
+/* For --sb-profile-file: add count executions of the superblock
+   starting at guest_addr, which is guest_bytes long, to the profile
+   written at exit. */
+void VG_(add_SB_profile_count) ( Addr guest_addr, UInt guest_bytes,
+                                 ULong count );
+
+/* Collect the counts of the live translations, and write the profile
+   to the --sb-profile-file. */
+void VG_(write_SB_profile) ( void );
+
 #endif   // __PUB_CORE_SBPROFILE_H
 
 /*--------------------------------------------------------------------*/
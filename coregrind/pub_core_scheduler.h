@@ -110,6 +110,13 @@ extern void VG_(force_vgdb_poll) ( void );
 /* Stats ... */
 extern void VG_(print_scheduler_stats) ( void );
 
+/* Number of event checks (roughly, blocks run) done so far. */
+extern ULong VG_(get_bbs_done) ( void );
+
+/* Hits in the XIndir inline caches, counted by generated code if
+   VexControl.xindir_cache_hits points here (--stats=yes). */
+extern UInt VG_(stats__n_xIndir_cache_hits_32);
+
 /* If False, a fault is Valgrind-internal (ie, a bug) */
 extern Bool VG_(in_generated_code);
 
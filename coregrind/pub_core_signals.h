@@ -52,6 +52,18 @@ extern void VG_(sigstartup_actions) ( void );
    context to deliver one (viz, create signal frames if needed) */
 extern void VG_(poll_signals) ( ThreadId );
 
+/* True if the client has a handler installed for some asynchronous
+   signal.  The scheduler then polls more often than once a
+   timeslice, so that such signals are not held back for long. */
+extern Bool VG_(client_catches_async_signals);
+
+/* The standard set of blocked signals, used whenever we're not
+   running a client syscall: all but the synchronous ones. */
+extern void VG_(get_sched_sigmask) ( vki_sigset_t* mask );
+
+/* Stats ... */
+extern void VG_(print_signal_stats) ( void );
+
 /* Fake system calls for signal handling. */
 extern SysRes VG_(do_sys_sigaltstack) ( ThreadId tid, vki_stack_t* ss,
                                                       vki_stack_t* oss );
@@ -66,7 +66,22 @@ extern void VG_(fixup_guest_state_after_syscall_interrupted)(
                struct vki_ucontext *uc
             );
 
-#if defined(VGO_solaris)
+/* Normally a thread blocks async signals again as soon as a blocking
+   syscall returns, which costs two sigprocmask syscalls per blocking
+   syscall.  On these platforms the client's mask is instead left
+   installed until an async signal actually arrives outside
+   ML_(do_syscall_for_client_WRK).  The handler then puts the signal
+   back as pending and returns with async signals blocked again, for
+   the signal to be polled for as usual.  So the next blocking
+   syscall only needs to change the mask if that happened, or if the
+   client's mask has changed. */
+#if defined(VGP_amd64_linux)
+#  define VG_LAZY_SYSCALL_SIGMASK 1
+#else
+#  define VG_LAZY_SYSCALL_SIGMASK 0
+#endif
+
+#if defined(VGO_solaris) || VG_LAZY_SYSCALL_SIGMASK
 // Determine if in a blocking syscall.
 extern Bool VG_(is_ip_in_blocking_syscall)(ThreadId tid, Addr ip);
 #endif
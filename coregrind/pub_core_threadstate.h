@@ -321,6 +321,10 @@ typedef
    ThreadOSstate;
 
 
+/* Room for signals deferred by a thread before the next poll; see
+   deferred_sigs below. */
+#define N_DEFERRED_SIGNALS 8
+
 /* Overall thread state */
 typedef struct {
    /* ThreadId == 0 (and hence vg_threads[0]) is NEVER USED.
@@ -361,6 +365,23 @@ typedef struct {
       is set when an handler runs "inside" a sigsuspend. */
    vki_sigset_t tmp_sig_mask;
 
+   /* Nonzero if the host signal mask of this thread is still
+      host_sig_mask, as left installed after a blocking syscall,
+      rather than the mask blocking async signals.  Only used if
+      VG_LAZY_SYSCALL_SIGMASK (see pub_core_syswrap.h). */
+   UInt         host_sig_mask_lazy;
+   vki_sigset_t host_sig_mask;
+
+   /* Process-directed signals which the lazily left mask let in
+      after the client had blocked them.  The async signal handler,
+      which may not hold the lock, adds them at deferred_sigs_in, and
+      VG_(poll_signals), in whichever thread, moves them from
+      deferred_sigs_out on to the process-wide queue.  Both counters
+      only increase; entries are indexed modulo N_DEFERRED_SIGNALS. */
+   vki_siginfo_t deferred_sigs[N_DEFERRED_SIGNALS];
+   volatile UInt deferred_sigs_in;
+   volatile UInt deferred_sigs_out;
+
    /* A little signal queue for signals we can't get the kernel to
       queue for us.  This is only allocated as needed, since it should
       be rare. */
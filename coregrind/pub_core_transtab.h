@@ -190,12 +190,23 @@ void VG_(tt_tc_do_chaining) ( void* from__patch_addr,
                               TTEno to_tteNo,
                               Bool  to_fastEP );
 
+extern
+void VG_(tt_tc_do_xindir_patching) ( void* from__patch_addr,
+                                     SECno to_sNo,
+                                     TTEno to_tteNo );
+
 extern Bool VG_(search_transtab) ( /*OUT*/Addr*  res_hcode,
                                    /*OUT*/SECno* res_sNo,
                                    /*OUT*/TTEno* res_tteNo,
                                    Addr          guest_addr, 
                                    Bool          upd_cache );
 
+/* Find the translation in the main TC containing the host code
+   address hcode, and give the guest address where its code starts.
+   Used by --hw-profile to map samples back to guest code. */
+extern Bool VG_(search_transtab_by_hcode) ( /*OUT*/Addr* guest_addr,
+                                            Addr hcode );
+
 extern void VG_(discard_translations) ( Addr  start, ULong range,
                                         const HChar* who );
 
@@ -225,6 +236,10 @@ typedef struct _SBProfEntry {
 
 extern ULong VG_(get_SB_profile) ( SBProfEntry tops[], UInt n_tops );
 
+/* For --sb-profile-file: hand the counts of all live translations to
+   VG_(add_SB_profile_count), and zero them. */
+extern void VG_(save_SB_profile_counts) ( void );
+
 //  Exported variables
 extern Bool  VG_(ok_to_discard_translations);
 
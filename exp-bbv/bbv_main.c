@@ -63,6 +63,7 @@ static HChar *bb_out_file=NULL;
    /* output parameters */
 static Bool instr_count_only=False;
 static Bool generate_pc_file=False;
+static Bool compact_output=False;
 
    /* Global values */
 static OSet* instr_info_table;  /* table that holds the basic block info */
@@ -70,6 +71,7 @@ static Int block_num=1;         /* global next block number */
 static Int current_thread=0;
 static Int allocated_threads=1;
 struct thread_info *bbv_thread=NULL;
+static struct thread_info *cur_thread=NULL; /* &bbv_thread[current_thread] */
 
    /* Per-thread variables */
 struct thread_info {
@@ -81,6 +83,19 @@ struct thread_info {
    ULong unique_rep_count;
    ULong fldcw_count;       /* fldcw count */
    VgFile *bbtrace_fp;      /* file pointer */
+
+      /* blocks entered in the current interval, so that dumping an */
+      /*   interval costs in proportion to the blocks it ran        */
+   struct BB_info **touched;
+   Int n_touched;
+   Int touched_size;
+
+      /* the last interval written, and how many times it has been */
+      /*   repeated since, for --bb-out-format=compact             */
+   Int *prev_vec;           /* block number / frequency pairs */
+   Int n_prev;
+   Int prev_size;
+   Int n_repeats;
 };
 
 struct BB_info {
@@ -148,46 +163,149 @@ static VgFile *open_tracefile(Int thread_num)
    return fp;
 }
 
+static Int cmp_BB_addr(const void *a, const void *b)
+{
+   Addr a1=(*(struct BB_info *const *)a)->BB_addr;
+   Addr a2=(*(struct BB_info *const *)b)->BB_addr;
+   return a1 < a2 ? -1 : (a1 > a2 ? 1 : 0);
+}
+
+static Int cmp_BB_num(const void *a, const void *b)
+{
+   Int n1=(*(struct BB_info *const *)a)->block_num;
+   Int n2=(*(struct BB_info *const *)b)->block_num;
+   return n1 < n2 ? -1 : (n1 > n2 ? 1 : 0);
+}
+
+   /* remember a block the first time it is entered in an interval */
+static void note_touched(struct thread_info *ti, struct BB_info *bbInfo)
+{
+   if (ti->n_touched == ti->touched_size) {
+      ti->touched_size = ti->touched_size ? 2*ti->touched_size : 64;
+      ti->touched = VG_(realloc)("bbv_main.c touched", ti->touched,
+                                 ti->touched_size*sizeof(struct BB_info *));
+   }
+   ti->touched[ti->n_touched++] = bbInfo;
+}
+
+static void flush_repeats(struct thread_info *ti)
+{
+   if (ti->n_repeats > 0) {
+      VG_(fprintf)(ti->bbtrace_fp, "R:%d\n", ti->n_repeats);
+      ti->n_repeats = 0;
+   }
+}
+
+   /* Write an interval in the compact format: blocks in block   */
+   /*   number order, each number given as the difference from  */
+   /*   the one before, and a run of intervals identical to the */
+   /*   one before collapsed into a single repeat count.        */
+static void dump_interval_compact(struct thread_info *ti, Int thread)
+{
+   Int i, same;
+
+   VG_(ssort)(ti->touched, ti->n_touched, sizeof(struct BB_info *),
+              cmp_BB_num);
+
+   same = ti->n_prev == ti->n_touched;
+   for (i=0; same && i<ti->n_touched; i++) {
+      same = ti->prev_vec[2*i]   == ti->touched[i]->block_num &&
+             ti->prev_vec[2*i+1] == ti->touched[i]->inst_counter[thread];
+   }
+
+   if (same) {
+      ti->n_repeats++;
+      return;
+   }
+
+   flush_repeats(ti);
+
+   if (2*ti->n_touched > ti->prev_size) {
+      ti->prev_size = 2*ti->n_touched;
+      ti->prev_vec = VG_(realloc)("bbv_main.c prev_vec", ti->prev_vec,
+                                  ti->prev_size*sizeof(Int));
+   }
+
+   VG_(fprintf)(ti->bbtrace_fp, "D");
+   for (i=0; i<ti->n_touched; i++) {
+      Int num = ti->touched[i]->block_num;
+      Int cnt = ti->touched[i]->inst_counter[thread];
+      VG_(fprintf)(ti->bbtrace_fp, ":%d:%d",
+                   num - (i ? ti->prev_vec[2*i-2] : 0), cnt);
+      ti->prev_vec[2*i]   = num;
+      ti->prev_vec[2*i+1] = cnt;
+   }
+   ti->n_prev = ti->n_touched;
+   VG_(fprintf)(ti->bbtrace_fp, "\n");
+}
+
 static void handle_overflow(void)
 {
-   struct BB_info *bb_elem;
+   struct thread_info *ti = cur_thread;
+   Int i;
 
-   if (bbv_thread[current_thread].dyn_instr > interval_size) {
+   if (ti->dyn_instr > interval_size) {
 
       if (!instr_count_only) {
 
             /* If our output file hasn't been opened, open it */
-         if (bbv_thread[current_thread].bbtrace_fp == NULL) {
-            bbv_thread[current_thread].bbtrace_fp=open_tracefile(current_thread);
+         if (ti->bbtrace_fp == NULL) {
+            ti->bbtrace_fp=open_tracefile(current_thread);
          }
 
            /* put an entry to the bb.out file */
 
-         VG_(fprintf)(bbv_thread[current_thread].bbtrace_fp, "T");
-
-         VG_(OSetGen_ResetIter)(instr_info_table);
-         while ( (bb_elem = VG_(OSetGen_Next)(instr_info_table)) ) {
-            if ( bb_elem->inst_counter[current_thread] != 0 ) {
-               VG_(fprintf)(bbv_thread[current_thread].bbtrace_fp, ":%d:%d   ",
-                            bb_elem->block_num,
-                            bb_elem->inst_counter[current_thread]);
-               bb_elem->inst_counter[current_thread] = 0;
+         if (compact_output) {
+            dump_interval_compact(ti, current_thread);
+         }
+         else {
+               /* blocks are listed in address order */
+            VG_(ssort)(ti->touched, ti->n_touched, sizeof(struct BB_info *),
+                       cmp_BB_addr);
+
+            VG_(fprintf)(ti->bbtrace_fp, "T");
+            for (i=0; i<ti->n_touched; i++) {
+               VG_(fprintf)(ti->bbtrace_fp, ":%d:%d   ",
+                            ti->touched[i]->block_num,
+                            ti->touched[i]->inst_counter[current_thread]);
             }
+            VG_(fprintf)(ti->bbtrace_fp, "\n");
          }
+      }
 
-         VG_(fprintf)(bbv_thread[current_thread].bbtrace_fp, "\n");
+      for (i=0; i<ti->n_touched; i++) {
+         ti->touched[i]->inst_counter[current_thread] = 0;
       }
+      ti->n_touched = 0;
 
-      bbv_thread[current_thread].dyn_instr -= interval_size;
+      ti->dyn_instr -= interval_size;
    }
 }
 
 
 static void close_out_reps(void)
 {
-   bbv_thread[current_thread].global_rep_count+=bbv_thread[current_thread].rep_count;
-   bbv_thread[current_thread].unique_rep_count++;
-   bbv_thread[current_thread].rep_count=0;
+   cur_thread->global_rep_count+=cur_thread->rep_count;
+   cur_thread->unique_rep_count++;
+   cur_thread->rep_count=0;
+}
+
+   /* Count n_instrs instructions of bbInfo */
+static inline void count_instrs(struct BB_info *bbInfo, Int n_instrs)
+{
+   Int *counter = &bbInfo->inst_counter[current_thread];
+
+   if (*counter == 0) {
+      note_touched(cur_thread, bbInfo);
+   }
+   *counter+=n_instrs;
+
+   cur_thread->total_instr+=n_instrs;
+   cur_thread->dyn_instr +=n_instrs;
+
+   if (cur_thread->dyn_instr > interval_size) {
+      handle_overflow();
+   }
 }
 
    /* Generic function to get called each instruction */
@@ -198,33 +316,28 @@ static VG_REGPARM(1) void per_instruction_BBV(struct BB_info *bbInfo)
    tl_assert(bbInfo);
 
       /* we finished rep but didn't clear out count */
-   if (bbv_thread[current_thread].rep_count) {
+   if (UNLIKELY(cur_thread->rep_count)) {
       n_instrs++;
       close_out_reps();
    }
 
-   bbInfo->inst_counter[current_thread]+=n_instrs;
-
-   bbv_thread[current_thread].total_instr+=n_instrs;
-   bbv_thread[current_thread].dyn_instr +=n_instrs;
-
-   handle_overflow();
+   count_instrs(bbInfo, n_instrs);
 }
 
    /* Function to get called if instruction has a rep prefix */
 static VG_REGPARM(1) void per_instruction_BBV_rep(Addr addr)
 {
       /* handle back-to-back rep instructions */
-   if (bbv_thread[current_thread].last_rep_addr!=addr) {
-      if (bbv_thread[current_thread].rep_count) {
+   if (cur_thread->last_rep_addr!=addr) {
+      if (cur_thread->rep_count) {
          close_out_reps();
-         bbv_thread[current_thread].total_instr++;
-         bbv_thread[current_thread].dyn_instr++;
+         cur_thread->total_instr++;
+         cur_thread->dyn_instr++;
       }
-      bbv_thread[current_thread].last_rep_addr=addr;
+      cur_thread->last_rep_addr=addr;
    }
 
-   bbv_thread[current_thread].rep_count++;
+   cur_thread->rep_count++;
 
 }
 
@@ -236,20 +349,15 @@ static VG_REGPARM(1) void per_instruction_BBV_fldcw(struct BB_info *bbInfo)
    tl_assert(bbInfo);
 
       /* we finished rep but didn't clear out count */
-   if (bbv_thread[current_thread].rep_count) {
+   if (cur_thread->rep_count) {
       n_instrs++;
       close_out_reps();
    }
 
       /* count fldcw instructions */
-   bbv_thread[current_thread].fldcw_count++;
-
-   bbInfo->inst_counter[current_thread]+=n_instrs;
-
-   bbv_thread[current_thread].total_instr+=n_instrs;
-   bbv_thread[current_thread].dyn_instr +=n_instrs;
+   cur_thread->fldcw_count++;
 
-   handle_overflow();
+   count_instrs(bbInfo, n_instrs);
 }
 
    /* Check if the instruction pointed to is one that needs */
@@ -475,6 +583,13 @@ static struct thread_info *allocate_new_thread(struct thread_info *old,
       temp[i].rep_count=0;
       temp[i].fldcw_count=0;
       temp[i].bbtrace_fp=NULL;
+      temp[i].touched=NULL;
+      temp[i].n_touched=0;
+      temp[i].touched_size=0;
+      temp[i].prev_vec=NULL;
+      temp[i].n_prev=0;
+      temp[i].prev_size=0;
+      temp[i].n_repeats=0;
    }
       /* expand the inst_counter on all allocated basic blocks */
    VG_(OSetGen_ResetIter)(instr_info_table);
@@ -498,6 +613,7 @@ static void bbv_thread_called ( ThreadId tid, ULong nDisp )
       allocated_threads=tid+1;
    }
    current_thread=tid;
+   cur_thread=&bbv_thread[tid];
 }
 
 
@@ -527,6 +643,8 @@ static Bool bbv_process_cmd_line_option(const HChar* arg)
       generate_pc_file = True;
    }
    else if VG_BOOL_CLO (arg, "--instr-count-only", instr_count_only) {}
+   else if VG_XACT_CLO (arg, "--bb-out-format=simpoint", compact_output, False) {}
+   else if VG_XACT_CLO (arg, "--bb-out-format=compact",  compact_output, True) {}
    else {
       return False;
    }
@@ -541,6 +659,7 @@ static void bbv_print_usage(void)
 "   --pc-out-file=<file>       filename for BB addresses and function names\n"
 "   --interval-size=<num>      interval size\n"
 "   --instr-count-only=yes|no  only print total instruction count\n"
+"   --bb-out-format=simpoint|compact  format of the BBV file [simpoint]\n"
    );
 }
 
@@ -584,6 +703,7 @@ static void bbv_fini(Int exitcode)
             bbv_thread[i].bbtrace_fp=open_tracefile(i);
          }
             /* Also print to results file */
+         flush_repeats(&bbv_thread[i]);
          VG_(fprintf)(bbv_thread[i].bbtrace_fp, "%s", buf);
          VG_(fclose)(bbv_thread[i].bbtrace_fp);
       }
@@ -615,6 +735,7 @@ static void bbv_pre_clo_init(void)
                                           VG_(malloc), "bbv.1", VG_(free));
 
    bbv_thread=allocate_new_thread(bbv_thread,0,allocated_threads);
+   cur_thread=&bbv_thread[current_thread];
 }
 
 VG_DETERMINE_INTERFACE_VERSION(bbv_pre_clo_init)
@@ -0,0 +1,414 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Replaying a memory trace through Cachegrind's cache          ---*/
+/*--- simulator.                                        mt_cgsim.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of exp-memtrace, a Valgrind tool for recording
+   memory access traces.
+
+   Copyright (C) 2002-2017 Nicholas Nethercote
+      njn@valgrind.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* Feeds a trace recorded by exp-memtrace through the cache simulator
+   Cachegrind uses, so that one recorded run can be simulated with any
+   number of cache configurations, and prints Cachegrind's summary
+   counts.  Threads are interleaved in the order their events happened
+   if the trace has timestamps, and simulated one after the other
+   otherwise. */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pub_tool_basics.h"
+#include "cg_arch.h"
+#include "mt_reader.h"
+
+/*------------------------------------------------------------*/
+/*--- What cg_sim.c needs from the core                    ---*/
+/*------------------------------------------------------------*/
+
+static Int VG_(log2)(UInt x)
+{
+   Int i;
+   /* Any more than 32 and we overflow anyway... */
+   for (i = 0; i < 32; i++) {
+      if ((1U << i) == x) return i;
+   }
+   return -1;
+}
+
+static void* VG_(malloc)(const HChar* cc, SizeT nbytes)
+{
+   void* p = malloc(nbytes);
+   if (p == NULL) {
+      fprintf(stderr, "mt_cgsim: out of memory (%s)\n", cc);
+      exit(1);
+   }
+   return p;
+}
+
+static UInt VG_(sprintf)(HChar* buf, const HChar* format, ...)
+{
+   va_list vargs;
+   Int     n;
+   va_start(vargs, format);
+   n = vsprintf(buf, format, vargs);
+   va_end(vargs);
+   return n;
+}
+
+static UInt VG_(printf)(const HChar* format, ...)
+{
+   va_list vargs;
+   Int     n;
+   va_start(vargs, format);
+   n = vfprintf(stderr, format, vargs);
+   va_end(vargs);
+   return n;
+}
+
+static void VG_(tool_panic)(const HChar* str)
+{
+   fprintf(stderr, "\nmt_cgsim: the 'impossible' happened:\n   %s\n", str);
+   exit(1);
+}
+
+#include "cg_sim.c"
+
+/*------------------------------------------------------------*/
+/*--- Command line                                         ---*/
+/*------------------------------------------------------------*/
+
+static cache_t clo_I1c = { 65536,  2, 64 };
+static cache_t clo_D1c = { 65536,  2, 64 };
+static cache_t clo_LLc = { 262144, 8, 64 };
+
+static const HChar* index_file = NULL;
+
+static void usage(void)
+{
+   fprintf(stderr,
+"usage: mt_cgsim [options] memtrace-out-file\n"
+"\n"
+"  options:\n"
+"    --I1=<size>,<assoc>,<line_size>  set I1 cache manually [65536,2,64]\n"
+"    --D1=<size>,<assoc>,<line_size>  set D1 cache manually [65536,2,64]\n"
+"    --LL=<size>,<assoc>,<line_size>  set LL cache manually [262144,8,64]\n"
+"    -h --help                        show this message\n"
+   );
+   exit(1);
+}
+
+/* The same checks as cg_arch.c makes */
+static const HChar* check_cache(const cache_t* cache)
+{
+   if (cache->size <= 0 || cache->assoc <= 0 || cache->line_size <= 0)
+      return "Cache parameters must be positive.";
+   if ((cache->size % (cache->line_size * cache->assoc) != 0) ||
+       (-1 == VG_(log2)(cache->size/cache->line_size/cache->assoc)))
+      return "Cache set count is not a power of two.";
+   if (-1 == VG_(log2)(cache->line_size))
+      return "Cache line size is not a power of two.";
+   if (cache->line_size < MIN_LINE_SIZE)
+      return "Cache line size is too small.";
+   if (cache->size <= cache->line_size)
+      return "Cache size <= line size.";
+   if (cache->assoc > (cache->size / cache->line_size))
+      return "Cache associativity > (size / line size).";
+   return NULL;
+}
+
+static Bool parse_cache_opt(const HChar* arg, const HChar* name,
+                            cache_t* cache)
+{
+   const HChar* res;
+   Int          n = strlen(name);
+   HChar        dummy;
+
+   if (strncmp(arg, name, n) != 0 || arg[n] != '=')
+      return False;
+   if (sscanf(arg + n + 1, "%d,%d,%d%c", &cache->size, &cache->assoc,
+              &cache->line_size, &dummy) != 3) {
+      fprintf(stderr, "mt_cgsim: bad argument '%s'\n", arg);
+      exit(1);
+   }
+   res = check_cache(cache);
+   if (res) {
+      fprintf(stderr, "mt_cgsim: bad argument '%s': %s\n", arg, res);
+      exit(1);
+   }
+   return True;
+}
+
+static void process_cmd_line(Int argc, HChar** argv)
+{
+   Int i;
+
+   for (i = 1; i < argc; i++) {
+      const HChar* arg = argv[i];
+
+      if (parse_cache_opt(arg, "--I1", &clo_I1c)) {}
+      else if (parse_cache_opt(arg, "--D1", &clo_D1c)) {}
+      else if (parse_cache_opt(arg, "--LL", &clo_LLc)) {}
+      else if (0 == strcmp(arg, "-h") || 0 == strcmp(arg, "--help"))
+         usage();
+      else if (arg[0] == '-' || index_file != NULL)
+         usage();
+      else
+         index_file = arg;
+   }
+   if (index_file == NULL)
+      usage();
+}
+
+/*------------------------------------------------------------*/
+/*--- Simulation                                           ---*/
+/*------------------------------------------------------------*/
+
+static mt_index idx;
+
+/* For each instruction, whether it fits in one cache line */
+static Bool* ip_is_NoX;
+
+static ULong Ir, I1m, ILm;
+static ULong Dr, D1mr, DLmr;
+static ULong Dw, D1mw, DLmw;
+
+static void simulate(const mt_event* ev)
+{
+   Addr  a;
+   UChar size;
+
+   switch (ev->kind) {
+      case MT_KIND_INSTR:
+         a    = idx.ips[ev->ip_id].addr;
+         size = idx.ips[ev->ip_id].len;
+         Ir++;
+         if (ip_is_NoX[ev->ip_id])
+            cachesim_I1_doref_NoX(a, size, &I1m, &ILm);
+         else
+            cachesim_I1_doref_Gen(a, size, &I1m, &ILm);
+         break;
+
+      case MT_KIND_LOAD:
+      case MT_KIND_MODIFY:
+         /* Cachegrind counts a modify as a read, as it can only miss
+            on the read. */
+         a    = ev->addr;
+         size = ev->size > MIN_LINE_SIZE ? MIN_LINE_SIZE : ev->size;
+         Dr++;
+         cachesim_D1_doref(a, size, &D1mr, &DLmr);
+         break;
+
+      case MT_KIND_STORE:
+         a    = ev->addr;
+         size = ev->size > MIN_LINE_SIZE ? MIN_LINE_SIZE : ev->size;
+         Dw++;
+         cachesim_D1_doref(a, size, &D1mw, &DLmw);
+         break;
+   }
+}
+
+static void bad_trace(const HChar* name)
+{
+   fprintf(stderr, "mt_cgsim: %s is truncated or corrupt\n", name);
+   exit(1);
+}
+
+static void bad_ip(const HChar* name)
+{
+   fprintf(stderr, "mt_cgsim: %s names an instruction not in the index\n",
+           name);
+   exit(1);
+}
+
+/* Simulate the traces of all the threads.  Without timestamps they are
+   simply run one after another.  With them, the thread whose next event
+   happened first goes next; there are few threads, so a linear search
+   for it is fine. */
+static void simulate_threads(void)
+{
+   mt_reader** readers = VG_(malloc)("readers", idx.n_threads
+                                                * sizeof(mt_reader*) + 1);
+   mt_event*   next    = VG_(malloc)("next", idx.n_threads
+                                             * sizeof(mt_event) + 1);
+   HChar**     names   = VG_(malloc)("names", idx.n_threads
+                                              * sizeof(HChar*) + 1);
+   Bool*       live    = VG_(malloc)("live", idx.n_threads
+                                             * sizeof(Bool) + 1);
+   Bool        merge   = (idx.flags & MT_FLAG_TIMESTAMPS) != 0;
+   UInt        i, best;
+   Int         res;
+
+   for (i = 0; i < idx.n_threads; i++) {
+      names[i] = VG_(malloc)("name", strlen(index_file) + 12);
+      sprintf(names[i], "%s.%u", index_file, idx.threads[i]);
+      readers[i] = mt_open_thread(names[i]);
+      if (readers[i] == NULL) {
+         fprintf(stderr, "mt_cgsim: cannot read trace file %s\n", names[i]);
+         exit(1);
+      }
+      live[i] = False;
+   }
+
+#  define ADVANCE(_i) \
+      do { res = mt_next(readers[_i], &next[_i]); \
+           if (res < 0) bad_trace(names[_i]); \
+           if (res > 0 && next[_i].ip_id >= idx.n_ips) bad_ip(names[_i]); \
+           live[_i] = res > 0; } while (0)
+
+   if (merge) {
+      for (i = 0; i < idx.n_threads; i++)
+         ADVANCE(i);
+      while (True) {
+         best = idx.n_threads;
+         for (i = 0; i < idx.n_threads; i++) {
+            if (live[i] && (best == idx.n_threads
+                            || next[i].ts < next[best].ts))
+               best = i;
+         }
+         if (best == idx.n_threads)
+            break;
+         simulate(&next[best]);
+         ADVANCE(best);
+      }
+   } else {
+      for (i = 0; i < idx.n_threads; i++) {
+         ADVANCE(i);
+         while (live[i]) {
+            simulate(&next[i]);
+            ADVANCE(i);
+         }
+      }
+   }
+
+#  undef ADVANCE
+
+   for (i = 0; i < idx.n_threads; i++) {
+      mt_close(readers[i]);
+      free(names[i]);
+   }
+   free(readers);
+   free(next);
+   free(names);
+   free(live);
+}
+
+/*------------------------------------------------------------*/
+/*--- Output                                               ---*/
+/*------------------------------------------------------------*/
+
+/* n with thousands separators, in a static buffer */
+static const HChar* commify(ULong n)
+{
+   static HChar buf[2][32];
+   static Int   which = 0;
+   HChar        tmp[32];
+   HChar*       out = buf[which ^= 1];
+   Int          len, i, j = 0;
+
+   len = sprintf(tmp, "%llu", n);
+   for (i = 0; i < len; i++) {
+      if (i > 0 && (len - i) % 3 == 0)
+         out[j++] = ',';
+      out[j++] = tmp[i];
+   }
+   out[j] = '\0';
+   return out;
+}
+
+static double pct(ULong n, ULong total)
+{
+   return total ? 100.0 * n / total : 0.0;
+}
+
+static void print_summary(void)
+{
+   ULong D   = Dr + Dw;
+   ULong D1m = D1mr + D1mw;
+   ULong DLm = DLmr + DLmw;
+
+   printf("I1 cache:         %s\n", I1.desc_line);
+   printf("D1 cache:         %s\n", D1.desc_line);
+   printf("LL cache:         %s\n", LL.desc_line);
+   printf("\n");
+
+   if (idx.flags & MT_FLAG_INSTRS) {
+      printf("I refs:        %s\n", commify(Ir));
+      printf("I1  misses:    %s\n", commify(I1m));
+      printf("LLi misses:    %s\n", commify(ILm));
+      printf("I1  miss rate: %.2f%%\n", pct(I1m, Ir));
+      printf("LLi miss rate: %.2f%%\n", pct(ILm, Ir));
+      printf("\n");
+   }
+
+   printf("D refs:        %s", commify(D));
+   printf("  (%s rd", commify(Dr));
+   printf(" + %s wr)\n", commify(Dw));
+   printf("D1  misses:    %s", commify(D1m));
+   printf("  (%s rd", commify(D1mr));
+   printf(" + %s wr)\n", commify(D1mw));
+   printf("LLd misses:    %s", commify(DLm));
+   printf("  (%s rd", commify(DLmr));
+   printf(" + %s wr)\n", commify(DLmw));
+   printf("D1  miss rate: %.1f%%\n", pct(D1m, D));
+   printf("LLd miss rate: %.1f%%\n", pct(DLm, D));
+   printf("\n");
+
+   printf("LL refs:       %s", commify(I1m + D1m));
+   printf("  (%s rd", commify(I1m + D1mr));
+   printf(" + %s wr)\n", commify(D1mw));
+   printf("LL misses:     %s", commify(ILm + DLm));
+   printf("  (%s rd", commify(ILm + DLmr));
+   printf(" + %s wr)\n", commify(DLmw));
+   printf("LL miss rate:  %.1f%%\n", pct(ILm + DLm, Ir + D));
+}
+
+int main(int argc, char** argv)
+{
+   UWord i;
+
+   process_cmd_line(argc, argv);
+
+   if (mt_read_index(index_file, &idx) != 0) {
+      fprintf(stderr, "mt_cgsim: cannot read index file %s\n", index_file);
+      exit(1);
+   }
+
+   cachesim_initcaches(clo_I1c, clo_D1c, clo_LLc);
+
+   ip_is_NoX = VG_(malloc)("ip_is_NoX", idx.n_ips * sizeof(Bool) + 1);
+   for (i = 0; i < idx.n_ips; i++)
+      ip_is_NoX[i] = cachesim_is_IrNoX(idx.ips[i].addr, idx.ips[i].len);
+
+   simulate_threads();
+   print_summary();
+
+   free(ip_is_NoX);
+   mt_free_index(&idx);
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*--- end                                               mt_cgsim.c ---*/
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,110 @@
+
+/*--------------------------------------------------------------------*/
+/*--- The exp-memtrace trace file format.             mt_format.h ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of exp-memtrace, a Valgrind tool for recording
+   memory access traces.
+
+   Copyright (C) 2002-2017 Nicholas Nethercote
+      njn@valgrind.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* This header is shared by the tool and by the trace reader, which is
+   built as an ordinary program, so it must not use any Valgrind types
+   or headers.
+
+   A run writes one index file, named by --memtrace-out-file, and one
+   trace file for each thread that accessed memory, with ".<n>"
+   appended to the index file name.  Threads are numbered 1, 2, 3 ...
+   in the order they first run.  Valgrind reuses the thread id of a
+   thread that has exited, but never its number, so each thread gets
+   a file of its own.  All numbers are unsigned LEB128:
+   seven bits per byte, least significant first, with the top bit set
+   on every byte but the last.  Signed differences are zigzag encoded
+   first, so that small negative numbers are small too.
+
+   Index file:
+      MT_INDEX_MAGIC                 8 bytes
+      version                        MT_VERSION
+      flags                          MT_FLAG_*
+      guest word size in bytes
+      number of instructions         n
+      n times:
+         address                     zigzag(address - previous address)
+         length in bytes
+      number of thread trace files   t
+      t times:
+         thread number
+
+   The instructions are given ids 0, 1, 2 ... in the order they are
+   listed.  The index is written at exit.
+
+   Thread trace file:
+      MT_THREAD_MAGIC                8 bytes
+      version                        MT_VERSION
+      flags                          MT_FLAG_*
+      thread number
+      thread id                      Valgrind's, as in its messages
+      events, each:
+         tag byte                    kind in bits 0-1, size in bits 2-7
+         size, if bits 2-7 are 0     (data accesses only)
+         instruction id              zigzag(id - previous id)
+         address                     zigzag(address - previous address)
+                                     (data accesses only)
+         timestamp                   timestamp - previous timestamp
+                                     (only if MT_FLAG_TIMESTAMPS)
+
+   Instruction events carry no size or address; both come from the
+   index.  "previous" means the previous event in the same file, and
+   starts off as zero.  Timestamps count events across all threads,
+   so the traces of different threads can be merged in the order the
+   events happened. */
+
+#ifndef __MT_FORMAT_H
+#define __MT_FORMAT_H
+
+#define MT_INDEX_MAGIC    "VGMTIDX\0"
+#define MT_THREAD_MAGIC   "VGMTTRD\0"
+#define MT_MAGIC_LEN      8
+
+#define MT_VERSION        1
+
+#define MT_FLAG_TIMESTAMPS  0x1   /* events carry timestamps */
+#define MT_FLAG_INSTRS      0x2   /* instruction events were recorded */
+
+/* Event kinds */
+#define MT_KIND_INSTR     0
+#define MT_KIND_LOAD      1
+#define MT_KIND_STORE     2
+#define MT_KIND_MODIFY    3       /* a load and store of the same data */
+
+#define MT_TAG_KIND_MASK  0x3
+#define MT_TAG_SIZE_SHIFT 2
+#define MT_TAG_MAX_SIZE   63      /* larger sizes are written separately */
+
+/* The most bytes one event can take: a tag byte and four numbers of up
+   to ten bytes each. */
+#define MT_MAX_EVENT_BYTES  41
+
+#endif   // __MT_FORMAT_H
+
+/*--------------------------------------------------------------------*/
+/*--- end                                             mt_format.h ---*/
+/*--------------------------------------------------------------------*/
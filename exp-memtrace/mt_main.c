@@ -0,0 +1,736 @@
+
+/*--------------------------------------------------------------------*/
+/*--- exp-memtrace: a memory access trace recorder.     mt_main.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of exp-memtrace, a Valgrind tool for recording
+   memory access traces.
+
+   Copyright (C) 2002-2017 Nicholas Nethercote
+      njn@valgrind.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+// This tool records every data access the client makes, and optionally
+// every instruction it executes, in compact binary trace files meant to
+// drive cache and prefetcher simulators.  The format is described in
+// mt_format.h; mt_reader.c reads it back.
+//
+// The instrumentation is the same as Lackey's --trace-mem, but each
+// event is encoded straight into a buffer belonging to the thread that
+// caused it, as differences from the thread's previous event, which are
+// mostly small.  A buffer is written to the thread's trace file with a
+// single write() when it fills up.  An event typically takes three or
+// four bytes.
+
+#include "pub_tool_basics.h"
+#include "pub_tool_tooliface.h"
+#include "pub_tool_hashtable.h"
+#include "pub_tool_libcassert.h"
+#include "pub_tool_libcbase.h"
+#include "pub_tool_libcfile.h"
+#include "pub_tool_libcprint.h"
+#include "pub_tool_libcproc.h"
+#include "pub_tool_machine.h"      // VG_(fnptr_to_fnentry)
+#include "pub_tool_mallocfree.h"
+#include "pub_tool_options.h"
+#include "pub_tool_threadstate.h"
+#include "pub_tool_vki.h"          // VKI_O_CREAT
+#include "pub_tool_xarray.h"
+
+#include "mt_format.h"
+
+/*------------------------------------------------------------*/
+/*--- Command line options                                 ---*/
+/*------------------------------------------------------------*/
+
+static const HChar* clo_memtrace_out_file = "memtrace.out.%p";
+static Bool         clo_trace_instrs      = False;
+static Bool         clo_timestamps        = False;
+
+static Bool mt_process_cmd_line_option(const HChar* arg)
+{
+   if VG_STR_CLO(arg, "--memtrace-out-file", clo_memtrace_out_file) {}
+   else if VG_BOOL_CLO(arg, "--trace-instrs", clo_trace_instrs) {}
+   else if VG_BOOL_CLO(arg, "--timestamps",   clo_timestamps) {}
+   else
+      return False;
+
+   return True;
+}
+
+static void mt_print_usage(void)
+{
+   VG_(printf)(
+"    --memtrace-out-file=<file>  index file name; the trace of thread n\n"
+"                                goes to <file>.<n> [memtrace.out.%%p]\n"
+"    --trace-instrs=no|yes       also record each instruction executed [no]\n"
+"    --timestamps=no|yes         record the global order of events [no]\n"
+   );
+}
+
+static void mt_print_debug_usage(void)
+{
+   VG_(printf)(
+"    (none)\n"
+   );
+}
+
+/*------------------------------------------------------------*/
+/*--- Instruction ids                                      ---*/
+/*------------------------------------------------------------*/
+
+/* Events name the instruction that caused them by a small id rather
+   than by its address.  The ids are given out at instrumentation time,
+   and the address and length for each are written to the index file at
+   exit. */
+
+typedef
+   struct _IPNode {
+      struct _IPNode* next;
+      Addr            addr;        /* key */
+      UWord           id;
+   }
+   IPNode;
+
+typedef
+   struct {
+      Addr addr;
+      UInt len;
+   }
+   IPInfo;
+
+static VgHashTable* ip_table = NULL;   /* IPNode, by address */
+static XArray*      ip_info  = NULL;   /* IPInfo, by id */
+
+static UWord get_ip_id(Addr addr, UInt len)
+{
+   IPNode* node = VG_(HT_lookup)(ip_table, addr);
+   IPInfo  info;
+
+   if (node) {
+      if (((IPInfo*)VG_(indexXA)(ip_info, node->id))->len == len)
+         return node->id;
+   } else {
+      node = VG_(malloc)("mt.ip.1", sizeof(IPNode));
+      node->addr = addr;
+      VG_(HT_add_node)(ip_table, node);
+   }
+
+   /* A new instruction, or different code at the address of an old
+      one: give it a new id. */
+   info.addr = addr;
+   info.len  = len;
+   node->id = VG_(addToXA)(ip_info, &info);
+   return node->id;
+}
+
+/*------------------------------------------------------------*/
+/*--- Trace buffers                                        ---*/
+/*------------------------------------------------------------*/
+
+#define TRACE_BUF_SIZE  (256 * 1024)
+
+typedef
+   struct {
+      UInt   num;        /* the thread number, which names the file */
+      Int    fd;
+      UChar* buf;
+      Int    used;
+      /* The previous event, which the next is encoded against */
+      UWord  last_ip;
+      Addr   last_addr;
+      ULong  last_ts;
+   }
+   ThreadTrace;
+
+/* The index file name, with %p and %q expanded */
+static HChar* out_file = NULL;
+
+static ThreadTrace** traces = NULL;    /* VG_N_THREADS entries */
+static ThreadTrace*  cur    = NULL;    /* the running thread's */
+
+/* Threads are numbered in the order they first run.  A thread id is
+   reused once its thread has exited, but a number never is. */
+static UInt n_threads = 0;
+
+/* Counts events across all threads */
+static ULong timestamp = 0;
+
+static ULong n_data_events  = 0;
+static ULong n_instr_events = 0;
+static ULong n_bytes        = 0;
+
+static UInt trace_flags(void)
+{
+   return (clo_timestamps   ? MT_FLAG_TIMESTAMPS : 0)
+        | (clo_trace_instrs ? MT_FLAG_INSTRS     : 0);
+}
+
+static inline UChar* put_uleb(UChar* p, ULong v)
+{
+   while (v >= 0x80) {
+      *p++ = (UChar)(v | 0x80);
+      v >>= 7;
+   }
+   *p++ = (UChar)v;
+   return p;
+}
+
+static inline ULong zigzag(Long v)
+{
+   return ((ULong)v << 1) ^ (ULong)(v >> 63);
+}
+
+static void write_all(Int fd, const UChar* buf, Int n, const HChar* name)
+{
+   while (n > 0) {
+      Int r = VG_(write)(fd, buf, n);
+      if (r <= 0) {
+         VG_(umsg)("Error: cannot write trace file %s\n", name);
+         VG_(exit)(1);
+      }
+      buf += r;
+      n   -= r;
+   }
+}
+
+static void flush_trace(ThreadTrace* t)
+{
+   write_all(t->fd, t->buf, t->used, out_file);
+   n_bytes += t->used;
+   t->used = 0;
+}
+
+static Int create_file(const HChar* name)
+{
+   SysRes sres = VG_(open)(name, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY,
+                           VKI_S_IRUSR|VKI_S_IWUSR);
+   if (sr_isError(sres)) {
+      VG_(umsg)("Error: cannot create trace file %s\n", name);
+      VG_(exit)(1);
+   }
+   return sr_Res(sres);
+}
+
+static ThreadTrace* get_trace(ThreadId tid)
+{
+   ThreadTrace* t = traces[tid];
+   HChar*       name;
+   UChar*       p;
+
+   if (t)
+      return t;
+
+   t = VG_(calloc)("mt.gt.2", 1, sizeof(ThreadTrace));
+   t->num = ++n_threads;
+
+   name = VG_(malloc)("mt.gt.1", VG_(strlen)(out_file) + 1 + 10 + 1);
+   VG_(sprintf)(name, "%s.%u", out_file, t->num);
+   t->fd  = create_file(name);
+   t->buf = VG_(malloc)("mt.gt.3", TRACE_BUF_SIZE);
+   VG_(free)(name);
+
+   VG_(memcpy)(t->buf, MT_THREAD_MAGIC, MT_MAGIC_LEN);
+   p = t->buf + MT_MAGIC_LEN;
+   p = put_uleb(p, MT_VERSION);
+   p = put_uleb(p, trace_flags());
+   p = put_uleb(p, t->num);
+   p = put_uleb(p, tid);
+   t->used = p - t->buf;
+
+   traces[tid] = t;
+   return t;
+}
+
+static void close_trace(ThreadId tid)
+{
+   ThreadTrace* t = traces[tid];
+
+   flush_trace(t);
+   VG_(close)(t->fd);
+   VG_(free)(t->buf);
+   VG_(free)(t);
+   traces[tid] = NULL;
+   if (cur == t)
+      cur = NULL;
+}
+
+static void mt_start_client_code(ThreadId tid, ULong blocks_dispatched)
+{
+   cur = get_trace(tid);
+}
+
+/* The thread's file is finished, and a new thread given its id will
+   start another. */
+static void mt_pre_thread_ll_exit(ThreadId tid)
+{
+   if (traces[tid])
+      close_trace(tid);
+}
+
+/* A forked child must not write the events its parent buffered, nor
+   into its parent's files.  It starts afresh, in files named after its
+   own pid.  The instruction ids stay valid, as the code is the same. */
+static void mt_atfork_child(ThreadId tid)
+{
+   const HChar* name = clo_memtrace_out_file;
+   HChar*       name_p = NULL;
+   Int          i;
+
+   for (i = 0; i < VG_N_THREADS; i++) {
+      if (traces[i]) {
+         VG_(close)(traces[i]->fd);
+         VG_(free)(traces[i]->buf);
+         VG_(free)(traces[i]);
+         traces[i] = NULL;
+      }
+   }
+   /* Without a %p, the child's files would be the parent's, which
+      creating them would truncate under the parent's feet. */
+   if (VG_(strstr)(name, "%p") == NULL) {
+      name_p = VG_(malloc)("mt.afc.1", VG_(strlen)(name) + 3 + 1);
+      VG_(sprintf)(name_p, "%s.%%p", name);
+      name = name_p;
+   }
+   VG_(free)(out_file);
+   out_file = VG_(expand_file_name)("--memtrace-out-file", name);
+   if (name_p) {
+      VG_(umsg)("Warning: --memtrace-out-file has no %%p; the trace of "
+                "this forked child goes to %s\n", out_file);
+      VG_(free)(name_p);
+   }
+   n_data_events = n_instr_events = n_bytes = 0;
+   n_threads = 0;
+   cur = get_trace(tid);
+}
+
+/*------------------------------------------------------------*/
+/*--- Helpers called from the instrumented code            ---*/
+/*------------------------------------------------------------*/
+
+/* kind_size is MT_KIND_* | size << MT_TAG_SIZE_SHIFT */
+static VG_REGPARM(3) void trace_data(Addr addr, UWord ip_id, UWord kind_size)
+{
+   ThreadTrace* t    = cur;
+   UWord        size = kind_size >> MT_TAG_SIZE_SHIFT;
+   UChar*       p;
+
+   if (UNLIKELY(t->used > TRACE_BUF_SIZE - MT_MAX_EVENT_BYTES))
+      flush_trace(t);
+   p = t->buf + t->used;
+
+   if (size <= MT_TAG_MAX_SIZE) {
+      *p++ = (UChar)kind_size;
+   } else {
+      *p++ = (UChar)(kind_size & MT_TAG_KIND_MASK);
+      p = put_uleb(p, size);
+   }
+   p = put_uleb(p, zigzag((Long)ip_id - (Long)t->last_ip));
+   p = put_uleb(p, zigzag((Long)((ULong)addr - (ULong)t->last_addr)));
+   t->last_ip   = ip_id;
+   t->last_addr = addr;
+
+   if (clo_timestamps) {
+      p = put_uleb(p, timestamp - t->last_ts);
+      t->last_ts = timestamp;
+   }
+   timestamp++;
+   n_data_events++;
+
+   t->used = p - t->buf;
+}
+
+static VG_REGPARM(1) void trace_instr(UWord ip_id)
+{
+   ThreadTrace* t = cur;
+   UChar*       p;
+
+   if (UNLIKELY(t->used > TRACE_BUF_SIZE - MT_MAX_EVENT_BYTES))
+      flush_trace(t);
+   p = t->buf + t->used;
+
+   *p++ = MT_KIND_INSTR;
+   p = put_uleb(p, zigzag((Long)ip_id - (Long)t->last_ip));
+   t->last_ip = ip_id;
+
+   if (clo_timestamps) {
+      p = put_uleb(p, timestamp - t->last_ts);
+      t->last_ts = timestamp;
+   }
+   timestamp++;
+   n_instr_events++;
+
+   t->used = p - t->buf;
+}
+
+/*------------------------------------------------------------*/
+/*--- Instrumentation                                      ---*/
+/*------------------------------------------------------------*/
+
+/* As in Lackey, events are queued up as the superblock is scanned, so
+   that a load followed by a store of the same data can be recorded as
+   a single modify, and are turned into helper calls before each exit
+   and whenever the queue is full. */
+
+typedef
+   IRExpr
+   IRAtom;
+
+#define MAX_DSIZE    512
+
+typedef
+   struct {
+      IRAtom* addr;     /* NULL for an instruction event */
+      UInt    kind;     /* MT_KIND_* */
+      Int     size;
+      UWord   ip_id;
+      IRAtom* guard;    /* :: Ity_I1, or NULL=="always True" */
+   }
+   Event;
+
+#define N_EVENTS 4
+
+static Event events[N_EVENTS];
+static Int   events_used = 0;
+
+static void flushEvents(IRSB* sb)
+{
+   Int      i;
+   IRDirty* di;
+   Event*   ev;
+
+   for (i = 0; i < events_used; i++) {
+      ev = &events[i];
+
+      if (ev->kind == MT_KIND_INSTR) {
+         di = unsafeIRDirty_0_N( 1, "trace_instr",
+                                 VG_(fnptr_to_fnentry)( trace_instr ),
+                                 mkIRExprVec_1( mkIRExpr_HWord(ev->ip_id) ) );
+      } else {
+         UWord kind_size = ev->kind | (ev->size << MT_TAG_SIZE_SHIFT);
+         di = unsafeIRDirty_0_N( 3, "trace_data",
+                                 VG_(fnptr_to_fnentry)( trace_data ),
+                                 mkIRExprVec_3( ev->addr,
+                                                mkIRExpr_HWord(ev->ip_id),
+                                                mkIRExpr_HWord(kind_size) ) );
+      }
+      if (ev->guard)
+         di->guard = ev->guard;
+      addStmtToIRSB( sb, IRStmt_Dirty(di) );
+   }
+
+   events_used = 0;
+}
+
+static void addEvent ( IRSB* sb, UInt kind, IRAtom* daddr, Int dsize,
+                       UWord ip_id, IRAtom* guard )
+{
+   Event* evt;
+   if (events_used == N_EVENTS)
+      flushEvents(sb);
+   tl_assert(events_used >= 0 && events_used < N_EVENTS);
+   evt = &events[events_used];
+   evt->kind  = kind;
+   evt->addr  = daddr;
+   evt->size  = dsize;
+   evt->ip_id = ip_id;
+   evt->guard = guard;
+   events_used++;
+}
+
+static void addEvent_Dr ( IRSB* sb, IRAtom* daddr, Int dsize, UWord ip_id,
+                          IRAtom* guard )
+{
+   tl_assert(isIRAtom(daddr));
+   tl_assert(dsize >= 1 && dsize <= MAX_DSIZE);
+   addEvent(sb, MT_KIND_LOAD, daddr, dsize, ip_id, guard);
+}
+
+/* Merge an unguarded write with an immediately preceding unguarded
+   read of the same size at the same address, into a modify. */
+static void addEvent_Dw ( IRSB* sb, IRAtom* daddr, Int dsize, UWord ip_id,
+                          IRAtom* guard )
+{
+   Event* lastEvt = &events[events_used-1];
+
+   tl_assert(isIRAtom(daddr));
+   tl_assert(dsize >= 1 && dsize <= MAX_DSIZE);
+
+   if (events_used > 0
+       && guard == NULL
+       && lastEvt->kind  == MT_KIND_LOAD
+       && lastEvt->size  == dsize
+       && lastEvt->guard == NULL
+       && eqIRAtom(lastEvt->addr, daddr))
+   {
+      lastEvt->kind = MT_KIND_MODIFY;
+      return;
+   }
+   addEvent(sb, MT_KIND_STORE, daddr, dsize, ip_id, guard);
+}
+
+static
+IRSB* mt_instrument ( VgCallbackClosure* closure,
+                      IRSB* sbIn,
+                      const VexGuestLayout* layout,
+                      const VexGuestExtents* vge,
+                      const VexArchInfo* archinfo_host,
+                      IRType gWordTy, IRType hWordTy )
+{
+   Int        i;
+   IRSB*      sbOut;
+   IRTypeEnv* tyenv = sbIn->tyenv;
+   UWord      ip_id = 0;
+
+   if (gWordTy != hWordTy) {
+      /* We don't currently support this case. */
+      VG_(tool_panic)("host/guest word size mismatch");
+   }
+
+   sbOut = deepCopyIRSBExceptStmts(sbIn);
+
+   // Copy verbatim any IR preamble preceding the first IMark
+   i = 0;
+   while (i < sbIn->stmts_used && sbIn->stmts[i]->tag != Ist_IMark) {
+      addStmtToIRSB( sbOut, sbIn->stmts[i] );
+      i++;
+   }
+
+   events_used = 0;
+
+   for (/*use current i*/; i < sbIn->stmts_used; i++) {
+      IRStmt* st = sbIn->stmts[i];
+      if (!st || st->tag == Ist_NoOp) continue;
+
+      switch (st->tag) {
+         case Ist_NoOp:
+         case Ist_AbiHint:
+         case Ist_Put:
+         case Ist_PutI:
+         case Ist_MBE:
+            break;
+
+         case Ist_IMark:
+            ip_id = get_ip_id(st->Ist.IMark.addr, st->Ist.IMark.len);
+            if (clo_trace_instrs)
+               addEvent(sbOut, MT_KIND_INSTR, NULL, 0, ip_id, NULL);
+            break;
+
+         case Ist_WrTmp: {
+            IRExpr* data = st->Ist.WrTmp.data;
+            if (data->tag == Iex_Load) {
+               addEvent_Dr( sbOut, data->Iex.Load.addr,
+                            sizeofIRType(data->Iex.Load.ty), ip_id, NULL );
+            }
+            break;
+         }
+
+         case Ist_Store: {
+            IRType type = typeOfIRExpr(tyenv, st->Ist.Store.data);
+            tl_assert(type != Ity_INVALID);
+            addEvent_Dw( sbOut, st->Ist.Store.addr,
+                         sizeofIRType(type), ip_id, NULL );
+            break;
+         }
+
+         case Ist_StoreG: {
+            IRStoreG* sg   = st->Ist.StoreG.details;
+            IRType    type = typeOfIRExpr(tyenv, sg->data);
+            tl_assert(type != Ity_INVALID);
+            addEvent_Dw( sbOut, sg->addr, sizeofIRType(type), ip_id,
+                         sg->guard );
+            break;
+         }
+
+         case Ist_LoadG: {
+            IRLoadG* lg       = st->Ist.LoadG.details;
+            IRType   type     = Ity_INVALID; /* loaded type */
+            IRType   typeWide = Ity_INVALID; /* after implicit widening */
+            typeOfIRLoadGOp(lg->cvt, &typeWide, &type);
+            tl_assert(type != Ity_INVALID);
+            addEvent_Dr( sbOut, lg->addr, sizeofIRType(type), ip_id,
+                         lg->guard );
+            break;
+         }
+
+         case Ist_Dirty: {
+            IRDirty* d = st->Ist.Dirty.details;
+            if (d->mFx != Ifx_None) {
+               // This dirty helper accesses memory.  Collect the details.
+               tl_assert(d->mAddr != NULL);
+               tl_assert(d->mSize != 0);
+               if (d->mFx == Ifx_Read || d->mFx == Ifx_Modify)
+                  addEvent_Dr( sbOut, d->mAddr, d->mSize, ip_id, NULL );
+               if (d->mFx == Ifx_Write || d->mFx == Ifx_Modify)
+                  addEvent_Dw( sbOut, d->mAddr, d->mSize, ip_id, NULL );
+            } else {
+               tl_assert(d->mAddr == NULL);
+               tl_assert(d->mSize == 0);
+            }
+            break;
+         }
+
+         case Ist_CAS: {
+            /* Treated as a read and a write of the location, which
+               become a single modify. */
+            IRCAS* cas = st->Ist.CAS.details;
+            Int    dataSize;
+            tl_assert(cas->addr != NULL);
+            tl_assert(cas->dataLo != NULL);
+            dataSize = sizeofIRType(typeOfIRExpr(tyenv, cas->dataLo));
+            if (cas->dataHi != NULL)
+               dataSize *= 2; /* since it's a doubleword-CAS */
+            addEvent_Dr( sbOut, cas->addr, dataSize, ip_id, NULL );
+            addEvent_Dw( sbOut, cas->addr, dataSize, ip_id, NULL );
+            break;
+         }
+
+         case Ist_LLSC: {
+            IRType dataTy;
+            if (st->Ist.LLSC.storedata == NULL) {
+               /* LL */
+               dataTy = typeOfIRTemp(tyenv, st->Ist.LLSC.result);
+               addEvent_Dr( sbOut, st->Ist.LLSC.addr,
+                            sizeofIRType(dataTy), ip_id, NULL );
+               /* flush events before LL, helps SC to succeed */
+               flushEvents(sbOut);
+            } else {
+               /* SC */
+               dataTy = typeOfIRExpr(tyenv, st->Ist.LLSC.storedata);
+               addEvent_Dw( sbOut, st->Ist.LLSC.addr,
+                            sizeofIRType(dataTy), ip_id, NULL );
+            }
+            break;
+         }
+
+         case Ist_Exit:
+            flushEvents(sbOut);
+            break;
+
+         default:
+            ppIRStmt(st);
+            tl_assert(0);
+      }
+
+      addStmtToIRSB( sbOut, st );
+   }
+
+   /* At the end of the sbIn.  Flush outstandings. */
+   flushEvents(sbOut);
+
+   return sbOut;
+}
+
+/*------------------------------------------------------------*/
+/*--- Basic tool functions                                 ---*/
+/*------------------------------------------------------------*/
+
+static void mt_post_clo_init(void)
+{
+   out_file = VG_(expand_file_name)("--memtrace-out-file",
+                                    clo_memtrace_out_file);
+   traces = VG_(calloc)("mt.pci.1", VG_N_THREADS, sizeof(ThreadTrace*));
+}
+
+static void write_index(void)
+{
+   Word   n_ips = VG_(sizeXA)(ip_info);
+   Int    fd, i;
+   UChar* buf;
+   UChar* p;
+   Addr   last_addr = 0;
+
+   /* Each number takes at most ten bytes */
+   buf = VG_(malloc)("mt.wi.1", MT_MAGIC_LEN + 10 * (5 + 2*n_ips + n_threads));
+   VG_(memcpy)(buf, MT_INDEX_MAGIC, MT_MAGIC_LEN);
+   p = buf + MT_MAGIC_LEN;
+   p = put_uleb(p, MT_VERSION);
+   p = put_uleb(p, trace_flags());
+   p = put_uleb(p, sizeof(Addr));
+   p = put_uleb(p, n_ips);
+   for (i = 0; i < n_ips; i++) {
+      const IPInfo* info = VG_(indexXA)(ip_info, i);
+      p = put_uleb(p, zigzag((Long)((ULong)info->addr - (ULong)last_addr)));
+      p = put_uleb(p, info->len);
+      last_addr = info->addr;
+   }
+   p = put_uleb(p, n_threads);
+   for (i = 1; i <= n_threads; i++)
+      p = put_uleb(p, i);
+
+   fd = create_file(out_file);
+   write_all(fd, buf, p - buf, out_file);
+   n_bytes += p - buf;
+   VG_(close)(fd);
+   VG_(free)(buf);
+}
+
+static void mt_fini(Int exitcode)
+{
+   Int i;
+
+   for (i = 0; i < VG_N_THREADS; i++) {
+      if (traces[i])
+         close_trace(i);
+   }
+   write_index();
+
+   if (VG_(clo_verbosity) == 0)
+      return;
+
+   VG_(umsg)("Data accesses: %'llu\n", n_data_events);
+   if (clo_trace_instrs)
+      VG_(umsg)("Instructions:  %'llu\n", n_instr_events);
+   VG_(umsg)("Threads:       %u\n", n_threads);
+   VG_(umsg)("Trace bytes:   %'llu (%.2f per event)\n",
+             n_bytes,
+             (Double)n_bytes / (n_data_events + n_instr_events
+                                ? n_data_events + n_instr_events : 1));
+}
+
+static void mt_pre_clo_init(void)
+{
+   VG_(details_name)            ("exp-memtrace");
+   VG_(details_version)         (NULL);
+   VG_(details_description)     ("a memory access trace recorder");
+   VG_(details_copyright_author)(
+      "Copyright (C) 2002-2017, and GNU GPL'd, by Nicholas Nethercote.");
+   VG_(details_bug_reports_to)  (VG_BUGS_TO);
+   VG_(details_avg_translation_sizeB) ( 275 );
+
+   VG_(basic_tool_funcs)          (mt_post_clo_init,
+                                   mt_instrument,
+                                   mt_fini);
+   VG_(needs_command_line_options)(mt_process_cmd_line_option,
+                                   mt_print_usage,
+                                   mt_print_debug_usage);
+
+   VG_(track_start_client_code)   (mt_start_client_code);
+   VG_(track_pre_thread_ll_exit)  (mt_pre_thread_ll_exit);
+   VG_(atfork)                    (NULL, NULL, mt_atfork_child);
+
+   ip_table = VG_(HT_construct)("mt.ips");
+   ip_info  = VG_(newXA)(VG_(malloc), "mt.ipi", VG_(free), sizeof(IPInfo));
+}
+
+VG_DETERMINE_INTERFACE_VERSION(mt_pre_clo_init)
+
+/*--------------------------------------------------------------------*/
+/*--- end                                               mt_main.c ---*/
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,303 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Reading exp-memtrace trace files.                mt_reader.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of exp-memtrace, a Valgrind tool for recording
+   memory access traces.
+
+   Copyright (C) 2002-2017 Nicholas Nethercote
+      njn@valgrind.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mt_reader.h"
+
+#define READ_BUF_SIZE  (256 * 1024)
+
+struct _mt_reader {
+   FILE*         f;
+   unsigned char buf[READ_BUF_SIZE];
+   size_t        pos;
+   size_t        end;
+   int           eof;
+   uint32_t      num;
+   uint32_t      tid;
+   uint32_t      flags;
+   /* The previous event, which the next is decoded against */
+   uint64_t      last_ip;
+   uint64_t      last_addr;
+   uint64_t      last_ts;
+};
+
+/* Decode a number from p, which must not run past end.  Returns the
+   byte after it, or NULL if it does not fit or is too long. */
+static const unsigned char* get_uleb(const unsigned char* p,
+                                     const unsigned char* end,
+                                     uint64_t* v)
+{
+   uint64_t res   = 0;
+   int      shift = 0;
+
+   while (p < end && shift < 64) {
+      unsigned char b = *p++;
+      res |= (uint64_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+         *v = res;
+         return p;
+      }
+      shift += 7;
+   }
+   return NULL;
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+   return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/*------------------------------------------------------------*/
+/*--- The index file                                       ---*/
+/*------------------------------------------------------------*/
+
+int mt_read_index(const char* path, mt_index* idx)
+{
+   FILE*                f;
+   unsigned char*       buf = NULL;
+   const unsigned char* p;
+   const unsigned char* end;
+   long                 n;
+   uint64_t             v, i, addr = 0;
+
+   memset(idx, 0, sizeof(*idx));
+
+   f = fopen(path, "rb");
+   if (f == NULL)
+      return -1;
+   if (fseek(f, 0, SEEK_END) != 0 || (n = ftell(f)) < 0
+       || fseek(f, 0, SEEK_SET) != 0)
+      goto bad;
+   buf = malloc(n ? n : 1);
+   if (buf == NULL || fread(buf, 1, n, f) != (size_t)n)
+      goto bad;
+   p   = buf;
+   end = buf + n;
+
+#  define GET(_v) do { p = get_uleb(p, end, &(_v)); \
+                       if (p == NULL) goto bad; } while (0)
+
+   if (n < MT_MAGIC_LEN || memcmp(p, MT_INDEX_MAGIC, MT_MAGIC_LEN) != 0)
+      goto bad;
+   p += MT_MAGIC_LEN;
+   GET(v);
+   if (v != MT_VERSION)
+      goto bad;
+   GET(v); idx->flags     = v;
+   GET(v); idx->word_size = v;
+
+   GET(idx->n_ips);
+   /* Each instruction takes at least two bytes */
+   if (idx->n_ips > (uint64_t)(end - p) / 2)
+      goto bad;
+   idx->ips = malloc(idx->n_ips * sizeof(mt_ip) + 1);
+   if (idx->ips == NULL)
+      goto bad;
+   for (i = 0; i < idx->n_ips; i++) {
+      GET(v);
+      addr += unzigzag(v);
+      idx->ips[i].addr = addr;
+      GET(v);
+      idx->ips[i].len = v;
+   }
+
+   GET(v);
+   if (v > (uint64_t)(end - p))
+      goto bad;
+   idx->n_threads = v;
+   idx->threads = malloc(idx->n_threads * sizeof(uint32_t) + 1);
+   if (idx->threads == NULL)
+      goto bad;
+   for (i = 0; i < idx->n_threads; i++) {
+      GET(v);
+      idx->threads[i] = v;
+   }
+
+#  undef GET
+
+   free(buf);
+   fclose(f);
+   return 0;
+
+  bad:
+   free(buf);
+   fclose(f);
+   mt_free_index(idx);
+   return -1;
+}
+
+void mt_free_index(mt_index* idx)
+{
+   free(idx->ips);
+   free(idx->threads);
+   memset(idx, 0, sizeof(*idx));
+}
+
+/*------------------------------------------------------------*/
+/*--- Thread trace files                                   ---*/
+/*------------------------------------------------------------*/
+
+/* Make sure that at least MT_MAX_EVENT_BYTES are buffered, unless the
+   file ends first. */
+static void fill(mt_reader* r)
+{
+   size_t n;
+
+   if (r->eof || r->end - r->pos >= MT_MAX_EVENT_BYTES)
+      return;
+   memmove(r->buf, r->buf + r->pos, r->end - r->pos);
+   r->end -= r->pos;
+   r->pos  = 0;
+   while (!r->eof && r->end < READ_BUF_SIZE) {
+      n = fread(r->buf + r->end, 1, READ_BUF_SIZE - r->end, r->f);
+      if (n == 0)
+         r->eof = 1;
+      r->end += n;
+   }
+}
+
+mt_reader* mt_open_thread(const char* path)
+{
+   mt_reader*           r;
+   const unsigned char* p;
+   const unsigned char* end;
+   uint64_t             v;
+
+   r = calloc(1, sizeof(mt_reader));
+   if (r == NULL)
+      return NULL;
+   r->f = fopen(path, "rb");
+   if (r->f == NULL) {
+      free(r);
+      return NULL;
+   }
+   fill(r);
+
+   p   = r->buf;
+   end = r->buf + r->end;
+   if (r->end < MT_MAGIC_LEN
+       || memcmp(p, MT_THREAD_MAGIC, MT_MAGIC_LEN) != 0)
+      goto bad;
+   p += MT_MAGIC_LEN;
+   if ((p = get_uleb(p, end, &v)) == NULL || v != MT_VERSION)
+      goto bad;
+   if ((p = get_uleb(p, end, &v)) == NULL)
+      goto bad;
+   r->flags = v;
+   if ((p = get_uleb(p, end, &v)) == NULL)
+      goto bad;
+   r->num = v;
+   if ((p = get_uleb(p, end, &v)) == NULL)
+      goto bad;
+   r->tid = v;
+
+   r->pos = p - r->buf;
+   return r;
+
+  bad:
+   mt_close(r);
+   return NULL;
+}
+
+uint32_t mt_thread_num(const mt_reader* r)
+{
+   return r->num;
+}
+
+uint32_t mt_thread_id(const mt_reader* r)
+{
+   return r->tid;
+}
+
+uint32_t mt_thread_flags(const mt_reader* r)
+{
+   return r->flags;
+}
+
+int mt_next(mt_reader* r, mt_event* ev)
+{
+   const unsigned char* p;
+   const unsigned char* end;
+   uint64_t             v;
+   unsigned char        tag;
+
+   fill(r);
+   if (r->pos == r->end)
+      return 0;
+
+   p   = r->buf + r->pos;
+   end = r->buf + r->end;
+
+   tag = *p++;
+   ev->kind = tag & MT_TAG_KIND_MASK;
+   ev->size = tag >> MT_TAG_SIZE_SHIFT;
+
+   if (ev->kind != MT_KIND_INSTR && ev->size == 0) {
+      if ((p = get_uleb(p, end, &v)) == NULL)
+         return -1;
+      ev->size = v;
+   }
+
+   if ((p = get_uleb(p, end, &v)) == NULL)
+      return -1;
+   r->last_ip += unzigzag(v);
+   ev->ip_id = r->last_ip;
+
+   if (ev->kind != MT_KIND_INSTR) {
+      if ((p = get_uleb(p, end, &v)) == NULL)
+         return -1;
+      r->last_addr += unzigzag(v);
+      ev->addr = r->last_addr;
+   } else {
+      ev->addr = 0;
+   }
+
+   if (r->flags & MT_FLAG_TIMESTAMPS) {
+      if ((p = get_uleb(p, end, &v)) == NULL)
+         return -1;
+      r->last_ts += v;
+   }
+   ev->ts = r->last_ts;
+
+   r->pos = p - r->buf;
+   return 1;
+}
+
+void mt_close(mt_reader* r)
+{
+   if (r->f)
+      fclose(r->f);
+   free(r);
+}
+
+/*--------------------------------------------------------------------*/
+/*--- end                                             mt_reader.c ---*/
+/*--------------------------------------------------------------------*/
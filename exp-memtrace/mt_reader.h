@@ -0,0 +1,102 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Reading exp-memtrace trace files.                mt_reader.h ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of exp-memtrace, a Valgrind tool for recording
+   memory access traces.
+
+   Copyright (C) 2002-2017 Nicholas Nethercote
+      njn@valgrind.org
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/* A small library for programs that consume the traces written by
+   exp-memtrace.  It is plain C, with no Valgrind dependencies, so it
+   can be copied into a simulator's source tree as it is, together
+   with mt_format.h.
+
+   Typical use:
+
+      mt_index  idx;
+      mt_reader* r;
+      mt_event  ev;
+
+      mt_read_index("memtrace.out.1234", &idx);
+      r = mt_open_thread("memtrace.out.1234.1");
+      while (mt_next(r, &ev) > 0)
+         ... idx.ips[ev.ip_id].addr is the instruction ...
+      mt_close(r);
+      mt_free_index(&idx);
+*/
+
+#ifndef __MT_READER_H
+#define __MT_READER_H
+
+#include <stdint.h>
+
+#include "mt_format.h"
+
+typedef struct {
+   uint64_t addr;
+   uint32_t len;
+} mt_ip;
+
+typedef struct {
+   uint32_t  flags;        /* MT_FLAG_* */
+   uint32_t  word_size;    /* of the traced program, in bytes */
+   uint64_t  n_ips;
+   mt_ip*    ips;          /* indexed by instruction id */
+   uint32_t  n_threads;
+   uint32_t* threads;      /* the numbers of the thread trace files */
+} mt_index;
+
+typedef struct {
+   uint32_t kind;          /* MT_KIND_* */
+   uint32_t size;          /* bytes accessed; 0 for instructions */
+   uint64_t ip_id;         /* the instruction that caused the event */
+   uint64_t addr;          /* data address; 0 for instructions */
+   uint64_t ts;            /* 0 unless MT_FLAG_TIMESTAMPS */
+} mt_event;
+
+typedef struct _mt_reader mt_reader;
+
+/* Read the index file at path.  Returns 0 on success, -1 if the file
+   cannot be read or is not an index file. */
+extern int mt_read_index(const char* path, mt_index* idx);
+extern void mt_free_index(mt_index* idx);
+
+/* Open the trace file of one thread.  Returns NULL if the file cannot
+   be opened or is not a thread trace file. */
+extern mt_reader* mt_open_thread(const char* path);
+
+extern uint32_t mt_thread_num(const mt_reader* r);
+extern uint32_t mt_thread_id(const mt_reader* r);
+extern uint32_t mt_thread_flags(const mt_reader* r);
+
+/* Decode the next event into *ev.  Returns 1 if there was one, 0 at
+   the end of the trace, and -1 if the trace is truncated or corrupt. */
+extern int mt_next(mt_reader* r, mt_event* ev);
+
+extern void mt_close(mt_reader* r);
+
+#endif   // __MT_READER_H
+
+/*--------------------------------------------------------------------*/
+/*--- end                                             mt_reader.h ---*/
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,49 @@
+/* Makes a fixed sequence of loads and stores to a buffer, in the main
+   thread and in two more threads run one after the other.  Valgrind
+   gives the second the id of the first, but each must get a trace file
+   of its own.  The buffer's address is written to memtrace.out.buf,
+   for read_range to pick out the accesses to it. */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static uint32_t buf[8];
+
+static void touch(int k)
+{
+   uint32_t x;
+
+   x = ((volatile uint32_t*)buf)[0];
+   ((volatile uint32_t*)buf)[7] = x;
+   x = ((volatile uint8_t*)buf)[k];
+   ((volatile uint16_t*)buf)[1] = x;
+   ((volatile uint8_t*)buf)[31 - k] = x;
+}
+
+static void* thread(void* arg)
+{
+   touch((int)(long)arg);
+   return NULL;
+}
+
+int main(void)
+{
+   FILE* f = fopen("memtrace.out.buf", "w");
+   pthread_t t;
+
+   if (f == NULL) {
+      perror("accesses: memtrace.out.buf");
+      return 1;
+   }
+   fprintf(f, "%p\n", (void*)buf);
+   fclose(f);
+
+   touch(0);
+   pthread_create(&t, NULL, thread, (void*)1L);
+   pthread_join(t, NULL);
+   pthread_create(&t, NULL, thread, (void*)2L);
+   pthread_join(t, NULL);
+   touch(3);
+   return 0;
+}
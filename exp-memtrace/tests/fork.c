@@ -0,0 +1,32 @@
+/* Forks, and makes accesses before, in and after the child, so that
+   the child's trace files are created while the parent is still
+   writing its own. */
+
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static volatile char buf[4096];
+
+static void touch(int n)
+{
+   int i, j;
+   for (j = 0; j < n; j++)
+      for (i = 0; i < (int)sizeof buf; i++)
+         buf[i]++;
+}
+
+int main(void)
+{
+   pid_t pid;
+
+   touch(10);
+   pid = fork();
+   if (pid == 0) {
+      touch(1);
+      exit(0);
+   }
+   waitpid(pid, NULL, 0);
+   touch(10);
+   return 0;
+}
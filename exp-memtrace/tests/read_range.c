@@ -0,0 +1,86 @@
+/* Reads back the trace of the accesses test, and prints the accesses
+   each thread made to the test's buffer, with their exact sizes and
+   offsets.  Any event the reader decodes wrongly puts all the events
+   after it out of step, so this checks the whole trace.  It also
+   checks that every event names a known instruction and that the
+   timestamps only go up. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The reader is plain C; build it in. */
+#include "../mt_reader.c"
+
+#define BUF_SIZE 32
+
+static const char* kind_name(uint32_t kind)
+{
+   switch (kind) {
+      case MT_KIND_LOAD:   return "load";
+      case MT_KIND_STORE:  return "store";
+      case MT_KIND_MODIFY: return "modify";
+      default:             return "?";
+   }
+}
+
+int main(int argc, char** argv)
+{
+   mt_index   idx;
+   mt_reader* r;
+   mt_event   ev;
+   char       name[1000];
+   FILE*      f;
+   void*      p;
+   uint64_t   buf, last_ts;
+   uint32_t   i;
+   int        res;
+
+   if (argc != 2) {
+      fprintf(stderr, "usage: read_range <index file>\n");
+      return 1;
+   }
+   snprintf(name, sizeof name, "%s.buf", argv[1]);
+   f = fopen(name, "r");
+   if (f == NULL || fscanf(f, "%p", &p) != 1) {
+      fprintf(stderr, "read_range: cannot read %s\n", name);
+      return 1;
+   }
+   fclose(f);
+   buf = (uint64_t)(uintptr_t)p;
+
+   if (mt_read_index(argv[1], &idx) != 0) {
+      fprintf(stderr, "read_range: cannot read index %s\n", argv[1]);
+      return 1;
+   }
+   printf("threads: %u\n", idx.n_threads);
+
+   for (i = 0; i < idx.n_threads; i++) {
+      snprintf(name, sizeof name, "%s.%u", argv[1], idx.threads[i]);
+      r = mt_open_thread(name);
+      if (r == NULL) {
+         fprintf(stderr, "read_range: cannot read %s\n", name);
+         return 1;
+      }
+      printf("thread %u, tid %u\n", mt_thread_num(r), mt_thread_id(r));
+      last_ts = 0;
+      while ((res = mt_next(r, &ev)) > 0) {
+         if (ev.ip_id >= idx.n_ips)
+            printf("   unknown instruction %llu\n",
+                   (unsigned long long)ev.ip_id);
+         if (ev.ts < last_ts)
+            printf("   timestamp %llu after %llu\n",
+                   (unsigned long long)ev.ts, (unsigned long long)last_ts);
+         last_ts = ev.ts;
+         if (ev.kind != MT_KIND_INSTR
+             && ev.addr >= buf && ev.addr < buf + BUF_SIZE)
+            printf("   %-6s %u at %llu\n", kind_name(ev.kind), ev.size,
+                   (unsigned long long)(ev.addr - buf));
+      }
+      if (res < 0)
+         printf("   corrupt trace\n");
+      mt_close(r);
+   }
+   mt_free_index(&idx);
+   return 0;
+}
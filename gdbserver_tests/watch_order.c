@@ -0,0 +1,52 @@
+/* Writes to a buffer on which send_rsp has put overlapping and adjacent
+   write watchpoints, then forks with them still set.  The child must
+   start without any watchpoint, and the parent must keep all of them.
+
+   The addresses are written to watch_order.syms; the program then waits
+   for send_rsp to set the watchpoints and to set go. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static char buf[16] __attribute__((aligned(16)));
+static volatile int go;
+
+int main(void)
+{
+   FILE* f;
+   pid_t pid;
+   int   status;
+
+   f = fopen("watch_order.syms.tmp", "w");
+   if (f == NULL) {
+      perror("watch_order.syms.tmp");
+      return 1;
+   }
+   fprintf(f, "buf %p\ngo %p\n", (void*)buf, (void*)&go);
+   fclose(f);
+   rename("watch_order.syms.tmp", "watch_order.syms");
+
+   while (!go)
+      ;
+
+   *(volatile uint64_t*)buf = 1;        /* [0, 8) and [4, 8) */
+   buf[12] = 1;                         /* just after [8, 12) */
+   buf[11] = 1;                         /* [8, 12) */
+
+   pid = fork();
+   if (pid == 0) {
+      memset(buf, 2, sizeof buf);
+      exit(0);
+   }
+   waitpid(pid, &status, 0);
+   printf("child exited with %d\n",
+          WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+   fflush(stdout);
+
+   *(volatile uint32_t*)(buf + 4) = 1;  /* [0, 8) and [4, 8) */
+   return 0;
+}
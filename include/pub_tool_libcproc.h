@@ -81,6 +81,16 @@ extern Int VG_(setrlimit) ( Int resource, const struct vki_rlimit *rlim );
 extern Int VG_(prctl) (Int option, 
                        ULong arg2, ULong arg3, ULong arg4, ULong arg5);
 
+/* ---------------------------------------------------------------------
+   Memory residency
+   ------------------------------------------------------------------ */
+
+/* Sets the bottom bit of vec[i] if page i of [start, start+length) is
+   resident in memory, and clears it otherwise.  vec must have room for
+   one byte per page; start must be page aligned.  Returns 0 on success,
+   and -1 if the range is not mapped or the platform cannot tell. */
+extern Int VG_(mincore) ( Addr start, SizeT length, UChar* vec );
+
 /* ---------------------------------------------------------------------
    pids, etc
    ------------------------------------------------------------------ */
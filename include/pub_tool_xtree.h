@@ -183,6 +183,22 @@ extern void VG_(XT_callgrind_print)
       const HChar* (*img_value) (const void* value));
 
 
+/* -------------------- BINARY OUTPUT FORMAT --------------*/
+/* Prints xt in outfilename in a compact binary format, described in
+   m_xtree.c.  Such files are quicker to produce than the text formats,
+   and can be merged and converted to the callgrind or massif format
+   with valgrind-xtree-merge.
+   events is as for VG_(XT_callgrind_print).
+   report_value must return the value of the event number ev (counting
+   from 0 in events) for value.  Stacks for which all events have a
+   0 value are not printed. */
+extern void VG_(XT_binary_print)
+     (XTree* xt,
+      const HChar* outfilename,
+      const HChar* events,
+      ULong (*report_value)(const void* value, UInt ev));
+
+
 /* -------------------- MASSIF OUTPUT FORMAT --------------*/
 // Time is measured either in i or ms or bytes, depending on the --time-unit
 // option.  It's a Long because it can exceed 32-bits reasonably easily, and
@@ -3198,6 +3198,65 @@ struct vki_perf_event_attr {
 #define VKI_PERF_EVENT_IOC_ID           _VKI_IOR('$', 7, __vki_u64 *)
 #define VKI_PERF_EVENT_IOC_SET_BPF      _VKI_IOW('$', 8, __vki_u32)
 
+#define VKI_PERF_FLAG_FD_CLOEXEC        (1UL << 3)
+
+enum vki_perf_type_id {
+	VKI_PERF_TYPE_HARDWARE			= 0,
+	VKI_PERF_TYPE_SOFTWARE			= 1,
+};
+
+enum vki_perf_hw_id {
+	VKI_PERF_COUNT_HW_CPU_CYCLES		= 0,
+	VKI_PERF_COUNT_HW_INSTRUCTIONS		= 1,
+	VKI_PERF_COUNT_HW_CACHE_REFERENCES	= 2,
+	VKI_PERF_COUNT_HW_CACHE_MISSES		= 3,
+	VKI_PERF_COUNT_HW_BRANCH_INSTRUCTIONS	= 4,
+	VKI_PERF_COUNT_HW_BRANCH_MISSES		= 5,
+};
+
+enum vki_perf_sw_ids {
+	VKI_PERF_COUNT_SW_CPU_CLOCK		= 0,
+	VKI_PERF_COUNT_SW_TASK_CLOCK		= 1,
+};
+
+enum vki_perf_event_sample_format {
+	VKI_PERF_SAMPLE_IP			= 1U << 0,
+	VKI_PERF_SAMPLE_TID			= 1U << 1,
+};
+
+struct vki_perf_event_header {
+	__vki_u32	type;
+	__vki_u16	misc;
+	__vki_u16	size;
+};
+
+enum vki_perf_event_type {
+	VKI_PERF_RECORD_LOST			= 2,
+	VKI_PERF_RECORD_SAMPLE			= 9,
+};
+
+/* The first page of the ring buffer mapped from a perf event fd.  Only
+   data_head and data_tail are used by Valgrind. */
+struct vki_perf_event_mmap_page {
+	__vki_u32	version;
+	__vki_u32	compat_version;
+	__vki_u32	lock;
+	__vki_u32	index;
+	__vki_s64	offset;
+	__vki_u64	time_enabled;
+	__vki_u64	time_running;
+	__vki_u64	capabilities;
+	__vki_u16	pmc_width;
+	__vki_u16	time_shift;
+	__vki_u32	time_mult;
+	__vki_u64	time_offset;
+	__vki_u64	time_zero;
+	__vki_u32	size;
+	__vki_u8	__reserved[118*8+4];
+	__vki_u64	data_head;	/* head in the data section */
+	__vki_u64	data_tail;	/* user-space written tail */
+};
+
 /*--------------------------------------------------------------------*/
 // From linux-2.6.32.4/include/linux/getcpu.h
 /*--------------------------------------------------------------------*/
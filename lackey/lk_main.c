@@ -134,6 +134,11 @@
 // wide range of purposes.  For example, Cachegrind shares all the above
 // shortcomings and it is still useful.
 //
+// The events are not printed as they happen.  Each is appended, in binary
+// form, to a buffer which is only formatted and printed when it fills up,
+// before each system call the client makes, and at exit.  Formatting a
+// whole buffer at a time is much cheaper than a VG_(printf) call per event.
+//
 // For further inspiration, you should look at cachegrind/cg_main.c which
 // uses the same basic technique for tracing memory accesses, but also groups
 // events together for processing into twos and threes so that fewer C calls
@@ -241,59 +246,88 @@ static ULong n_Jccs_untaken  = 0;
 static ULong n_IJccs         = 0;
 static ULong n_IJccs_untaken = 0;
 
-static void add_one_func_call(void)
-{
-   n_func_calls++;
-}
+/* The counters are updated by inline IR rather than by calling a helper
+   function for each event.  Within a superblock, the updates to each
+   counter are added up as the superblock is instrumented, and a single
+   update is done for each counter before each exit from the superblock,
+   so that the counts are right whichever exit is taken.  If an
+   instruction faults part way through a superblock, though, the counts
+   for the instructions before it in that superblock are lost. */
+
+#if defined(VG_BIGENDIAN)
+# define END Iend_BE
+#elif defined(VG_LITTLEENDIAN)
+# define END Iend_LE
+#else
+# error "Unknown endianness"
+#endif
 
-static void add_one_SB_entered(void)
-{
-   n_SBs_entered++;
-}
-
-static void add_one_SB_completed(void)
-{
-   n_SBs_completed++;
-}
+typedef
+   IRExpr 
+   IRAtom;
 
-static void add_one_IRStmt(void)
+/* Add code to add 'n' (an Ity_I64 atom) to '*counter', like this:
+     WrTmp(t1, Load64(counter))
+     WrTmp(t2, Add64(RdTmp(t1), n))
+     Store(counter, t2) */
+static void add_counter_update(IRSB* sb, ULong* counter, IRAtom* n)
 {
-   n_IRStmts++;
+   IRTemp  t1   = newIRTemp(sb->tyenv, Ity_I64);
+   IRTemp  t2   = newIRTemp(sb->tyenv, Ity_I64);
+   IRExpr* addr = mkIRExpr_HWord( (HWord)counter );
+
+   addStmtToIRSB( sb, IRStmt_WrTmp(t1, IRExpr_Load(END, Ity_I64, addr)) );
+   addStmtToIRSB( sb, IRStmt_WrTmp(t2, IRExpr_Binop(Iop_Add64,
+                                                    IRExpr_RdTmp(t1), n)) );
+   addStmtToIRSB( sb, IRStmt_Store(END, addr, IRExpr_RdTmp(t2)) );
 }
 
-static void add_one_guest_instr(void)
-{
-   n_guest_instrs++;
-}
+/* The counter updates not yet done for the superblock being
+   instrumented.  There is one entry per counter, so this only needs to
+   hold all the counters there are. */
+#define N_PENDING 64
 
-static void add_one_Jcc(void)
-{
-   n_Jccs++;
-}
+typedef
+   struct {
+      ULong* counter;
+      ULong  n;
+   }
+   PendingCount;
 
-static void add_one_Jcc_untaken(void)
-{
-   n_Jccs_untaken++;
-}
+static PendingCount pending[N_PENDING];
+static Int          pending_used = 0;
 
-static void add_one_inverted_Jcc(void)
+static void add_pending(ULong* counter, ULong n)
 {
-   n_IJccs++;
+   Int i;
+   for (i = 0; i < pending_used; i++) {
+      if (pending[i].counter == counter) {
+         pending[i].n += n;
+         return;
+      }
+   }
+   tl_assert(pending_used < N_PENDING);
+   pending[pending_used].counter = counter;
+   pending[pending_used].n       = n;
+   pending_used++;
 }
 
-static void add_one_inverted_Jcc_untaken(void)
+/* Do the pending counter updates.  Must be called before any possible
+   exit from the superblock. */
+static void flush_pending(IRSB* sb)
 {
-   n_IJccs_untaken++;
+   Int i;
+   for (i = 0; i < pending_used; i++) {
+      add_counter_update( sb, pending[i].counter,
+                          IRExpr_Const(IRConst_U64(pending[i].n)) );
+   }
+   pending_used = 0;
 }
 
 /*------------------------------------------------------------*/
 /*--- Stuff for --detailed-counts                          ---*/
 /*------------------------------------------------------------*/
 
-typedef
-   IRExpr 
-   IRAtom;
-
 /* --- Operations --- */
 
 typedef enum { OpLoad=0, OpStore=1, OpAlu=2 } Op;
@@ -352,31 +386,28 @@ static const HChar* nameOfTypeIndex ( Int i )
 
 static ULong detailCounts[N_OPS][N_TYPES];
 
-/* The helper that is called from the instrumented code. */
-static VG_REGPARM(1)
-void increment_detail(ULong* detail)
-{
-   (*detail)++;
-}
-
 /* A helper that adds the instrumentation for a detail.  guard ::
    Ity_I1 is the guarding condition for the event.  If NULL it is
-   assumed to mean "always True". */
+   assumed to mean "always True".  Guarded events are counted straight
+   away, by adding the guard to the counter; the others are added to
+   the superblock's pending counts. */
 static void instrument_detail(IRSB* sb, Op op, IRType type, IRAtom* guard)
 {
-   IRDirty* di;
-   IRExpr** argv;
    const UInt typeIx = type2index(type);
 
    tl_assert(op < N_OPS);
    tl_assert(typeIx < N_TYPES);
 
-   argv = mkIRExprVec_1( mkIRExpr_HWord( (HWord)&detailCounts[op][typeIx] ) );
-   di = unsafeIRDirty_0_N( 1, "increment_detail",
-                              VG_(fnptr_to_fnentry)( &increment_detail ), 
-                              argv);
-   if (guard) di->guard = guard;
-   addStmtToIRSB( sb, IRStmt_Dirty(di) );
+   if (guard) {
+      IRTemp one = newIRTemp(sb->tyenv, Ity_I64);
+      addStmtToIRSB( sb, IRStmt_WrTmp(one,
+                            IRExpr_ITE( guard,
+                                        IRExpr_Const(IRConst_U64(1)),
+                                        IRExpr_Const(IRConst_U64(0)) )) );
+      add_counter_update( sb, &detailCounts[op][typeIx], IRExpr_RdTmp(one) );
+   } else {
+      add_pending( &detailCounts[op][typeIx], 1 );
+   }
 }
 
 /* Summarize and print the details. */
@@ -451,25 +482,114 @@ typedef
 static Event events[N_EVENTS];
 static Int   events_used = 0;
 
+/* The trace buffer.  Events are recorded here by the helpers below, and
+   printed by flush_trace().  Only one thread runs at a time, so a single
+   buffer keeps the events of all threads in the order they happened. */
+typedef
+   enum { Trace_I, Trace_L, Trace_S, Trace_M, Trace_SB }
+   TraceKind;
+
+typedef
+   struct {
+      Addr  addr;
+      UInt  size;
+      UInt  kind;    /* a TraceKind */
+   }
+   TraceEvent;
+
+#define N_TRACE_EVENTS 8192
+
+static TraceEvent trace_buf[N_TRACE_EVENTS];
+static Int        trace_used = 0;
+
+/* Write 'a' in hex, with at least eight digits, as "%08lx" would. */
+static HChar* put_hex(HChar* p, Addr a)
+{
+   static const HChar digits[] = "0123456789abcdef";
+   Int n = 8;
+   while (n < 2*sizeof(Addr) && (a >> (4*n)) != 0)
+      n++;
+   while (n-- > 0)
+      *p++ = digits[(a >> (4*n)) & 0xf];
+   return p;
+}
+
+/* Write 'u' in decimal. */
+static HChar* put_dec(HChar* p, UInt u)
+{
+   HChar tmp[10];
+   Int   n = 0;
+   do {
+      tmp[n++] = '0' + u % 10;
+      u /= 10;
+   } while (u != 0);
+   while (n > 0)
+      *p++ = tmp[--n];
+   return p;
+}
+
+static void flush_trace(void)
+{
+   /* Events are formatted into text[], which is printed whenever it
+      might not have room for one more. */
+   static const HChar* prefix[] = { "I  ", " L ", " S ", " M ", "SB " };
+   HChar  text[16384];
+   HChar* p = text;
+   Int    i;
+
+   for (i = 0; i < trace_used; i++) {
+      const TraceEvent* ev = &trace_buf[i];
+      if (p + 64 > text + sizeof(text)) {
+         *p = 0;
+         VG_(printf)("%s", text);
+         p = text;
+      }
+      tl_assert(ev->kind <= Trace_SB);
+      VG_(strcpy)(p, prefix[ev->kind]);
+      p = put_hex(p + 3, ev->addr);
+      if (ev->kind != Trace_SB) {
+         *p++ = ',';
+         p = put_dec(p, ev->size);
+      }
+      *p++ = '\n';
+   }
+   if (p > text) {
+      *p = 0;
+      VG_(printf)("%s", text);
+   }
+
+   trace_used = 0;
+}
+
+static inline void add_trace_event(Addr addr, UInt size, TraceKind kind)
+{
+   TraceEvent* ev;
+   if (UNLIKELY(trace_used == N_TRACE_EVENTS))
+      flush_trace();
+   ev = &trace_buf[trace_used++];
+   ev->addr = addr;
+   ev->size = size;
+   ev->kind = kind;
+}
 
 static VG_REGPARM(2) void trace_instr(Addr addr, SizeT size)
 {
-   VG_(printf)("I  %08lx,%lu\n", addr, size);
+   add_trace_event(addr, size, Trace_I);
 }
 
 static VG_REGPARM(2) void trace_load(Addr addr, SizeT size)
 {
-   VG_(printf)(" L %08lx,%lu\n", addr, size);
+   add_trace_event(addr, size, Trace_L);
 }
 
 static VG_REGPARM(2) void trace_store(Addr addr, SizeT size)
 {
-   VG_(printf)(" S %08lx,%lu\n", addr, size);
+   add_trace_event(addr, size, Trace_S);
 }
 
 static VG_REGPARM(2) void trace_modify(Addr addr, SizeT size)
 {
-   VG_(printf)(" M %08lx,%lu\n", addr, size);
+   add_trace_event(addr, size, Trace_M);
 }
 
 
@@ -628,7 +748,21 @@ void addEvent_Dw ( IRSB* sb, IRAtom* daddr, Int dsize )
 
 static void trace_superblock(Addr addr)
 {
-   VG_(printf)("SB %08lx\n", addr);
+   add_trace_event(addr, 0, Trace_SB);
+}
+
+/* Print the buffered trace before the client does anything the trace
+   would otherwise appear out of order with, eg. writing its own output
+   or forking. */
+static void lk_pre_syscall(ThreadId tid, UInt syscallno,
+                           UWord* args, UInt nArgs)
+{
+   flush_trace();
+}
+
+static void lk_post_syscall(ThreadId tid, UInt syscallno,
+                            UWord* args, UInt nArgs, SysRes res)
+{
 }
 
 
@@ -679,12 +813,11 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
       i++;
    }
 
+   pending_used = 0;
+
    if (clo_basic_counts) {
       /* Count this superblock. */
-      di = unsafeIRDirty_0_N( 0, "add_one_SB_entered", 
-                                 VG_(fnptr_to_fnentry)( &add_one_SB_entered ),
-                                 mkIRExprVec_0() );
-      addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+      add_pending( &n_SBs_entered, 1 );
    }
 
    if (clo_trace_sbs) {
@@ -707,10 +840,7 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
 
       if (clo_basic_counts) {
          /* Count one VEX statement. */
-         di = unsafeIRDirty_0_N( 0, "add_one_IRStmt", 
-                                    VG_(fnptr_to_fnentry)( &add_one_IRStmt ), 
-                                    mkIRExprVec_0() );
-         addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+         add_pending( &n_IRStmts, 1 );
       }
       
       switch (st->tag) {
@@ -729,10 +859,7 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
                ilen  = st->Ist.IMark.len;
 
                /* Count guest instruction. */
-               di = unsafeIRDirty_0_N( 0, "add_one_guest_instr",
-                                          VG_(fnptr_to_fnentry)( &add_one_guest_instr ), 
-                                          mkIRExprVec_0() );
-               addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+               add_pending( &n_guest_instrs, 1 );
 
                /* An unconditional branch to a known destination in the
                 * guest's instructions can be represented, in the IRSB to
@@ -752,11 +879,7 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
                if (VG_(get_fnname_if_entry)(ep, st->Ist.IMark.addr,
                                             &fnname)
                    && 0 == VG_(strcmp)(fnname, clo_fnname)) {
-                  di = unsafeIRDirty_0_N( 
-                          0, "add_one_func_call", 
-                             VG_(fnptr_to_fnentry)( &add_one_func_call ), 
-                             mkIRExprVec_0() );
-                  addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+                  add_pending( &n_func_calls, 1 );
                }
             }
             if (clo_trace_mem) {
@@ -938,37 +1061,23 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
 
                /* Count Jcc */
                if (!condition_inverted)
-                  di = unsafeIRDirty_0_N( 0, "add_one_Jcc", 
-                                          VG_(fnptr_to_fnentry)( &add_one_Jcc ), 
-                                          mkIRExprVec_0() );
+                  add_pending( &n_Jccs, 1 );
                else
-                  di = unsafeIRDirty_0_N( 0, "add_one_inverted_Jcc",
-                                          VG_(fnptr_to_fnentry)(
-                                             &add_one_inverted_Jcc ),
-                                          mkIRExprVec_0() );
-
-               addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+                  add_pending( &n_IJccs, 1 );
             }
             if (clo_trace_mem) {
                flushEvents(sbOut);
             }
+            flush_pending(sbOut);
 
             addStmtToIRSB( sbOut, st );      // Original statement
 
             if (clo_basic_counts) {
                /* Count non-taken Jcc */
                if (!condition_inverted)
-                  di = unsafeIRDirty_0_N( 0, "add_one_Jcc_untaken", 
-                                          VG_(fnptr_to_fnentry)(
-                                             &add_one_Jcc_untaken ),
-                                          mkIRExprVec_0() );
+                  add_pending( &n_Jccs_untaken, 1 );
                else
-                  di = unsafeIRDirty_0_N( 0, "add_one_inverted_Jcc_untaken",
-                                          VG_(fnptr_to_fnentry)(
-                                             &add_one_inverted_Jcc_untaken ),
-                                          mkIRExprVec_0() );
-
-               addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+                  add_pending( &n_IJccs_untaken, 1 );
             }
             break;
 
@@ -980,16 +1089,14 @@ IRSB* lk_instrument ( VgCallbackClosure* closure,
 
    if (clo_basic_counts) {
       /* Count this basic block. */
-      di = unsafeIRDirty_0_N( 0, "add_one_SB_completed", 
-                                 VG_(fnptr_to_fnentry)( &add_one_SB_completed ),
-                                 mkIRExprVec_0() );
-      addStmtToIRSB( sbOut, IRStmt_Dirty(di) );
+      add_pending( &n_SBs_completed, 1 );
    }
 
    if (clo_trace_mem) {
       /* At the end of the sbIn.  Flush outstandings. */
       flushEvents(sbOut);
    }
+   flush_pending(sbOut);
 
    return sbOut;
 }
@@ -999,6 +1106,8 @@ static void lk_fini(Int exitcode)
    tl_assert(clo_fnname);
    tl_assert(clo_fnname[0]);
 
+   flush_trace();
+
    if (clo_basic_counts) {
       ULong total_Jccs = n_Jccs + n_IJccs;
       ULong taken_Jccs = (n_Jccs - n_Jccs_untaken) + n_IJccs_untaken;
@@ -1059,6 +1168,8 @@ static void lk_pre_clo_init(void)
    VG_(needs_command_line_options)(lk_process_cmd_line_option,
                                    lk_print_usage,
                                    lk_print_debug_usage);
+   VG_(needs_syscall_wrapper)     (lk_pre_syscall,
+                                   lk_post_syscall);
 }
 
 VG_DETERMINE_INTERFACE_VERSION(lk_pre_clo_init)
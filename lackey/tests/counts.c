@@ -0,0 +1,24 @@
+/* A loop whose conditional branch goes one way on even iterations and
+   the other way on odd ones.  The number of iterations is given on the
+   command line. */
+
+#include <stdlib.h>
+
+static volatile long sink;
+
+__attribute__((noinline)) static void body(long i)
+{
+   if (i & 1)
+      sink += i;
+   else
+      sink -= 1;
+}
+
+int main(int argc, char **argv)
+{
+   long i, n = argc > 1 ? atol(argv[1]) : 0;
+
+   for (i = 0; i < n; i++)
+      body(i);
+   return 0;
+}
@@ -0,0 +1,42 @@
+/* Writes to stdout around a fork, with calls to marker functions in
+   between, so that the filter can check that the trace, written to the
+   same file, stays in order with the program's own output. */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+__attribute__((noinline)) static void mark_a(void) { __asm__ __volatile__(""); }
+__attribute__((noinline)) static void mark_b(void) { __asm__ __volatile__(""); }
+__attribute__((noinline)) static void mark_c(void) { __asm__ __volatile__(""); }
+
+static void say(const char *s)
+{
+   if (write(1, s, strlen(s)) != (ssize_t)strlen(s))
+      _exit(1);
+}
+
+int main(void)
+{
+   char buf[100];
+   pid_t pid;
+
+   snprintf(buf, sizeof buf, "marks %lx %lx %lx\n",
+            (unsigned long)mark_a, (unsigned long)mark_b,
+            (unsigned long)mark_c);
+   say(buf);
+
+   mark_a();
+   say("before fork\n");
+   mark_b();
+   pid = fork();
+   if (pid == 0) {
+      say("child\n");
+      _exit(0);
+   }
+   waitpid(pid, NULL, 0);
+   mark_c();
+   say("after wait\n");
+   return 0;
+}
@@ -162,6 +162,7 @@ Number of snapshots: 50
 #include "pub_tool_mallocfree.h"
 #include "pub_tool_options.h"
 #include "pub_tool_poolalloc.h"
+#include "pub_tool_rangemap.h"
 #include "pub_tool_replacemalloc.h"
 #include "pub_tool_stacktrace.h"
 #include "pub_tool_threadstate.h"
@@ -364,6 +365,7 @@ static Bool   clo_heap            = True;
    // word-sized type -- it ended up with a value of 4.2 billion.  Sigh.
 static SSizeT clo_heap_admin      = 8;
 static Bool   clo_pages_as_heap   = False;
+static Bool   clo_pages_resident  = False;
 static Bool   clo_stacks          = False;
 static Int    clo_depth           = 30;
 static double clo_threshold       = 1.0;  // percentage
@@ -388,6 +390,7 @@ static Bool ms_process_cmd_line_option(const HChar* arg)
    else if VG_BOOL_CLO(arg, "--stacks",         clo_stacks) {}
 
    else if VG_BOOL_CLO(arg, "--pages-as-heap",  clo_pages_as_heap) {}
+   else if VG_BOOL_CLO(arg, "--pages-resident", clo_pages_resident) {}
 
    else if VG_BINT_CLO(arg, "--depth",          clo_depth, 1, MAX_DEPTH) {}
 
@@ -431,6 +434,8 @@ static void ms_print_usage(void)
 "                               ignored if --heap=no [8]\n"
 "    --stacks=no|yes           profile stack(s) [no]\n"
 "    --pages-as-heap=no|yes    profile memory at the page level [no]\n"
+"    --pages-resident=no|yes   with --pages-as-heap=yes, count only the pages\n"
+"                              that are resident in memory [no]\n"
 "    --depth=<number>          depth of contexts [30]\n"
 "    --alloc-fn=<name>         specify <name> as an alloc function [empty]\n"
 "    --ignore-fn=<name>        ignore heap allocations within <name> [empty]\n"
@@ -970,6 +975,8 @@ take_snapshot(Snapshot* snapshot, SnapshotKind kind, Time my_time,
 }
 
 
+static void sample_resident_pages(void);
+
 // Take a snapshot, if it's time, or if we've hit a peak.
 static void
 maybe_take_snapshot(SnapshotKind kind, const HChar* what)
@@ -1022,6 +1029,15 @@ maybe_take_snapshot(SnapshotKind kind, const HChar* what)
       tl_assert2(0, "maybe_take_snapshot: unrecognised snapshot kind");
    }
 
+   // With --pages-resident=yes the heap size is only brought up to date
+   // now, which may show that this is not a peak after all.
+   if (clo_pages_resident) {
+      sample_resident_pages();
+      if (Peak == kind &&
+          heap_szB + heap_extra_szB + stacks_szB <= peak_snapshot_total_szB)
+         return;
+   }
+
    // Take the snapshot.
    snapshot = & snapshots[next_snapshot_i];
    take_snapshot(snapshot, kind, my_time, is_detailed);
@@ -1478,38 +1494,161 @@ static SizeT ms_malloc_usable_size ( ThreadId tid, void* p )
 //--- Page handling                                        ---//
 //------------------------------------------------------------//
 
+// The mapped pages are not kept as heap blocks in malloc_list.  page_map
+// maps each address to the Xecu that mapped it plus one, or to zero if
+// it is not mapped.  So a mapping costs one stack trace however many
+// pages it has, and adjacent mappings made from the same place merge
+// into a single range.
+static RangeMap* page_map = NULL;
+
+// With --pages-resident=yes, a mapping adds nothing to the heap when it
+// is made.  Instead, just before each snapshot, mincore tells which pages
+// are resident, and the heap is updated to match.  This records, for each
+// Xecu, how much of the heap it currently accounts for.
+static XArray* page_resident_szB = NULL;   // of SizeT, indexed by Xecu
+
+static SizeT* resident_szB_of(Xecu where)
+{
+   while (VG_(sizeXA)(page_resident_szB) <= where) {
+      SizeT zero = 0;
+      VG_(addToXA)(page_resident_szB, &zero);
+   }
+   return VG_(indexXA)(page_resident_szB, where);
+}
+
+// Take the pages in [a, a+len) off the heap, and out of page_map.
 static
-void ms_record_page_mem ( Addr a, SizeT len )
+void ms_unrecord_page_mem( Addr a, SizeT len, Bool maybe_snapshot )
 {
-   ThreadId tid = VG_(get_running_tid)();
-   Addr end;
+   Addr  last = a + len - 1;
+   Addr  lo, hi, range_min;
+   UWord val;
+   SizeT szB;
+   Bool  freed = False;
+
    tl_assert(VG_IS_PAGE_ALIGNED(len));
    tl_assert(len >= VKI_PAGE_SIZE);
-   // Record the first N-1 pages as blocks, but don't do any snapshots.
-   for (end = a + len - VKI_PAGE_SIZE; a < end; a += VKI_PAGE_SIZE) {
-      record_block( tid, (void*)a, VKI_PAGE_SIZE, /*slop_szB*/0,
-                    /*exclude_first_entry*/False, /*maybe_snapshot*/False );
+
+   for (lo = a; ; lo = hi + 1) {
+      VG_(lookupRangeMap)(&range_min, &hi, &val, page_map, lo);
+      if (hi > last)
+         hi = last;
+      szB = hi - lo + 1;
+
+      if (val != 0) {
+         Xecu where = val - 1;
+         if (VG_(XT_n_ips_sel)(heap_xt, where) > 0) {
+            // This might be the peak, so do a snapshot first.
+            if (maybe_snapshot && !freed)
+               maybe_take_snapshot(Peak, "de-PEAK");
+            freed = True;
+            n_heap_frees++;
+
+            if (clo_pages_resident) {
+               // We don't know which of these pages were resident, so
+               // take off as much as we can; the next sample corrects it.
+               SizeT* resident_szB = resident_szB_of(where);
+               if (szB > *resident_szB)
+                  szB = *resident_szB;
+               *resident_szB -= szB;
+               update_heap_stats(-szB, 0);
+               if (szB > 0)
+                  VG_(XT_sub_from_xecu)(heap_xt, where, &szB);
+            } else {
+               update_heap_stats(-szB, 0);
+               sub_heap_xt(where, szB, /*exclude_first_entry*/False);
+            }
+         } else {
+            n_ignored_heap_frees++;
+         }
+      }
+
+      if (hi == last)
+         break;
    }
-   // Record the last page as a block, and maybe do a snapshot afterwards.
-   record_block( tid, (void*)a, VKI_PAGE_SIZE, /*slop_szB*/0,
-                 /*exclude_first_entry*/False, /*maybe_snapshot*/True );
+
+   VG_(bindRangeMap)(page_map, a, last, 0);
+
+   if (maybe_snapshot && freed)
+      maybe_take_snapshot(Normal, "dealloc");
 }
 
 static
-void ms_unrecord_page_mem( Addr a, SizeT len )
+void ms_record_page_mem ( Addr a, SizeT len )
 {
-   Addr end;
+   ThreadId tid = VG_(get_running_tid)();
+   Xecu     where;
+
    tl_assert(VG_IS_PAGE_ALIGNED(len));
    tl_assert(len >= VKI_PAGE_SIZE);
-   // Unrecord the first page. This might be the peak, so do a snapshot.
-   unrecord_block((void*)a, /*maybe_snapshot*/True,
-                  /*exclude_first_entry*/False);
-   a += VKI_PAGE_SIZE;
-   // Then unrecord the remaining pages, but without snapshots.
-   for (end = a + len - VKI_PAGE_SIZE; a < end; a += VKI_PAGE_SIZE) {
-      unrecord_block((void*)a, /*maybe_snapshot*/False,
-                     /*exclude_first_entry*/False);
+
+   // The new mapping may replace pages that were already mapped.
+   ms_unrecord_page_mem(a, len, /*maybe_snapshot*/False);
+
+   if (clo_pages_resident) {
+      SizeT zero = 0;
+      where = VG_(XT_add_to_ec)(heap_xt, make_ec(tid, False), &zero);
+      resident_szB_of(where);
+   } else {
+      where = add_heap_xt(tid, len, /*exclude_first_entry*/False);
+   }
+   VG_(bindRangeMap)(page_map, a, a + len - 1, where + 1);
+
+   if (VG_(XT_n_ips_sel)(heap_xt, where) > 0) {
+      n_heap_allocs++;
+      if (!clo_pages_resident)
+         update_heap_stats(len, 0);
+      maybe_take_snapshot(Normal, "  alloc");
+   } else {
+      n_ignored_heap_allocs++;
+   }
+}
+
+// Bring the heap up to date with the pages now resident.
+static void sample_resident_pages(void)
+{
+   static UChar vec[4096];   // one byte per page
+   Word   i, j, n_pages;
+   Addr   lo, hi, a;
+   UWord  val;
+   Xecu   where;
+   Xecu   n_xecus = VG_(sizeXA)(page_resident_szB);
+   SizeT* now_szB = VG_(calloc)("ms.main.srp.1", n_xecus + 1, sizeof(SizeT));
+
+   for (i = 0; i < VG_(sizeRangeMap)(page_map); i++) {
+      VG_(indexRangeMap)(&lo, &hi, &val, page_map, i);
+      if (val == 0)
+         continue;
+      tl_assert(val - 1 < n_xecus);
+      for (a = lo; a <= hi && a >= lo; a += n_pages * VKI_PAGE_SIZE) {
+         n_pages = (hi - a) / VKI_PAGE_SIZE + 1;
+         if (n_pages > sizeof(vec))
+            n_pages = sizeof(vec);
+         if (VG_(mincore)(a, n_pages * VKI_PAGE_SIZE, vec) != 0)
+            continue;   // e.g. the kernel has gone; count nothing
+         for (j = 0; j < n_pages; j++) {
+            if (vec[j] & 1)
+               now_szB[val - 1] += VKI_PAGE_SIZE;
+         }
+      }
+   }
+
+   for (where = 0; where < n_xecus; where++) {
+      SizeT* resident_szB = VG_(indexXA)(page_resident_szB, where);
+      SizeT  delta_szB;
+      if (now_szB[where] > *resident_szB) {
+         delta_szB = now_szB[where] - *resident_szB;
+         update_heap_stats(delta_szB, 0);
+         VG_(XT_add_to_xecu)(heap_xt, where, &delta_szB);
+      } else if (now_szB[where] < *resident_szB) {
+         delta_szB = *resident_szB - now_szB[where];
+         update_heap_stats(-delta_szB, 0);
+         VG_(XT_sub_from_xecu)(heap_xt, where, &delta_szB);
+      }
+      *resident_szB = now_szB[where];
    }
+
+   VG_(free)(now_szB);
 }
 
 //------------------------------------------------------------//
@@ -1551,7 +1690,7 @@ static
 void ms_copy_mem_remap( Addr from, Addr to, SizeT len)
 {
    tl_assert(VG_IS_PAGE_ALIGNED(len));
-   ms_unrecord_page_mem(from, len);
+   ms_unrecord_page_mem(from, len, /*maybe_snapshot*/True);
    ms_record_page_mem(to, len);
 }
 
@@ -1559,7 +1698,7 @@ static
 void ms_die_mem_munmap( Addr a, SizeT len )
 {
    tl_assert(VG_IS_PAGE_ALIGNED(len));
-   ms_unrecord_page_mem(a, len);
+   ms_unrecord_page_mem(a, len, /*maybe_snapshot*/True);
 }
 
 static
@@ -1571,7 +1710,8 @@ void ms_die_mem_brk( Addr a, SizeT len )
    Addr old_top_page = VG_PGROUNDDN(a + len - 1);
    if (old_top_page != new_bottom_page)
       ms_unrecord_page_mem(VG_PGROUNDDN(a),
-                           (old_top_page - new_bottom_page));
+                           (old_top_page - new_bottom_page),
+                           /*maybe_snapshot*/True);
 
 }
 
@@ -1864,6 +2004,8 @@ static void handle_snapshot_monitor_command (const HChar *filename,
       return;
    }
 
+   if (clo_pages_resident)
+      sample_resident_pages();
    clear_snapshot(&snapshot, /* do_sanity_check */ False);
    take_snapshot(&snapshot, Normal, get_time(), detailed);
    write_snapshots_to_file ((filename == NULL) ? 
@@ -1887,6 +2029,12 @@ static void handle_all_snapshots_monitor_command (const HChar *filename)
                             snapshots, next_snapshot_i);
 }
 
+// With --pages-as-heap=yes, the ranges of page_map are reported after the
+// blocks of malloc_list.  This is the next one to report.  With
+// --pages-resident=yes, it is the next Xecu instead, reported with the
+// size it had resident at the last sample, as in the snapshots.
+static Word xtmemory_next_page_range;
+
 static void xtmemory_report_next_block(XT_Allocs* xta, ExeContext** ec_alloc)
 {
    const HP_Chunk* hc = VG_(HT_Next)(malloc_list);
@@ -1894,13 +2042,40 @@ static void xtmemory_report_next_block(XT_Allocs* xta, ExeContext** ec_alloc)
       xta->nbytes = hc->req_szB;
       xta->nblocks = 1;
       *ec_alloc = VG_(XT_get_ec_from_xecu)(heap_xt, hc->where);
-   } else
-      xta->nblocks = 0;
+      return;
+   }
+   while (clo_pages_resident
+          && xtmemory_next_page_range < VG_(sizeXA)(page_resident_szB)) {
+      Xecu   where = xtmemory_next_page_range++;
+      SizeT* resident_szB = VG_(indexXA)(page_resident_szB, where);
+      if (*resident_szB > 0) {
+         xta->nbytes = *resident_szB;
+         xta->nblocks = 1;
+         *ec_alloc = VG_(XT_get_ec_from_xecu)(heap_xt, where);
+         return;
+      }
+   }
+   while (!clo_pages_resident && page_map
+          && xtmemory_next_page_range < VG_(sizeRangeMap)(page_map)) {
+      UWord lo, hi, val;
+      VG_(indexRangeMap)(&lo, &hi, &val, page_map,
+                         xtmemory_next_page_range++);
+      if (val != 0) {
+         xta->nbytes = hi - lo + 1;
+         xta->nblocks = 1;
+         *ec_alloc = VG_(XT_get_ec_from_xecu)(heap_xt, val - 1);
+         return;
+      }
+   }
+   xta->nblocks = 0;
 }
 static void ms_xtmemory_report ( const HChar* filename, Bool fini )
 { 
    // Make xtmemory_report_next_block ready to be called.
+   if (clo_pages_resident)
+      sample_resident_pages();
    VG_(HT_ResetIter)(malloc_list);
+   xtmemory_next_page_range = 0;
    VG_(XTMemory_report)(filename, fini, xtmemory_report_next_block,
                         VG_(XT_filter_maybe_below_main));
    /* As massif already filters one top function, use as filter
@@ -2012,12 +2187,18 @@ static void ms_post_clo_init(void)
    if (clo_pages_as_heap) {
       if (clo_stacks) {
          VG_(fmsg_bad_option)("--pages-as-heap=yes",
-            "Cannot be used together with --stacks=yes");
+            "Cannot be used together with --stacks=yes\n");
       }
+   } else if (clo_pages_resident) {
+      VG_(fmsg_bad_option)("--pages-resident=yes",
+         "Can only be used together with --pages-as-heap=yes\n");
    }
    if (!clo_heap) {
       clo_pages_as_heap = False;
    }
+   if (!clo_pages_as_heap) {
+      clo_pages_resident = False;
+   }
 
    // If --pages-as-heap=yes we don't want malloc replacement to occur.  So we
    // disable vgpreload_massif-$PLATFORM.so by removing it from LD_PRELOAD (or
@@ -2086,6 +2267,11 @@ static void ms_post_clo_init(void)
    }
 
    if (clo_pages_as_heap) {
+      page_map = VG_(newRangeMap)(VG_(malloc), "ms.main.mpoci.2",
+                                  VG_(free), 0);
+      page_resident_szB = VG_(newXA)(VG_(malloc), "ms.main.mpoci.3",
+                                     VG_(free), sizeof(SizeT));
+
       VG_(track_new_mem_startup) ( ms_new_mem_startup );
       VG_(track_new_mem_brk)     ( ms_new_mem_brk     );
       VG_(track_new_mem_mmap)    ( ms_new_mem_mmap    );
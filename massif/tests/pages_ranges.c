@@ -0,0 +1,69 @@
+// Maps, partly unmaps and mremaps memory directly from main, so that
+// with --pages-as-heap=yes each call site of main is charged for exactly
+// the pages it mapped that are still there.  A detailed snapshot is
+// written to massif.snap.<n> after each step, and also an xtree to
+// massif.xt.<n> if there is an argument.  Some of the pages are touched,
+// for --pages-resident=yes.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "valgrind.h"
+
+static int xt;
+
+static void snapshot(int n)
+{
+   char cmd[100];
+
+   sprintf(cmd, "detailed_snapshot massif.snap.%d", n);
+   VALGRIND_MONITOR_COMMAND(cmd);
+   if (xt) {
+      sprintf(cmd, "xtmemory massif.xt.%d", n);
+      VALGRIND_MONITOR_COMMAND(cmd);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   long  pg = sysconf(_SC_PAGESIZE);
+   char* a;
+   char* b;
+   char* c;
+
+   xt = argc > 1;
+
+   // 8 pages, of which 0, 1, 2 and 6 are touched.
+   a = mmap(NULL, 8 * pg, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   a[0] = a[pg] = a[2 * pg] = a[6 * pg] = 1;
+   snapshot(1);
+
+   // Unmap pages 2, 3 and 4 from the middle.
+   munmap(a + 2 * pg, 3 * pg);
+   snapshot(2);
+
+   // 4 pages, of which 0 and 1 are touched, with room after them to grow
+   // in place to 6 pages.  Page 4 is touched once it exists.
+   b = mmap(NULL, 8 * pg, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   munmap(b + 4 * pg, 4 * pg);
+   b[0] = b[pg] = 1;
+   b = mremap(b, 4 * pg, 6 * pg, 0);
+   b[4 * pg] = 1;
+   snapshot(3);
+
+   // Shrink it to 3 pages.
+   b = mremap(b, 6 * pg, 3 * pg, 0);
+   snapshot(4);
+
+   // Move it into the hole in the first mapping.
+   c = mremap(b, 3 * pg, 3 * pg, MREMAP_MAYMOVE | MREMAP_FIXED, a + 2 * pg);
+   snapshot(5);
+
+   munmap(a, 8 * pg);
+   snapshot(6);
+
+   return c == a + 2 * pg ? 0 : 1;
+}
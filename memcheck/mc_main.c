@@ -37,14 +37,18 @@
 #include "pub_tool_libcbase.h"
 #include "pub_tool_libcassert.h"
 #include "pub_tool_libcprint.h"
+#include "pub_tool_libcsetjmp.h"    // setjmp facilities
+#include "pub_tool_libcsignal.h"
 #include "pub_tool_machine.h"
 #include "pub_tool_mallocfree.h"
 #include "pub_tool_options.h"
 #include "pub_tool_oset.h"
 #include "pub_tool_rangemap.h"
 #include "pub_tool_replacemalloc.h"
+#include "pub_tool_signals.h"
 #include "pub_tool_tooliface.h"
 #include "pub_tool_threadstate.h"
+#include "pub_tool_vki.h"        // VKI_PROT_*
 #include "pub_tool_xarray.h"
 #include "pub_tool_xtree.h"
 #include "pub_tool_xtmemory.h"
@@ -6973,14 +6977,271 @@ static Bool handle_gdb_monitor_command (ThreadId tid, HChar *req)
    }
 }
 
+/*------------------------------------------------------------*/
+/*--- Bulk copies for the memcpy/memset replacements       ---*/
+/*------------------------------------------------------------*/
+
+/* The memcpy, memmove and memset replacements (mc_replace_strmem.c)
+   hand large copies and sets to Memcheck, which does them natively
+   and updates the shadow memory in bulk, rather than through an
+   instrumented load and store per word.  This is only done when the
+   instrumented loops would not report anything: the pointer, length
+   and value arguments are defined, and both ranges are addressable.
+   Otherwise False is returned, and the replacement runs its loops,
+   which report the errors as before. */
+
+/* Is all of [a, a+len) addressable, or if |defined|, addressable and
+   defined?  Like is_mem_addressable and is_mem_defined, but fast
+   enough for the bulk copies: a distinguished secondary map is dealt
+   with at once, and otherwise the V+A bits of a secondary map are
+   looked at a word at a time. */
+static Bool is_mem_ok_fast ( Addr a, SizeT len, Bool defined )
+{
+   const UWord all_defined = ((UWord)0xaaaaaaaaaaaaaaaaULL);
+   const UWord low_bits    = ((UWord)0x5555555555555555ULL);
+   SecMap* sm;
+   SizeT   off, end;
+   UWord   w;
+   UChar   vabits2;
+
+   while (len > 0) {
+      if (!VG_IS_4_ALIGNED(a) || len < 4) {
+         vabits2 = get_vabits2(a);
+         if (vabits2 == VA_BITS2_NOACCESS
+             || (defined && vabits2 != VA_BITS2_DEFINED))
+            return False;
+         a++;
+         len--;
+         continue;
+      }
+
+      /* The 4-byte chunks [off, end) of this secondary map. */
+      sm  = get_secmap_for_reading(a);
+      off = SM_OFF(a);
+      end = off + len / 4;
+      if (end > SM_CHUNKS)
+         end = SM_CHUNKS;
+      a   += 4 * (end - off);
+      len -= 4 * (end - off);
+
+      if (sm == &sm_distinguished[SM_DIST_DEFINED])
+         continue;
+      if (sm == &sm_distinguished[SM_DIST_UNDEFINED] && !defined)
+         continue;
+      if (is_distinguished_sm(sm))
+         return False;
+
+      /* Each byte's pair of bits is 10b if it is defined, and nonzero
+         unless it is noaccess. */
+      for (; off < end; off++) {
+         if (VG_IS_WORD_ALIGNED(off) && end - off >= sizeof(UWord)) {
+            w = *(const UWord*)(const void*)&sm->vabits8[off];
+            if (defined ? w != all_defined
+                        : ((w | (w >> 1)) & low_bits) != low_bits)
+               return False;
+            off += sizeof(UWord) - 1;
+         } else {
+            w = sm->vabits8[off];
+            if (defined ? w != VA_BITS8_DEFINED
+                        : ((w | (w >> 1)) & 0x55) != 0x55)
+               return False;
+         }
+      }
+   }
+   return True;
+}
+
+/* The copy runs on client memory in Memcheck, so a fault it takes,
+   e.g. SIGBUS past the end of a file mapping, must not kill Valgrind.
+   It is caught and the request declined: the replacement's loops then
+   redo the copy in the client, which gets the signal as it would have
+   natively. */
+static VG_MINIMAL_JMP_BUF(bulk_jmpbuf);
+static void bulk_fault_catcher ( Int sigNo, Addr addr )
+{
+   vki_sigset_t sigmask;
+
+   /* See leak_search_fault_catcher. */
+   VG_(sigprocmask)(VKI_SIG_SETMASK, NULL, &sigmask);
+   VG_(sigdelset)(&sigmask, sigNo);
+   VG_(sigprocmask)(VKI_SIG_SETMASK, &sigmask, NULL);
+
+   if (sigNo == VKI_SIGSEGV || sigNo == VKI_SIGBUS)
+      VG_MINIMAL_LONGJMP(bulk_jmpbuf);
+}
+
+/* memmove(dst, src, len), or if src is 0, memset(dst, c, len).
+   Returns False if that faulted. */
+static Bool bulk_native ( Addr dst, Addr src, UChar c, SizeT len )
+{
+   fault_catcher_t prev_catcher;
+
+   prev_catcher = VG_(set_fault_catcher)(bulk_fault_catcher);
+   if (VG_MINIMAL_SETJMP(bulk_jmpbuf) != 0) {
+      VG_(set_fault_catcher)(prev_catcher);
+      return False;
+   }
+   if (src != 0)
+      VG_(memmove)((void*)dst, (void*)src, len);
+   else
+      VG_(memset)((void*)dst, c, len);
+   VG_(set_fault_catcher)(prev_catcher);
+   return True;
+}
+
+/* |arg| is in client memory, so the definedness of the request
+   arguments can be looked up in the shadow memory. */
+static Bool bulk_args_defined ( UWord* arg )
+{
+   return is_mem_defined((Addr)&arg[1], 3 * sizeof(UWord), NULL, NULL)
+          == MC_Ok;
+}
+
+/* memmove(dst, src, len); overlap errors are reported by the caller. */
+static Bool bulk_copy ( UWord* arg, Addr dst, Addr src, SizeT len )
+{
+   if (len == 0 || !bulk_args_defined(arg))
+      return False;
+   if (!is_mem_ok_fast(dst, len, False)
+       || !VG_(am_is_valid_for_client)(dst, len, VKI_PROT_WRITE)
+       || !VG_(am_is_valid_for_client)(src, len, VKI_PROT_READ))
+      return False;
+
+   /* The usual case: the source is all defined. */
+   if (is_mem_ok_fast(src, len, True)) {
+      if (!bulk_native(dst, src, 0, len))
+         return False;
+      MC_(make_mem_defined)(dst, len);
+      return True;
+   }
+
+   /* Otherwise copy the V bits, but only when that is quick: see the
+      fast case of MC_(copy_address_range_state), which does not copy
+      origins either. */
+   if (MC_(clo_mc_level) == 3
+       || !VG_IS_4_ALIGNED(src) || !VG_IS_4_ALIGNED(dst)
+       || !(src + len <= dst || dst + len <= src)
+       || !is_mem_ok_fast(src, len, False))
+      return False;
+   if (!bulk_native(dst, src, 0, len))
+      return False;
+   MC_(copy_address_range_state)(src, dst, len);
+   return True;
+}
+
+/* memset(dst, c, len) */
+static Bool bulk_set ( UWord* arg, Addr dst, UChar c, SizeT len )
+{
+   if (len == 0 || !bulk_args_defined(arg))
+      return False;
+   if (!is_mem_ok_fast(dst, len, False)
+       || !VG_(am_is_valid_for_client)(dst, len, VKI_PROT_WRITE))
+      return False;
+   if (!bulk_native(dst, 0, c, len))
+      return False;
+   MC_(make_mem_defined)(dst, len);
+   return True;
+}
+
 /*------------------------------------------------------------*/
 /*--- Client requests                                      ---*/
 /*------------------------------------------------------------*/
 
+/* Check that [a, a+len) is addressable, and report an error if not.
+   Returns the first erring address, or 0. */
+static Addr client_check_mem_is_addressable ( ThreadId tid, Addr a, SizeT len )
+{
+   Addr bad_addr;
+   Bool ok = is_mem_addressable ( a, len, &bad_addr );
+   if (!ok)
+      MC_(record_user_error) ( tid, bad_addr, /*isAddrErr*/True, 0 );
+   return ok ? 0 : bad_addr;
+}
+
+/* Check that [a, a+len) is addressable and defined, and report errors
+   if not.  Returns the lower of the erring addresses, or 0. */
+static Addr client_check_mem_is_defined ( ThreadId tid, Addr a, SizeT len )
+{
+   Bool errorV    = False;
+   Addr bad_addrV = 0;
+   UInt otagV     = 0;
+   Bool errorA    = False;
+   Addr bad_addrA = 0;
+   is_mem_defined_comprehensive(
+      a, len,
+      &errorV, &bad_addrV, &otagV, &errorA, &bad_addrA
+   );
+   if (errorV) {
+      MC_(record_user_error) ( tid, bad_addrV,
+                               /*isAddrErr*/False, otagV );
+   }
+   if (errorA) {
+      MC_(record_user_error) ( tid, bad_addrA,
+                               /*isAddrErr*/True, 0 );
+   }
+   if (errorV && !errorA)
+      return bad_addrV;
+   if (!errorV && errorA)
+      return bad_addrA;
+   if (errorV && errorA)
+      return bad_addrV < bad_addrA ? bad_addrV : bad_addrA;
+   return 0;
+}
+
+/* Handle the VG_USERREQ__*_RANGES_* requests: apply 'req' to each of
+   the 'n_ranges' (offset, length) pairs at 'ranges', for each of
+   'count' elements 'stride' bytes apart starting at 'base'.  Returns
+   the first erring address found by a check, or 0. */
+static UWord client_mem_ranges ( ThreadId tid, UWord req, Addr base,
+                                 Addr ranges, UWord n_ranges,
+                                 UWord stride, UWord count )
+{
+   const UWord* r = (const UWord*)ranges;
+   UWord i, j;
+   Addr  bad_addr = 0;
+   Addr  a;
+
+   /* The pairs themselves are client memory, so make sure they can be
+      read before looking at them. */
+   if (n_ranges > ~(SizeT)0 / (2 * sizeof(UWord))) {
+      MC_(record_user_error) ( tid, ranges, /*isAddrErr*/True, 0 );
+      return ranges;
+   }
+   a = client_check_mem_is_addressable ( tid, ranges,
+                                         n_ranges * 2 * sizeof(UWord) );
+   if (a != 0)
+      return a;
+
+   for (i = 0; i < count; i++) {
+      for (j = 0; j < n_ranges; j++) {
+         Addr  start = base + i * stride + r[2*j];
+         SizeT len   = r[2*j+1];
+         if (len == 0)
+            continue;
+         switch (req) {
+            case VG_USERREQ__CHECK_MEM_RANGES_ARE_ADDRESSABLE:
+               a = client_check_mem_is_addressable ( tid, start, len );
+               break;
+            case VG_USERREQ__CHECK_MEM_RANGES_ARE_DEFINED:
+               a = client_check_mem_is_defined ( tid, start, len );
+               break;
+            case VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE:
+               make_mem_defined_if_addressable ( start, len );
+               a = 0;
+               break;
+            default:
+               tl_assert(0);
+         }
+         if (bad_addr == 0)
+            bad_addr = a;
+      }
+   }
+   return bad_addr;
+}
+
 static Bool mc_handle_client_request ( ThreadId tid, UWord* arg, UWord* ret )
 {
    Int   i;
-   Addr  bad_addr;
 
    if (!VG_IS_TOOL_USERREQ('M','C',arg[0])
        && VG_USERREQ__MALLOCLIKE_BLOCK != arg[0]
@@ -7000,45 +7261,20 @@ static Bool mc_handle_client_request ( ThreadId tid, UWord* arg, UWord* ret )
       return False;
 
    switch (arg[0]) {
-      case VG_USERREQ__CHECK_MEM_IS_ADDRESSABLE: {
-         Bool ok = is_mem_addressable ( arg[1], arg[2], &bad_addr );
-         if (!ok)
-            MC_(record_user_error) ( tid, bad_addr, /*isAddrErr*/True, 0 );
-         *ret = ok ? (UWord)NULL : bad_addr;
+      case VG_USERREQ__CHECK_MEM_IS_ADDRESSABLE:
+         *ret = client_check_mem_is_addressable ( tid, arg[1], arg[2] );
          break;
-      }
 
-      case VG_USERREQ__CHECK_MEM_IS_DEFINED: {
-         Bool errorV    = False;
-         Addr bad_addrV = 0;
-         UInt otagV     = 0;
-         Bool errorA    = False;
-         Addr bad_addrA = 0;
-         is_mem_defined_comprehensive(
-            arg[1], arg[2],
-            &errorV, &bad_addrV, &otagV, &errorA, &bad_addrA
-         );
-         if (errorV) {
-            MC_(record_user_error) ( tid, bad_addrV,
-                                     /*isAddrErr*/False, otagV );
-         }
-         if (errorA) {
-            MC_(record_user_error) ( tid, bad_addrA,
-                                     /*isAddrErr*/True, 0 );
-         }
-         /* Return the lower of the two erring addresses, if any. */
-         *ret = 0;
-         if (errorV && !errorA) {
-            *ret = bad_addrV;
-         }
-         if (!errorV && errorA) {
-            *ret = bad_addrA;
-         }
-         if (errorV && errorA) {
-            *ret = bad_addrV < bad_addrA ? bad_addrV : bad_addrA;
-         }
+      case VG_USERREQ__CHECK_MEM_IS_DEFINED:
+         *ret = client_check_mem_is_defined ( tid, arg[1], arg[2] );
+         break;
+
+      case VG_USERREQ__CHECK_MEM_RANGES_ARE_ADDRESSABLE:
+      case VG_USERREQ__CHECK_MEM_RANGES_ARE_DEFINED:
+      case VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE:
+         *ret = client_mem_ranges ( tid, arg[0], arg[1], arg[2], arg[3],
+                                    arg[4], arg[5] );
          break;
-      }
 
       case VG_USERREQ__DO_LEAK_CHECK: {
          LeakCheckParams lcp;
@@ -7212,6 +7448,14 @@ static Bool mc_handle_client_request ( ThreadId tid, UWord* arg, UWord* ret )
          return True;
       }
 
+      case _VG_USERREQ__MEMCHECK_BULK_COPY:
+         *ret = bulk_copy(arg, (Addr)arg[1], (Addr)arg[2], (SizeT)arg[3]);
+         return True;
+
+      case _VG_USERREQ__MEMCHECK_BULK_SET:
+         *ret = bulk_set(arg, (Addr)arg[1], (UChar)arg[2], (SizeT)arg[3]);
+         return True;
+
       case VG_USERREQ__CREATE_MEMPOOL: {
          Addr pool      = (Addr)arg[1];
          UInt rzB       =       arg[2];
@@ -43,4 +43,20 @@
                   _VG_USERREQ__MEMCHECK_RECORD_OVERLAP_ERROR,   \
                   s, src, dst, len, 0)
 
+/* Below this size, the instrumented loops of the replacements are
+   cheaper than a trip to Memcheck. */
+#define BULK_MIN_LEN 256
+
+#define BULK_COPY(dst, src, len)                                \
+  ((len) >= BULK_MIN_LEN                                        \
+   && VALGRIND_DO_CLIENT_REQUEST_EXPR(0,                        \
+                  _VG_USERREQ__MEMCHECK_BULK_COPY,              \
+                  dst, src, len, 0, 0))
+
+#define BULK_SET(s, c, len)                                     \
+  ((len) >= BULK_MIN_LEN                                        \
+   && VALGRIND_DO_CLIENT_REQUEST_EXPR(0,                        \
+                  _VG_USERREQ__MEMCHECK_BULK_SET,               \
+                  s, (UChar)(c), len, 0, 0))
+
 #include "../shared/vg_replace_strmem.c"
@@ -99,9 +99,15 @@ typedef
       VG_USERREQ__ENABLE_ADDR_ERROR_REPORTING_IN_RANGE,
       VG_USERREQ__DISABLE_ADDR_ERROR_REPORTING_IN_RANGE,
 
-      /* This is just for memcheck's internal use - don't use it */
+      VG_USERREQ__CHECK_MEM_RANGES_ARE_ADDRESSABLE,
+      VG_USERREQ__CHECK_MEM_RANGES_ARE_DEFINED,
+      VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE,
+
+      /* These are just for memcheck's internal use - don't use them */
       _VG_USERREQ__MEMCHECK_RECORD_OVERLAP_ERROR 
-         = VG_USERREQ_TOOL_BASE('M','C') + 256
+         = VG_USERREQ_TOOL_BASE('M','C') + 256,
+      _VG_USERREQ__MEMCHECK_BULK_COPY,
+      _VG_USERREQ__MEMCHECK_BULK_SET
    } Vg_MemCheckClientRequest;
 
 
@@ -185,6 +191,39 @@ typedef
                       (unsigned long)(sizeof (__lvalue)))
 
 
+/* The following do the same as VALGRIND_CHECK_MEM_IS_ADDRESSABLE,
+   VALGRIND_CHECK_MEM_IS_DEFINED and
+   VALGRIND_MAKE_MEM_DEFINED_IF_ADDRESSABLE, but to many address
+   ranges at once, which is much cheaper than making one request per
+   range.  _qzz_ranges points to _qzz_nranges pairs of unsigned longs,
+   each an (offset, length) pair.  The ranges are applied to
+   _qzz_count elements, _qzz_stride bytes apart, starting at
+   _qzz_base; that is, for each i below _qzz_count and each pair, to
+   the length bytes at _qzz_base + i * _qzz_stride + offset.  The
+   checks print an error message for each offending range, and return
+   the address of the first offending byte found, or zero. */
+#define VALGRIND_CHECK_MEM_RANGES_ARE_ADDRESSABLE(_qzz_base,        \
+           _qzz_ranges,_qzz_nranges,_qzz_stride,_qzz_count)          \
+    VALGRIND_DO_CLIENT_REQUEST_EXPR(0,                               \
+                        VG_USERREQ__CHECK_MEM_RANGES_ARE_ADDRESSABLE, \
+                        (_qzz_base), (_qzz_ranges), (_qzz_nranges),  \
+                        (_qzz_stride), (_qzz_count))
+
+#define VALGRIND_CHECK_MEM_RANGES_ARE_DEFINED(_qzz_base,            \
+           _qzz_ranges,_qzz_nranges,_qzz_stride,_qzz_count)          \
+    VALGRIND_DO_CLIENT_REQUEST_EXPR(0,                               \
+                        VG_USERREQ__CHECK_MEM_RANGES_ARE_DEFINED,    \
+                        (_qzz_base), (_qzz_ranges), (_qzz_nranges),  \
+                        (_qzz_stride), (_qzz_count))
+
+#define VALGRIND_MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE(_qzz_base,  \
+           _qzz_ranges,_qzz_nranges,_qzz_stride,_qzz_count)          \
+    VALGRIND_DO_CLIENT_REQUEST_EXPR(0,                               \
+                  VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE, \
+                        (_qzz_base), (_qzz_ranges), (_qzz_nranges),  \
+                        (_qzz_stride), (_qzz_count))
+
+
 /* Do a full memory leak check (like --leak-check=full) mid-execution. */
 #define VALGRIND_DO_LEAK_CHECK                                   \
     VALGRIND_DO_CLIENT_REQUEST_STMT(VG_USERREQ__DO_LEAK_CHECK,   \
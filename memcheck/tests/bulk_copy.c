@@ -0,0 +1,114 @@
+/* memcpy, memmove and memset of 256 bytes or more are done by Memcheck
+   itself when they can't report an error.  Check that the errors and
+   the definedness they leave are the same as with the instrumented
+   loops of the replacements, which do the smaller ones. */
+
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../memcheck.h"
+
+#define LEN 1024
+
+static sigjmp_buf env;
+
+static void handler(int sig)
+{
+   siglongjmp(env, sig);
+}
+
+/* Reports the first undefined byte of each quarter of p[0 .. LEN). */
+static void check(const char *what, char *p)
+{
+   int i;
+
+   fprintf(stderr, "---- %s\n", what);
+   for (i = 0; i < 4; i++)
+      (void)VALGRIND_CHECK_MEM_IS_DEFINED(p + i * LEN / 4, LEN / 4);
+}
+
+int main(void)
+{
+   char *src = malloc(LEN);
+   char *dst = malloc(LEN);
+   char *buf = malloc(2 * LEN);
+   volatile size_t n = 300;
+   char *volatile q = dst;
+   char tmpl[] = "/tmp/bulk_copy.XXXXXX";
+   long pagesz = sysconf(_SC_PAGESIZE);
+   struct sigaction sa;
+   char *map;
+   int fd, sig;
+
+   /* Bytes [256, 512) of src are undefined. */
+   memset(src, 'a', 256);
+   memset(src + 512, 'b', LEN - 512);
+
+   memcpy(dst, src, LEN);
+   check("memcpy, partially defined source", dst);
+
+   memset(dst + 100, 0, 600);
+   check("memset", dst);
+
+   memcpy(buf, src, LEN);
+   memmove(buf + 128, buf, LEN);
+   check("memmove up, overlapping", buf + 128);
+   memmove(buf, buf + 128, LEN);
+   check("memmove down, overlapping", buf);
+
+   /* Undefined length and pointer arguments. */
+   VALGRIND_MAKE_MEM_UNDEFINED(&n, sizeof n);
+   fprintf(stderr, "---- memcpy, undefined length\n");
+   memcpy(dst, src + 512, n);
+   fprintf(stderr, "---- memset, undefined length\n");
+   memset(dst, 0, n);
+   n = 300;
+   VALGRIND_MAKE_MEM_UNDEFINED(&q, sizeof q);
+   fprintf(stderr, "---- memcpy, undefined destination\n");
+   memcpy(q, src + 512, 300);
+   fprintf(stderr, "---- memset, undefined destination\n");
+   memset(q, 0, 300);
+   q = dst;
+
+   /* Running one byte off the end of the block. */
+   fprintf(stderr, "---- memcpy, past the end\n");
+   memcpy(dst + LEN - 256, src + 512, 257);
+   fprintf(stderr, "---- memset, past the end\n");
+   memset(dst + LEN - 256, 0, 257);
+
+   /* The second page of a one byte file is mapped, but any access to
+      it gets SIGBUS, which the client must see. */
+   fd = mkstemp(tmpl);
+   if (fd < 0 || write(fd, "x", 1) != 1) {
+      perror("bulk_copy: temporary file");
+      return 1;
+   }
+   unlink(tmpl);
+   map = mmap(NULL, 2 * pagesz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (map == MAP_FAILED) {
+      perror("bulk_copy: mmap");
+      return 1;
+   }
+   memset(&sa, 0, sizeof sa);
+   sa.sa_handler = handler;
+   sigaction(SIGBUS, &sa, NULL);
+   fprintf(stderr, "---- past the end of a file mapping\n");
+   if ((sig = sigsetjmp(env, 1)) == 0)
+      memcpy(dst, map + pagesz, 512);
+   fprintf(stderr, "memcpy from it: %s\n", sig == SIGBUS ? "SIGBUS" : "?");
+   if ((sig = sigsetjmp(env, 1)) == 0)
+      memset(map + pagesz, 0, 512);
+   fprintf(stderr, "memset of it: %s\n", sig == SIGBUS ? "SIGBUS" : "?");
+
+   munmap(map, 2 * pagesz);
+   close(fd);
+   free(src);
+   free(dst);
+   free(buf);
+   return 0;
+}
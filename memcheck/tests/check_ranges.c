@@ -0,0 +1,41 @@
+/* Check the client requests that check or paint a list of ranges in
+   each of a number of equally spaced elements. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../memcheck.h"
+
+/* The first four bytes and the two bytes at offset 8 of an element. */
+static unsigned long ranges[] = { 0, 4,  8, 2 };
+
+int main ( void )
+{
+   char*         p = malloc(64);
+   unsigned long bad;
+   int           i;
+
+   for (i = 0; i < 64; i++)
+      if (i % 16 < 4)
+         p[i] = 1;
+
+   fprintf(stderr, "\nChecking defined ranges.  Expect no complaint.\n");
+   bad = VALGRIND_CHECK_MEM_RANGES_ARE_DEFINED(p, ranges, 1, 16, 4);
+   fprintf(stderr, "bad = %lu\n", bad);
+
+   fprintf(stderr, "\nChecking undefined ranges.  Expect complaint.\n\n");
+   bad = VALGRIND_CHECK_MEM_RANGES_ARE_DEFINED(p, ranges, 2, 16, 4);
+   fprintf(stderr, "bad = p + %lu\n", bad - (unsigned long)p);
+
+   fprintf(stderr, "\nPainting ranges, then checking them again.  "
+                   "Expect no complaint.\n");
+   VALGRIND_MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE(p, ranges, 2, 16, 5);
+   bad = VALGRIND_CHECK_MEM_RANGES_ARE_DEFINED(p, ranges, 2, 16, 4);
+   fprintf(stderr, "bad = %lu\n", bad);
+
+   fprintf(stderr, "\nChecking one element too many.  Expect complaint.\n\n");
+   bad = VALGRIND_CHECK_MEM_RANGES_ARE_ADDRESSABLE(p, ranges, 2, 16, 5);
+   fprintf(stderr, "bad = p + %lu\n", bad - (unsigned long)p);
+
+   free(p);
+   return 0;
+}
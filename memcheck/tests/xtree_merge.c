@@ -0,0 +1,42 @@
+/* Allocates along a few call paths, then dumps the memcheck xtree at
+   the same point in callgrind and in binary format, so that the
+   binary one can be checked against the callgrind one. */
+
+#include <stdlib.h>
+#include "../memcheck.h"
+
+static void* keep[100];
+static int n_keep;
+
+__attribute__((noinline)) static void alloc_leaf(size_t sz)
+{
+   keep[n_keep++] = malloc(sz);
+}
+
+__attribute__((noinline)) static void alloc_a(void)
+{
+   int i;
+   for (i = 0; i < 10; i++)
+      alloc_leaf(100);
+}
+
+__attribute__((noinline)) static void alloc_b(void)
+{
+   int i;
+   for (i = 0; i < 5; i++)
+      alloc_leaf(1000);
+   free(malloc(5000));
+}
+
+int main(void)
+{
+   int i;
+   alloc_a();
+   alloc_b();
+   alloc_b();
+   VALGRIND_MONITOR_COMMAND("xtmemory xtree_merge.kcg");
+   VALGRIND_MONITOR_COMMAND("xtmemory xtree_merge.xtb");
+   for (i = 0; i < n_keep; i++)
+      free(keep[i]);
+   return 0;
+}
@@ -953,6 +953,287 @@ void mpiwrap_walk_type_EXTERNALLY_VISIBLE
 }
 
 
+/*------------------------------------------------------------*/
+/*--- Flattened types                                      ---*/
+/*------------------------------------------------------------*/
+
+/* Walking a derived type means taking it to bits with
+   PMPI_Type_get_envelope and PMPI_Type_get_contents all over again,
+   and then making a memcheck request for each contiguous fragment,
+   which for a large strided type costs far more than the checking
+   itself.  So each type is walked just once, and its fragments are
+   kept in a table keyed by the type, as (offset, length) pairs
+   relative to the start of one element, with abutting fragments
+   merged.  An array of elements of the type is then checked or
+   painted with a single request, which is given the fragments and
+   the type's extent.
+
+   A handle may stand for a different type once it has been freed, so
+   the Type_free wrapper removes the type from the table.  Entries are
+   reference counted, since MPI allows a type to be freed while an
+   Irecv using it is pending, and the Irecv still needs the fragments
+   when it completes.
+
+   Access to the table is guarded by fTys_lock.  That can't be held
+   while walking a type, since walk_type frees the types that
+   PMPI_Type_get_contents gives it, and so calls the Type_free
+   wrapper.  The walks are serialised by flat_lock instead, which
+   also guards flat_frags{,_used,_size}. */
+
+typedef
+   struct _FlatTy {
+      struct _FlatTy* next;     /* hash chain */
+      MPI_Datatype    ty;
+      int             refs;     /* 1 while in the table, +1 per user */
+      long            extent;
+      long            n_frags;
+      long*           frags;    /* n_frags (offset, length) pairs */
+   }
+   FlatTy;
+
+#define N_FTYS_HASH 509
+
+static FlatTy*         fTys[N_FTYS_HASH];
+static pthread_mutex_t fTys_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long*           flat_frags      = NULL;
+static long            flat_frags_used = 0;
+static long            flat_frags_size = 0;
+static pthread_mutex_t flat_lock       = PTHREAD_MUTEX_INITIALIZER;
+
+#define LOCK_FTYS                                   \
+  do { int pr = pthread_mutex_lock(&fTys_lock);     \
+       assert(pr == 0);                             \
+  } while (0)
+
+#define UNLOCK_FTYS                                 \
+  do { int pr = pthread_mutex_unlock(&fTys_lock);   \
+       assert(pr == 0);                             \
+  } while (0)
+
+#define LOCK_FLAT                                   \
+  do { int pr = pthread_mutex_lock(&flat_lock);     \
+       assert(pr == 0);                             \
+  } while (0)
+
+#define UNLOCK_FLAT                                 \
+  do { int pr = pthread_mutex_unlock(&flat_lock);   \
+       assert(pr == 0);                             \
+  } while (0)
+
+static __inline__ UWord hash_Ty ( MPI_Datatype ty )
+{
+   return ((UWord)ty) % N_FTYS_HASH;
+}
+
+
+/* Callback for walk_type, which is given a base address of zero, so
+   that the fragment addresses are offsets.  NOTE: flat_lock is held
+   throughout this procedure. */
+static void add_flat_frag ( void* base, long nbytes )
+{
+   long off = (long)base;
+   long n   = flat_frags_used;
+
+   if (nbytes <= 0)
+      return;
+   if (n > 0 && flat_frags[2*n-2] + flat_frags[2*n-1] == off) {
+      flat_frags[2*n-1] += nbytes;
+      return;
+   }
+   if (n == flat_frags_size) {
+      flat_frags_size = flat_frags_size==0 ? 16 : 2*flat_frags_size;
+      flat_frags = realloc( flat_frags, flat_frags_size * 2 * sizeof(long) );
+      if (flat_frags == NULL) {
+         UNLOCK_FLAT;
+         barf("add_flat_frag: realloc failed");
+      }
+   }
+   flat_frags[2*n]   = off;
+   flat_frags[2*n+1] = nbytes;
+   flat_frags_used++;
+}
+
+
+/* Get the flattening of 'ty', walking the type if it isn't already
+   in the table.  The caller must release it with release_FlatTy. */
+static FlatTy* get_FlatTy ( MPI_Datatype ty )
+{
+   FlatTy* fty;
+   FlatTy* fty2;
+   UWord   h = hash_Ty(ty);
+
+   LOCK_FTYS;
+   for (fty = fTys[h]; fty; fty = fty->next) {
+      if (fty->ty == ty) {
+         fty->refs++;
+         UNLOCK_FTYS;
+         return fty;
+      }
+   }
+   UNLOCK_FTYS;
+
+   fty = malloc( sizeof(FlatTy) );
+   if (fty == NULL)
+      barf("get_FlatTy: malloc failed");
+
+   LOCK_FLAT;
+   flat_frags_used = 0;
+   walk_type( add_flat_frag, (char*)0, ty );
+   fty->n_frags = flat_frags_used;
+   fty->frags   = malloc( (flat_frags_used + 1) * 2 * sizeof(long) );
+   if (fty->frags == NULL) {
+      UNLOCK_FLAT;
+      barf("get_FlatTy: malloc failed");
+   }
+   memcpy( fty->frags, flat_frags, flat_frags_used * 2 * sizeof(long) );
+   UNLOCK_FLAT;
+
+   fty->ty     = ty;
+   fty->refs   = 2;
+   fty->extent = extentOfTy(ty);
+
+   LOCK_FTYS;
+   /* Another thread may have got there first; if so use its one. */
+   for (fty2 = fTys[h]; fty2; fty2 = fty2->next) {
+      if (fty2->ty == ty) {
+         fty2->refs++;
+         UNLOCK_FTYS;
+         free(fty->frags);
+         free(fty);
+         return fty2;
+      }
+   }
+   fty->next = fTys[h];
+   fTys[h]   = fty;
+   UNLOCK_FTYS;
+
+   if (opt_verbosity > 1)
+      fprintf(stderr, "%s %5d: fTy+ 0x%lx -> %ld fragments, extent %ld\n",
+                      preamble, my_pid, (long)ty, fty->n_frags, fty->extent);
+   return fty;
+}
+
+
+static void release_FlatTy ( FlatTy* fty )
+{
+   LOCK_FTYS;
+   assert(fty->refs > 0);
+   fty->refs--;
+   if (fty->refs == 0) {
+      free(fty->frags);
+      free(fty);
+   }
+   UNLOCK_FTYS;
+}
+
+
+/* Remove 'ty' from the table, since it is about to be freed. */
+static void forget_FlatTy ( MPI_Datatype ty )
+{
+   FlatTy** prev;
+   FlatTy*  fty;
+   LOCK_FTYS;
+   for (prev = &fTys[hash_Ty(ty)]; (fty = *prev) != NULL; prev = &fty->next) {
+      if (fty->ty == ty) {
+         *prev = fty->next;
+         assert(fty->refs > 0);
+         fty->refs--;
+         if (fty->refs == 0) {
+            free(fty->frags);
+            free(fty);
+         }
+         break;
+      }
+   }
+   UNLOCK_FTYS;
+}
+
+#undef LOCK_FTYS
+#undef UNLOCK_FTYS
+#undef LOCK_FLAT
+#undef UNLOCK_FLAT
+
+
+/* Make memcheck request 'req', one of the VG_USERREQ__*_RANGES_*
+   requests, for 'count' elements of the type flattened in 'fty',
+   starting at 'base'. */
+static __inline__
+void do_ranges_request ( int req, char* base, long count, FlatTy* fty )
+{
+   long whole[2];
+
+   if (count <= 0 || fty->n_frags == 0)
+      return;
+
+   if (fty->n_frags == 1 && fty->frags[1] == fty->extent) {
+      /* The elements abut, so the whole array is one fragment. */
+      whole[0] = fty->frags[0];
+      whole[1] = count * fty->extent;
+      (void)VALGRIND_DO_CLIENT_REQUEST_EXPR(0, req, base, whole, 1, 0, 1);
+   } else {
+      (void)VALGRIND_DO_CLIENT_REQUEST_EXPR(0, req, base,
+                                            fty->frags, fty->n_frags,
+                                            fty->extent, count);
+   }
+}
+
+
+/* The Irecvs completed by Waitall or Testall, whose buffers are
+   waiting to be painted as defined.  Each entry keeps its reference
+   to the flattened type until it is painted, so the list grows with
+   the number of requests and not with the size of their buffers. */
+typedef
+   struct {
+      char*   buf;
+      long    count;
+      FlatTy* fty;
+   }
+   PaintRecv;
+
+typedef
+   struct {
+      PaintRecv* recvs;
+      int        used;
+      int        size;
+   }
+   PaintList;
+
+/* Add 'count' elements of the type flattened in 'fty', starting at
+   'base'.  The list takes over the caller's reference to 'fty'. */
+static void add_to_PaintList ( PaintList* pl, char* base, long count,
+                               FlatTy* fty )
+{
+   if (pl->used == pl->size) {
+      pl->size  = pl->size==0 ? 4 : 2*pl->size;
+      pl->recvs = realloc( pl->recvs, pl->size * sizeof(PaintRecv) );
+      if (pl->recvs == NULL)
+         barf("add_to_PaintList: realloc failed");
+   }
+   pl->recvs[pl->used].buf   = base;
+   pl->recvs[pl->used].count = count;
+   pl->recvs[pl->used].fty   = fty;
+   pl->used++;
+}
+
+/* Paint each buffer in the list with one memcheck request, and
+   release its type. */
+static void paint_PaintList ( PaintList* pl )
+{
+   int i;
+   for (i = 0; i < pl->used; i++) {
+      do_ranges_request( VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE,
+                         pl->recvs[i].buf, pl->recvs[i].count,
+                         pl->recvs[i].fty );
+      release_FlatTy(pl->recvs[i].fty);
+   }
+   if (pl->recvs)
+      free(pl->recvs);
+   pl->recvs = NULL;
+   pl->used  = pl->size = 0;
+}
+
+
 /*------------------------------------------------------------*/
 /*--- Address-range helpers                                ---*/
 /*------------------------------------------------------------*/
@@ -1009,7 +1290,13 @@ void make_mem_defined_if_addressable_if_success_untyped ( int err,
 static __inline__
 void check_mem_is_defined ( char* buffer, long count, MPI_Datatype datatype )
 {
-   walk_type_array( check_mem_is_defined_untyped, buffer, datatype, count );
+   FlatTy* fty;
+   if (count <= 0)
+      return;
+   fty = get_FlatTy(datatype);
+   do_ranges_request( VG_USERREQ__CHECK_MEM_RANGES_ARE_DEFINED,
+                      buffer, count, fty );
+   release_FlatTy(fty);
 }
 
 
@@ -1020,7 +1307,13 @@ void check_mem_is_defined ( char* buffer, long count, MPI_Datatype datatype )
 static __inline__
 void check_mem_is_addressable ( void *buffer, long count, MPI_Datatype datatype )
 {
-   walk_type_array( check_mem_is_addressable_untyped, buffer, datatype, count );
+   FlatTy* fty;
+   if (count <= 0)
+      return;
+   fty = get_FlatTy(datatype);
+   do_ranges_request( VG_USERREQ__CHECK_MEM_RANGES_ARE_ADDRESSABLE,
+                      buffer, count, fty );
+   release_FlatTy(fty);
 }
 
 
@@ -1030,8 +1323,13 @@ void check_mem_is_addressable ( void *buffer, long count, MPI_Datatype datatype
 static __inline__
 void make_mem_defined_if_addressable ( void *buffer, int count, MPI_Datatype datatype )
 {
-   walk_type_array( make_mem_defined_if_addressable_untyped,
-                    buffer, datatype, count );
+   FlatTy* fty;
+   if (count <= 0)
+      return;
+   fty = get_FlatTy(datatype);
+   do_ranges_request( VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE,
+                      buffer, count, fty );
+   release_FlatTy(fty);
 }
 
 static __inline__
@@ -1171,7 +1469,8 @@ int WRAPPER_FOR(PMPI_Get_count)(MPI_Status* status,
    But the recv buffer details are not presented to MPI_Wait - only
    the handle is.  We therefore have to use a shadow table
    (sReqs{,_size,_used,_lock}) which associates uncompleted
-   MPI_Requests with the corresponding buffer address/count/type.
+   MPI_Requests with the corresponding buffer address/count/type,
+   together with the flattening of the type.
 
    Only read requests are placed in the table, since there is no need
    to do any buffer painting following completion of an Isend - all
@@ -1190,6 +1489,7 @@ typedef
       void*        buf;
       int          count;
       MPI_Datatype datatype;
+      FlatTy*      fty;       /* NULL if count is zero or less */
    }
    ShadowRequest;
 
@@ -1233,22 +1533,26 @@ static void ensure_sReq_space ( void )
 }
 
 
-/* Find shadow info for 'request', or NULL if none. */
+/* Find shadow info for 'request', copy it to *shadow and remove it
+   from the table.  Returns False if there is none.  The caller must
+   release shadow->fty, if it isn't NULL. */
 
 static 
-ShadowRequest* find_shadow_Request ( MPI_Request request )
+Bool take_shadow_Request ( MPI_Request request, ShadowRequest* shadow )
 {
-   ShadowRequest* ret = NULL;
+   Bool found = False;
    int i;
    LOCK_SREQS;
    for (i = 0; i < sReqs_used; i++) {
       if (sReqs[i].inUse && eq_MPI_Request(sReqs[i].key,request)) {
-         ret = &sReqs[i];
+         *shadow = sReqs[i];
+         sReqs[i].inUse = False;
+         found = True;
          break;
       }
    }
    UNLOCK_SREQS;
-   return ret;
+   return found;
 }
 
 
@@ -1256,15 +1560,9 @@ ShadowRequest* find_shadow_Request ( MPI_Request request )
 
 static void delete_shadow_Request ( MPI_Request request )
 {
-   int i;
-   LOCK_SREQS;
-   for (i = 0; i < sReqs_used; i++) {
-      if (sReqs[i].inUse && eq_MPI_Request(sReqs[i].key,request)) {
-         sReqs[i].inUse = False;
-         break;
-      }
-   }
-   UNLOCK_SREQS;
+   ShadowRequest shadow;
+   if (take_shadow_Request(request, &shadow) && shadow.fty)
+      release_FlatTy(shadow.fty);
 }
 
 
@@ -1275,7 +1573,9 @@ void add_shadow_Request( MPI_Request request,
                          void* buf, int count, 
                          MPI_Datatype datatype )
 {
-   int i, ix = -1;
+   int     i, ix = -1;
+   FlatTy* fty = count > 0 ? get_FlatTy(datatype) : NULL;
+   FlatTy* old_fty = NULL;
    LOCK_SREQS;
    assert(sReqs_used >= 0);
    assert(sReqs_size >= 0);
@@ -1287,6 +1587,7 @@ void add_shadow_Request( MPI_Request request,
    for (i = 0; i < sReqs_used; i++) {
       if (sReqs[i].inUse && eq_MPI_Request(sReqs[i].key,request)) {
          ix = i;
+         old_fty = sReqs[i].fty;
          break;
       }
    }
@@ -1318,8 +1619,11 @@ void add_shadow_Request( MPI_Request request,
    sReqs[ix].buf      = buf;
    sReqs[ix].count    = count;
    sReqs[ix].datatype = datatype;
+   sReqs[ix].fty      = fty;
 
    UNLOCK_SREQS;
+   if (old_fty)
+      release_FlatTy(old_fty);
    if (opt_verbosity > 1)
       fprintf(stderr, "%s %5d: sReq+ 0x%lx -> b/c/d %p/%d/0x%lx [slot %d]\n",
                       preamble, my_pid, (unsigned long)request, 
@@ -1349,13 +1653,17 @@ MPI_Request* clone_Request_array ( int count, MPI_Request* orig )
 #undef UNLOCK_SREQS
 
 
+/* If 'paint' is NULL, the buffer of a completed Irecv is painted
+   straight away; otherwise it is added to 'paint' for the caller to
+   paint later. */
 static void maybe_complete ( Bool         error_in_status,
                              MPI_Request  request_before,
                              MPI_Request  request_after,
-                             MPI_Status*  status )
+                             MPI_Status*  status,
+                             PaintList*   paint )
 {
    int recv_count = 0;
-   ShadowRequest* shadow;
+   ShadowRequest shadow;
    /* How do we know if this is an Irecv request that has now
       finished successfully? 
       
@@ -1370,16 +1678,24 @@ static void maybe_complete ( Bool         error_in_status,
    if (request_before != MPI_REQUEST_NULL
        && request_after == MPI_REQUEST_NULL
        && (error_in_status ? status->MPI_ERROR == MPI_SUCCESS : True)
-       && ( (shadow=find_shadow_Request(request_before)) != NULL) ) {
+       && take_shadow_Request(request_before, &shadow) ) {
       /* The Irecv detailed in 'shadow' completed.  Paint the result
-         buffer, and delete the entry. */
-      if (count_from_Status(&recv_count, shadow->datatype, status)) {
-         make_mem_defined_if_addressable(shadow->buf, recv_count, shadow->datatype);
+         buffer; the entry has already been deleted. */
+      if (count_from_Status(&recv_count, shadow.datatype, status)) {
+         if (shadow.fty && paint) {
+            add_to_PaintList(paint, shadow.buf, recv_count, shadow.fty);
+            shadow.fty = NULL;
+         } else if (shadow.fty) {
+            do_ranges_request(
+               VG_USERREQ__MAKE_MEM_RANGES_DEFINED_IF_ADDRESSABLE,
+               shadow.buf, recv_count, shadow.fty );
+         }
          if (opt_verbosity > 1)
             fprintf(stderr, "%s %5d: sReq- 0x%lx (completed)\n",
                             preamble, my_pid, (unsigned long) request_before);
       }
-      delete_shadow_Request(request_before);
+      if (shadow.fty)
+         release_FlatTy(shadow.fty);
    }
 }
 
@@ -1479,7 +1795,7 @@ int WRAPPER_FOR(PMPI_Wait)( MPI_Request* request,
    if (cONFIG_DER) VALGRIND_ENABLE_ERROR_REPORTING;
    if (err == MPI_SUCCESS) {
       maybe_complete(False/*err in status?*/, 
-                     request_before, *request, status);
+                     request_before, *request, status, NULL);
       make_mem_defined_if_addressable_untyped(status, sizeof(MPI_Status));
    }
    after("Wait", err);
@@ -1495,7 +1811,7 @@ int WRAPPER_FOR(PMPI_Waitany)( int count,
    MPI_Request* requests_before = NULL;
    MPI_Status   fake_status;
    OrigFn       fn;
-   int          err, i;
+   int          err;
    VALGRIND_GET_ORIG_FN(fn);
    before("Waitany");
    if (isMSI(status))
@@ -1503,16 +1819,15 @@ int WRAPPER_FOR(PMPI_Waitany)( int count,
    if (0) fprintf(stderr, "Waitany: %d\n", count);
    check_mem_is_addressable_untyped(index, sizeof(int));
    check_mem_is_addressable_untyped(status, sizeof(MPI_Status));
-   for (i = 0; i < count; i++) {
-      check_mem_is_defined_untyped(&requests[i], sizeof(MPI_Request));
-   }
+   check_mem_is_defined_untyped(requests, count * sizeof(MPI_Request));
    requests_before = clone_Request_array( count, requests );
    if (cONFIG_DER) VALGRIND_DISABLE_ERROR_REPORTING;
    CALL_FN_W_WWWW(err, fn, count,requests,index,status);
    if (cONFIG_DER) VALGRIND_ENABLE_ERROR_REPORTING;
    if (err == MPI_SUCCESS && *index >= 0 && *index < count) {
       maybe_complete(False/*err in status?*/, 
-                     requests_before[*index], requests[*index], status);
+                     requests_before[*index], requests[*index], status,
+                     NULL);
       make_mem_defined_if_addressable_untyped(status, sizeof(MPI_Status));
    }
    if (requests_before)
@@ -1527,6 +1842,7 @@ int WRAPPER_FOR(PMPI_Waitall)( int count,
                                MPI_Status* statuses )
 {
    MPI_Request* requests_before = NULL;
+   PaintList    paint = { NULL, 0, 0 };
    OrigFn       fn;
    int          err, i;
    Bool         free_sta = False;
@@ -1537,10 +1853,8 @@ int WRAPPER_FOR(PMPI_Waitall)( int count,
       free_sta = True;
       statuses = malloc( (count < 0 ? 0 : count) * sizeof(MPI_Status) );
    }
-   for (i = 0; i < count; i++) {
-      check_mem_is_addressable_untyped(&statuses[i], sizeof(MPI_Status));
-      check_mem_is_defined_untyped(&requests[i], sizeof(MPI_Request));
-   }
+   check_mem_is_addressable_untyped(statuses, count * sizeof(MPI_Status));
+   check_mem_is_defined_untyped(requests, count * sizeof(MPI_Request));
    requests_before = clone_Request_array( count, requests );
    if (cONFIG_DER) VALGRIND_DISABLE_ERROR_REPORTING;
    CALL_FN_W_WWW(err, fn, count,requests,statuses);
@@ -1550,10 +1864,11 @@ int WRAPPER_FOR(PMPI_Waitall)( int count,
       Bool e_i_s = err == MPI_ERR_IN_STATUS;
       for (i = 0; i < count; i++) {
          maybe_complete(e_i_s, requests_before[i], requests[i], 
-                               &statuses[i]);
-         make_mem_defined_if_addressable_untyped(&statuses[i],
-                                                 sizeof(MPI_Status));
+                               &statuses[i], &paint);
       }
+      paint_PaintList(&paint);
+      make_mem_defined_if_addressable_untyped(statuses,
+                                              count * sizeof(MPI_Status));
    }
    if (requests_before)
       free(requests_before);
@@ -1585,7 +1900,7 @@ int WRAPPER_FOR(PMPI_Test)( MPI_Request* request, int* flag,
    if (cONFIG_DER) VALGRIND_ENABLE_ERROR_REPORTING;
    if (err == MPI_SUCCESS && *flag) {
       maybe_complete(False/*err in status?*/, 
-                     request_before, *request, status);
+                     request_before, *request, status, NULL);
       make_mem_defined_if_addressable_untyped(status, sizeof(MPI_Status));
    }
    after("Test", err);
@@ -1598,6 +1913,7 @@ int WRAPPER_FOR(PMPI_Testall)( int count, MPI_Request* requests,
                                int* flag, MPI_Status* statuses )
 {
    MPI_Request* requests_before = NULL;
+   PaintList    paint = { NULL, 0, 0 };
    OrigFn       fn;
    int          err, i;
    Bool         free_sta = False;
@@ -1609,10 +1925,8 @@ int WRAPPER_FOR(PMPI_Testall)( int count, MPI_Request* requests,
       statuses = malloc( (count < 0 ? 0 : count) * sizeof(MPI_Status) );
    }
    check_mem_is_addressable_untyped(flag, sizeof(int));
-   for (i = 0; i < count; i++) {
-      check_mem_is_addressable_untyped(&statuses[i], sizeof(MPI_Status));
-      check_mem_is_defined_untyped(&requests[i], sizeof(MPI_Request));
-   }
+   check_mem_is_addressable_untyped(statuses, count * sizeof(MPI_Status));
+   check_mem_is_defined_untyped(requests, count * sizeof(MPI_Request));
    requests_before = clone_Request_array( count, requests );
    if (cONFIG_DER) VALGRIND_DISABLE_ERROR_REPORTING;
    CALL_FN_W_WWWW(err, fn, count,requests,flag,statuses);
@@ -1624,10 +1938,11 @@ int WRAPPER_FOR(PMPI_Testall)( int count, MPI_Request* requests,
       Bool e_i_s = err == MPI_ERR_IN_STATUS;
       for (i = 0; i < count; i++) {
          maybe_complete(e_i_s, requests_before[i], requests[i], 
-                               &statuses[i]);
-         make_mem_defined_if_addressable_untyped(&statuses[i],
-                                                 sizeof(MPI_Status));
+                               &statuses[i], &paint);
       }
+      paint_PaintList(&paint);
+      make_mem_defined_if_addressable_untyped(statuses,
+                                              count * sizeof(MPI_Status));
    }
    if (requests_before)
       free(requests_before);
@@ -1797,6 +2112,7 @@ int WRAPPER_FOR(PMPI_Type_free)( MPI_Datatype* ty )
    VALGRIND_GET_ORIG_FN(fn);
    before("Type_free");
    check_mem_is_defined_untyped(ty, sizeof(*ty));
+   forget_FlatTy(*ty);
    if (cONFIG_DER) VALGRIND_DISABLE_ERROR_REPORTING;
    CALL_FN_W_W(err, fn, ty);
    if (cONFIG_DER) VALGRIND_ENABLE_ERROR_REPORTING;
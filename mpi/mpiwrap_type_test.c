@@ -217,6 +217,138 @@ void sendToMyself ( Bool commit_free, Ty* tyP, char* name )
 }
 
 
+/* Check the flattening libmpiwrap.so uses to paint a completed Irecv
+   against walk_type.  Two elements of the type are sent to ourselves
+   from an undefined buffer, so that the MPI library makes undefined
+   exactly the bytes it transfers, into a receive buffer which is also
+   undefined.  The Irecv is completed by MPI_Waitall, whose wrapper
+   paints as defined the bytes in the flattening of the type and
+   nothing else.  If 'commit_free' the type is freed while the Irecv
+   is pending, which the flattening has to survive. */
+#define N_FLAT_ELEMS 2
+
+void flattenToMyself ( Bool commit_free, Ty* tyP, char* name )
+{
+   int i, j;
+   MPI_Aint lb, ub, ex;
+   MPI_Request reqs[2];
+   MPI_Status statuses[2];
+   long size;
+   char* sbuf;
+   char* rbuf;
+   char* rbuf_walk;
+   unsigned char* vbits;
+   Bool ok;
+   int r;
+
+   void(*dl_walk_type)(void(*)(void*,long),char*,MPI_Datatype) 
+     = (void(*)(void(*)(void*,long),char*,MPI_Datatype))
+       walk_type_fn;
+  
+   if (!dl_walk_type) {
+      printf("flattenToMyself: can't establish type walker fn\n");
+      return;
+   }
+
+   printf("\nflattenToMyself: trying %s\n", name);
+
+   if (commit_free) {
+      r = MPI_Type_commit( tyP );
+      assert(r == MPI_SUCCESS);
+   }
+
+   r = MPI_Type_lb( *tyP, &lb );
+   assert(r == MPI_SUCCESS);
+   r = MPI_Type_ub( *tyP, &ub );
+   assert(r == MPI_SUCCESS);
+   r = MPI_Type_extent( *tyP, &ex );
+   assert(r == MPI_SUCCESS);
+   assert(lb >= 0);
+   size = (N_FLAT_ELEMS-1) * ex + ub;
+
+   /* What walk_type thinks is in the elements. */
+   rbuf_walk = malloc(size);
+   assert(rbuf_walk);
+   for (i = 0; i < size; i++)
+      rbuf_walk[i] = 0xFF;
+   for (j = 0; j < N_FLAT_ELEMS; j++)
+      dl_walk_type( sendToMyself_callback, rbuf_walk + j * ex, *tyP );
+
+   sbuf = malloc(size);
+   assert(sbuf);
+   for (i = 0; i < size; i++)
+      sbuf[i] = 0;
+   VALGRIND_MAKE_MEM_UNDEFINED(sbuf, size);
+
+   rbuf = malloc(size);
+   assert(rbuf);
+   for (i = 0; i < size; i++)
+      rbuf[i] = 0xFF;
+   VALGRIND_MAKE_MEM_UNDEFINED(rbuf, size);
+
+   r = MPI_Irecv( rbuf,N_FLAT_ELEMS,*tyP, 0,98,MPI_COMM_WORLD, &reqs[0]);
+   assert(r == MPI_SUCCESS);
+
+   /* Sending the undefined buffer is an error, of course. */
+   VALGRIND_DISABLE_ERROR_REPORTING;
+   r = MPI_Isend( sbuf,N_FLAT_ELEMS,*tyP, 0,98,MPI_COMM_WORLD, &reqs[1]);
+   VALGRIND_ENABLE_ERROR_REPORTING;
+   assert(r == MPI_SUCCESS);
+
+   if (commit_free) {
+      r = MPI_Type_free( tyP );
+      assert(r == MPI_SUCCESS);
+   }
+
+   VALGRIND_DISABLE_ERROR_REPORTING;
+   r = MPI_Waitall( 2, reqs, statuses );
+   VALGRIND_ENABLE_ERROR_REPORTING;
+   assert(r == MPI_SUCCESS);
+
+   /* Now: the bytes of rbuf that are defined are those the wrapper
+      painted, and those that are 0x00 are those the MPI library
+      transferred.  Only the values are looked at, so make them all
+      defined. */
+   vbits = malloc(size);
+   assert(vbits);
+   r = VALGRIND_GET_VBITS(rbuf, vbits, size);
+   assert(r == 1);
+   VALGRIND_MAKE_MEM_DEFINED(rbuf, size);
+
+   ok = True;
+   for (i = 0; i < size; i++) {
+      if (vbits[i] != (unsigned char)rbuf_walk[i]
+          || vbits[i] != (unsigned char)rbuf[i])
+         ok = False;
+   }
+
+   if (ok)
+      printf("SUCCESS\n");
+   else
+      printf("FAILED\n");
+
+   printf("   walk_type=");
+   for (i = 0; i < size; i++)
+      printf("%c", characterise(rbuf_walk[i]));
+   printf("\n");
+
+   printf("  flattening=");
+   for (i = 0; i < size; i++)
+      printf("%c", characterise(vbits[i]));
+   printf("\n");
+
+   printf(" MPI library=");
+   for (i = 0; i < size; i++)
+      printf("%c", characterise(rbuf[i]));
+   printf("\n");
+
+   free(sbuf);
+   free(rbuf);
+   free(rbuf_walk);
+   free(vbits);
+}
+
+
 typedef  char*  Nm;
 
 int main ( int argc, char** argv )
@@ -370,6 +502,46 @@ int main ( int argc, char** argv )
 
 #undef TRY
 
+#define TRY_FLAT(_commit_free,_type,_name)            \
+       do { Ty ty = (_type);                          \
+            Nm nm = (_name);                          \
+            flattenToMyself((_commit_free), &ty, nm); \
+       } while (0)
+
+    TRY_FLAT(False, MPI_INT, "INT");
+
+    TRY_FLAT(False, MPI_DOUBLE_INT, "DOUBLE_INT");
+
+    TRY_FLAT(True, tycon_Contiguous(3, MPI_INT),
+                   "Contig{3xINT}");
+
+    TRY_FLAT(True, tycon_Vector(5, 2,3,MPI_DOUBLE),
+                   "Vector{5x(2,3)xDOUBLE}");
+
+    TRY_FLAT(True, tycon_HVector(4, 1,3,MPI_SHORT),
+                   "HVector{4x(1,h3)xSHORT}");
+
+    TRY_FLAT(True, tycon_Indexed2(1,3, 5,2, MPI_UNSIGNED_CHAR),
+                   "Indexed{1:3x,5:2x,UNSIGNED_CHAR}");
+
+    TRY_FLAT(True, tycon_HIndexed2(1,2, 6,3, MPI_UNSIGNED_SHORT),
+                   "HIndexed{h1:2x,h6:3x,UNSIGNED_SHORT}");
+
+    TRY_FLAT(True, tycon_Struct2(3,2,MPI_CHAR, 8,1,MPI_DOUBLE),
+                   "Struct{h3:2xCHAR, h8:1xDOUBLE}");
+
+    TRY_FLAT(True, tycon_Contiguous(10, tycon_Struct2(1,1,MPI_CHAR, 4,1,MPI_FLOAT)),
+                   "Contig{10xStruct{h1:1xCHAR, h4:1xFLOAT}}");
+
+    TRY_FLAT(True, tycon_Vector(3, 2,4, tycon_Struct2(0,1,MPI_CHAR, 2,1,MPI_SHORT)),
+                   "Vector{3x(2,4)xStruct{h0:1xCHAR, h2:1xSHORT}}");
+
+    TRY_FLAT(True, tycon_Struct2(0,1,MPI_CHAR,
+                                 4,1,tycon_Indexed2(0,2, 3,1, MPI_SHORT)),
+                   "Struct{h0:1xCHAR, h4:1xIndexed{0:2x,3:1x,SHORT}}");
+
+#undef TRY_FLAT
+
     }
 
     MPI_Finalize();
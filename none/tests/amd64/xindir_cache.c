@@ -0,0 +1,108 @@
+/* Indirect calls, jumps and returns get an inline cache of their last
+   target.  Check that control still reaches the right code when the
+   target of a site changes, and after the translations a cache points
+   at, or the translation holding the cache, have been discarded.
+
+   The targets are made at run time, each "movl $imm, %eax ; ret", so
+   that they can be rewritten to return something else.  The test is
+   run with --smc-check=none, so that only the discard requests get rid
+   of the old translations; otherwise their self-checks would hide a
+   cache that still points at one. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/sys_mman.h"
+#include "valgrind.h"
+
+#define N_TARGETS 4
+#define SLOT      64
+
+typedef int (*Fn)(void);
+
+static unsigned char* code;
+
+static void set_target(int k, int value)
+{
+   unsigned char* p = code + k * SLOT;
+
+   p[0] = 0xB8;                        /* movl $value, %eax */
+   memcpy(p + 1, &value, 4);
+   p[5] = 0xC3;                        /* ret */
+}
+
+static Fn target(int k)
+{
+   return (Fn)(code + k * SLOT);
+}
+
+/* One indirect call site, and one indirect jump site. */
+__attribute__((noinline))
+static int call(Fn f)
+{
+   return f();
+}
+
+__attribute__((noinline))
+static int jump(int k)
+{
+   static void* const labels[N_TARGETS] = { &&l0, &&l1, &&l2, &&l3 };
+
+   goto *labels[k];
+ l0: return 10;
+ l1: return 11;
+ l2: return 12;
+ l3: return 13;
+}
+
+/* Calls the targets in turn, so that each site changes target on every
+   call, then each one many times over, so that it keeps its target. */
+static void run(const char* what)
+{
+   int i, k, sum;
+
+   printf("%s:", what);
+   for (k = 0; k < N_TARGETS; k++)
+      printf(" %d", call(target(k)));
+   for (k = 0; k < N_TARGETS; k++) {
+      sum = 0;
+      for (i = 0; i < 1000; i++)
+         sum += call(target(k)) + jump(k);
+      printf(" %d", sum / 1000);
+   }
+   printf("\n");
+}
+
+int main(void)
+{
+   int k;
+
+   code = mmap(NULL, N_TARGETS * SLOT, PROT_READ | PROT_WRITE | PROT_EXEC,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (code == MAP_FAILED) {
+      perror("mmap");
+      return 1;
+   }
+
+   for (k = 0; k < N_TARGETS; k++)
+      set_target(k, k);
+   run("first");
+
+   /* New code at the same addresses. */
+   for (k = 0; k < N_TARGETS; k++)
+      set_target(k, 100 + k);
+   VALGRIND_DISCARD_TRANSLATIONS(code, N_TARGETS * SLOT);
+   run("rewritten");
+
+   /* Only one target changes. */
+   set_target(2, 200);
+   VALGRIND_DISCARD_TRANSLATIONS(code + 2 * SLOT, SLOT);
+   run("one rewritten");
+
+   /* The call and jump sites themselves are translated again. */
+   VALGRIND_DISCARD_TRANSLATIONS((char*)call, 64);
+   VALGRIND_DISCARD_TRANSLATIONS((char*)jump, 64);
+   run("sites discarded");
+
+   munmap(code, N_TARGETS * SLOT);
+   return 0;
+}
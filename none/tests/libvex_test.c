@@ -258,6 +258,7 @@ int main(int argc, char **argv)
    vta.finaltidy                  = NULL;
    vta.needs_self_check           = return_0;
    vta.preamble_function          = NULL;
+   vta.read_timer                 = NULL;
    vta.traceflags                 = 0xFFFFFFFF;
    vta.sigill_diag                = False;
    vta.addProfInc                 = False;
@@ -0,0 +1,32 @@
+/* Spins for a short while, to be sampled by --hw-profile.  With
+   --can-profile, just tells whether a cpu-clock perf event can be
+   opened, for the vgtest prereq. */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+__attribute__((noinline)) static unsigned long spin(unsigned long n)
+{
+   volatile unsigned long sum = 0;
+   unsigned long i;
+   for (i = 0; i < n; i++)
+      sum += i ^ (sum >> 3);
+   return sum;
+}
+
+int main(int argc, char** argv)
+{
+   if (argc > 1 && strcmp(argv[1], "--can-profile") == 0) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof attr);
+      attr.type = PERF_TYPE_SOFTWARE;
+      attr.size = sizeof attr;
+      attr.config = PERF_COUNT_SW_CPU_CLOCK;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0) < 0;
+   }
+   return spin(20000000) == 42;
+}
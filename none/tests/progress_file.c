@@ -0,0 +1,34 @@
+/* Burns enough user cpu time for --progress-interval=1 to produce a few
+   progress records, doing some system calls and heap allocation along
+   the way so that these fields have something to count. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+static long user_ms(void)
+{
+   struct rusage ru;
+   getrusage(RUSAGE_SELF, &ru);
+   return ru.ru_utime.tv_sec * 1000 + ru.ru_utime.tv_usec / 1000;
+}
+
+int main(void)
+{
+   volatile unsigned long sum = 0;
+   char* blocks[16] = { 0 };
+   unsigned long i;
+
+   for (i = 0; user_ms() < 2500; i++) {
+      unsigned long j;
+      free(blocks[i % 16]);
+      blocks[i % 16] = malloc(1000 + i % 1000);
+      for (j = 0; j < 100000; j++)
+         sum += j ^ i;
+   }
+   for (i = 0; i < 16; i++)
+      free(blocks[i]);
+   printf("done\n");
+   return 0;
+}
@@ -0,0 +1,78 @@
+/* A process-directed signal blocked by every thread must stay pending
+   for the process, even when it reaches a thread whose host signal
+   mask, left installed after a blocking syscall, is older than the
+   mask the thread has set since. */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t got;
+static volatile int blocked, done;
+static int go[2];
+
+static void handler(int sig)
+{
+   got++;
+}
+
+static void *spinner(void *arg)
+{
+   sigset_t set;
+   char c;
+
+   /* Block in a syscall with SIGUSR1 unblocked ... */
+   if (read(go[0], &c, 1) != 1)
+      perror("read");
+
+   /* ... then block it and never make a syscall until done. */
+   sigemptyset(&set);
+   sigaddset(&set, SIGUSR1);
+   pthread_sigmask(SIG_BLOCK, &set, NULL);
+   blocked = 1;
+   while (!done)
+      ;
+   return NULL;
+}
+
+int main(void)
+{
+   struct sigaction sa;
+   struct timespec ts = { 0, 200 * 1000 * 1000 };
+   struct timespec tick = { 0, 1000 * 1000 };
+   sigset_t set;
+   pthread_t t;
+   int i;
+
+   memset(&sa, 0, sizeof sa);
+   sa.sa_handler = handler;
+   sigaction(SIGUSR1, &sa, NULL);
+   if (pipe(go) != 0)
+      perror("pipe");
+
+   pthread_create(&t, NULL, spinner, NULL);
+
+   sigemptyset(&set);
+   sigaddset(&set, SIGUSR1);
+   pthread_sigmask(SIG_BLOCK, &set, NULL);
+   if (write(go[1], "x", 1) != 1)
+      perror("write");
+   while (!blocked)
+      nanosleep(&tick, NULL);
+
+   kill(getpid(), SIGUSR1);
+   nanosleep(&ts, NULL);
+   done = 1;
+   pthread_join(t, NULL);
+   printf("done got=%d\n", (int)got);
+
+   /* Still pending, so delivered once unblocked. */
+   pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+   for (i = 0; i < 50 && !got; i++)
+      nanosleep(&ts, NULL);
+   printf("unblocked got=%d\n", (int)got);
+   return 0;
+}
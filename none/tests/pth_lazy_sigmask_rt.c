@@ -0,0 +1,91 @@
+/* Two queued process-directed signals sent back to back, while the
+   one thread whose host signal mask, left installed after a blocking
+   syscall, still lets them in has blocked them since.  The thread
+   which does not block them must get both, in the order sent. */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t got;
+static volatile int vals[4];
+static volatile int blocked, done, spin;
+static int go[2];
+
+static void handler(int sig, siginfo_t *si, void *uc)
+{
+   if (got < 4)
+      vals[got] = si->si_value.sival_int;
+   got++;
+}
+
+static void *spinner(void *arg)
+{
+   sigset_t set;
+   char c;
+
+   /* Block in a syscall with SIGRTMIN unblocked ... */
+   if (read(go[0], &c, 1) != 1)
+      perror("read");
+
+   /* ... then block it and never make a syscall until done. */
+   sigemptyset(&set);
+   sigaddset(&set, SIGRTMIN);
+   pthread_sigmask(SIG_BLOCK, &set, NULL);
+   blocked = 1;
+   while (!done)
+      ;
+   return NULL;
+}
+
+int main(void)
+{
+   struct sigaction sa;
+   struct timespec ts = { 0, 200 * 1000 * 1000 };
+   struct timespec tick = { 0, 1000 * 1000 };
+   union sigval v;
+   sigset_t set;
+   pthread_t t;
+   int i;
+
+   memset(&sa, 0, sizeof sa);
+   sa.sa_sigaction = handler;
+   sa.sa_flags = SA_SIGINFO;
+   sigaction(SIGRTMIN, &sa, NULL);
+   if (pipe(go) != 0)
+      perror("pipe");
+
+   pthread_create(&t, NULL, spinner, NULL);
+
+   sigemptyset(&set);
+   sigaddset(&set, SIGRTMIN);
+   pthread_sigmask(SIG_BLOCK, &set, NULL);
+   if (write(go[1], "x", 1) != 1)
+      perror("write");
+   while (!blocked)
+      nanosleep(&tick, NULL);
+
+   v.sival_int = 1;
+   sigqueue(getpid(), SIGRTMIN, v);
+   v.sival_int = 2;
+   sigqueue(getpid(), SIGRTMIN, v);
+   /* Give the other thread time to take the first one, without a
+      syscall or a timeslice that lets it poll first. */
+   for (i = 0; i < 10000; i++)
+      spin++;
+
+   pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+   for (i = 0; i < 50 && got < 2; i++)
+      nanosleep(&ts, NULL);
+   done = 1;
+   pthread_join(t, NULL);
+
+   printf("got=%d", (int)got);
+   for (i = 0; i < got && i < 4; i++)
+      printf(" %d", vals[i]);
+   printf("\n");
+   return 0;
+}
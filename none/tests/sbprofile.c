@@ -0,0 +1,25 @@
+/* Calls hot() a known number of times, discarding its translation half
+   way through, so that --sb-profile-file must add up the counts of the
+   discarded and of the final translation. */
+
+#include "valgrind.h"
+
+#define N_CALLS 100000
+
+__attribute__((noinline)) static int hot(int x)
+{
+   return x * 3 + 1;
+}
+
+int main(void)
+{
+   volatile int sum = 0;
+   int i;
+
+   for (i = 0; i < N_CALLS / 2; i++)
+      sum += hot(i);
+   VALGRIND_DISCARD_TRANSLATIONS((void*)hot, 16);
+   for (i = 0; i < N_CALLS / 2; i++)
+      sum += hot(i);
+   return sum == 42;
+}
@@ -0,0 +1,33 @@
+// Allocation-heavy C++: builds and tears down maps of strings to
+// vectors, so that operator new/delete, std::string and the containers'
+// node allocations dominate.  With an argument of 0 it does no work at
+// all, which is used by startup.vgperf to measure startup, mostly the
+// reading of the debug information of the executable and libstdc++.
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+   int n_rounds = argc > 1 ? atoi(argv[1]) : 100;
+   unsigned long sum = 0;
+
+   for (int r = 0; r < n_rounds; r++) {
+      std::map<std::string, std::vector<int> > m;
+      for (int i = 0; i < 10000; i++) {
+         char key[32];
+         snprintf(key, sizeof key, "key-%d-%d", i % 2500, r);
+         std::vector<int>& v = m[key];
+         for (int j = 0; j < i % 7; j++)
+            v.push_back(i + j);
+      }
+      for (std::map<std::string, std::vector<int> >::const_iterator
+              it = m.begin(); it != m.end(); ++it)
+         sum += it->first.size() + it->second.size();
+   }
+   printf("sum %lu\n", sum);
+   return 0;
+}
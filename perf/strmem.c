@@ -0,0 +1,54 @@
+// Copies, compares and scans buffers with the libc str/mem functions,
+// at a mix of sizes and alignments.  Under the tools that replace these
+// functions (memcheck, helgrind, drd, dhat) this measures the
+// replacements rather than libc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUFSZ  4096
+#define NITERS 40000
+
+static char src[BUFSZ + 64];
+static char dst[BUFSZ + 64];
+static char str1[BUFSZ + 64];
+static char str2[BUFSZ + 64];
+
+int main(void)
+{
+   static const size_t sizes[] = { 7, 16, 33, 100, 256, 1000, 4000 };
+   const int nsizes = sizeof sizes / sizeof sizes[0];
+   unsigned long sum = 0;
+   int i;
+
+   for (i = 0; i < BUFSZ + 64; i++)
+      src[i] = (char)('a' + i % 26);
+   memcpy(str1, src, BUFSZ);
+   memcpy(str2, src, BUFSZ);
+   str1[BUFSZ] = str2[BUFSZ] = 0;
+
+   for (i = 0; i < NITERS; i++) {
+      size_t n   = sizes[i % nsizes];
+      int    sa  = i & 7;          // source and destination alignments
+      int    da  = (i >> 3) & 7;
+      char*  p;
+
+      memcpy(dst + da, src + sa, n);
+      memmove(dst + 1, dst + da, n);
+      memset(dst + sa, i & 0xff, n / 2);
+      sum += (unsigned long)memcmp(src + sa, str1 + sa, n) + dst[n / 3];
+
+      // strings of length n, compared equal almost to the end
+      str1[n] = str2[n] = 0;
+      str2[n - 1] = 'A';
+      sum += strlen(str1 + sa) + (strcmp(str1, str2) > 0);
+      str2[n - 1] = str1[n - 1];
+      str1[n] = str2[n] = src[n];
+
+      p = memchr(src + sa, '#', n);
+      sum += p == NULL;
+   }
+   printf("sum %lu\n", sum);
+   return 0;
+}
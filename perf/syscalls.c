@@ -0,0 +1,39 @@
+// Lots of small system calls: writing and reading back small chunks
+// through a pipe, plus a few cheap calls that do not transfer data.
+// Under Valgrind this is dominated by the syscall wrappers and the
+// scheduler work done around each syscall, not by translated code.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NITERS (200*1000)
+
+int main(void)
+{
+   int fds[2];
+   char buf[64];
+   struct stat st;
+   long sum = 0;
+   int i;
+
+   if (pipe(fds) != 0) {
+      perror("pipe");
+      return 1;
+   }
+   memset(buf, 'x', sizeof buf);
+   for (i = 0; i < NITERS; i++) {
+      buf[0] = (char)i;
+      if (write(fds[1], buf, sizeof buf) != sizeof buf)
+         return 1;
+      if (read(fds[0], buf, sizeof buf) != sizeof buf)
+         return 1;
+      sum += buf[0] + getppid();
+      if ((i & 15) == 0 && fstat(fds[0], &st) == 0)
+         sum += st.st_nlink;
+   }
+   printf("sum %ld\n", sum);
+   return 0;
+}
@@ -0,0 +1,56 @@
+// Several threads passing a token around a ring, with a little work done
+// by each thread while it holds the token.  Every hand-over makes the
+// next thread runnable and the current one block, so under Valgrind this
+// measures the cost of thread switches through the scheduler and its
+// lock rather than the cost of the instrumented code.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define NPASSES  (50*1000)
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  cv = PTHREAD_COND_INITIALIZER;
+static int  turn   = 0;
+static int  passes = 0;
+static long work[NTHREADS];
+
+static void* ring_fn(void* arg)
+{
+   int me = (int)(long)arg;
+   int i;
+
+   pthread_mutex_lock(&mx);
+   for (;;) {
+      while (turn != me && passes < NPASSES)
+         pthread_cond_wait(&cv, &mx);
+      if (passes >= NPASSES)
+         break;
+      for (i = 0; i < 200; i++)
+         work[me] += i ^ passes;
+      passes++;
+      turn = (turn + 1) % NTHREADS;
+      pthread_cond_broadcast(&cv);
+   }
+   pthread_cond_broadcast(&cv);
+   pthread_mutex_unlock(&mx);
+   return NULL;
+}
+
+int main(void)
+{
+   pthread_t t[NTHREADS];
+   long sum = 0;
+   int i;
+
+   for (i = 0; i < NTHREADS; i++)
+      pthread_create(&t[i], NULL, ring_fn, (void*)(long)i);
+   for (i = 0; i < NTHREADS; i++) {
+      pthread_join(t[i], NULL);
+      sum += work[i];
+   }
+   printf("%d passes, sum %ld\n", passes, sum);
+   return 0;
+}
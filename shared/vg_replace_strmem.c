@@ -106,6 +106,20 @@
    20460 MEMMEM
 */
 
+/* On targets that allow misaligned loads, memcpy/memmove and memcmp
+   also use their word loops when the two pointers have different
+   alignments, loading the source misaligned.  Each load still covers
+   only bytes inside the ranges given by the caller, so the tools see
+   exactly the bytes a byte loop would read.  The str* functions and
+   memchr stay byte at a time: they must not look past the terminating
+   byte, as that can be unaddressable or accessed by another thread. */
+#if defined(VGA_x86) || defined(VGA_amd64) || defined(VGA_arm64) \
+    || defined(VGA_ppc64le) || defined(VGA_s390x)
+#  define MISALIGNED_WORD_LOADS_OK 1
+#else
+#  define MISALIGNED_WORD_LOADS_OK 0
+#endif
+
 #if defined(VGO_solaris)
 /*
    Detour functions in the libc and the runtime linker. If a function isn't
@@ -184,6 +198,16 @@ static inline void my_exit ( int x )
 #define FOR_COPY(x) x
 #endif
 
+// Used for tools that can do large memcpy/memmove/memset faster
+// themselves than by running the loops below.  Evaluates to nonzero
+// if the tool has done it.
+#ifndef BULK_COPY
+#define BULK_COPY(dst, src, len) 0
+#endif
+#ifndef BULK_SET
+#define BULK_SET(s, c, len) 0
+#endif
+
 #ifndef VALGRIND_CHECK_VALUE_IS_DEFINED
 #define VALGRIND_CHECK_VALUE_IS_DEFINED(__lvalue) 1
 #endif
@@ -1048,6 +1072,8 @@ static inline void my_exit ( int x )
       RECORD_COPY(len); \
       if (do_ol_check && is_overlap(dst, src, len, len)) \
          RECORD_OVERLAP_ERROR("memcpy", dst, src, len); \
+      if (BULK_COPY(dst, src, len)) \
+         return dst; \
       \
       const Addr WS = sizeof(UWord); /* 8 or 4 */ \
       const Addr WM = WS - 1;        /* 7 or 3 */ \
@@ -1076,6 +1102,21 @@ static inline void my_exit ( int x )
                if (n == 0) \
                   return dst; \
             } \
+            else if (MISALIGNED_WORD_LOADS_OK && n >= WS * 4) { \
+               /* Different alignments.  Pull d up to a UWord */ \
+               /* boundary and load UWords from s misaligned. */ \
+               while ((d & WM) != 0) \
+                  { *(UChar*)d = *(UChar*)s; s += 1; d += 1; n -= 1; } \
+               while (n >= WS * 4) \
+                  { *(UWord*)d = *(UWord*)s; s += WS; d += WS; n -= WS;   \
+                    *(UWord*)d = *(UWord*)s; s += WS; d += WS; n -= WS;   \
+                    *(UWord*)d = *(UWord*)s; s += WS; d += WS; n -= WS;   \
+                    *(UWord*)d = *(UWord*)s; s += WS; d += WS; n -= WS; } \
+               while (n >= WS) \
+                  { *(UWord*)d = *(UWord*)s; s += WS; d += WS; n -= WS; } \
+               if (n == 0) \
+                  return dst; \
+            } \
             if (((s|d) & 1) == 0) { \
                /* Both are 16-aligned; copy what we can thusly. */ \
                while (n >= 2) \
@@ -1108,6 +1149,21 @@ static inline void my_exit ( int x )
                if (n == 0) \
                   return dst; \
             } \
+            else if (MISALIGNED_WORD_LOADS_OK && n >= WS * 4) { \
+               /* Different alignments.  Back d down to a UWord */ \
+               /* boundary and load UWords from s misaligned. */ \
+               while ((d & WM) != 0) \
+                  { s -= 1; d -= 1; *(UChar*)d = *(UChar*)s; n -= 1; } \
+               while (n >= WS * 4) \
+                  { s -= WS; d -= WS; *(UWord*)d = *(UWord*)s; n -= WS;   \
+                    s -= WS; d -= WS; *(UWord*)d = *(UWord*)s; n -= WS;   \
+                    s -= WS; d -= WS; *(UWord*)d = *(UWord*)s; n -= WS;   \
+                    s -= WS; d -= WS; *(UWord*)d = *(UWord*)s; n -= WS; } \
+               while (n >= WS) \
+                  { s -= WS; d -= WS; *(UWord*)d = *(UWord*)s; n -= WS; } \
+               if (n == 0) \
+                  return dst; \
+            } \
             if (((s|d) & 1) == 0) { \
                /* Both are 16-aligned; copy what we can thusly. */ \
                while (n >= 2) \
@@ -1183,9 +1239,10 @@ static inline void my_exit ( int x )
       Addr s1A = (Addr)s1V; \
       Addr s2A = (Addr)s2V; \
       \
-      if (((s1A | s2A) & WM) == 0) { \
-         /* Both areas are word aligned.  Skip over the */ \
-         /* equal prefix as fast as possible. */ \
+      if (MISALIGNED_WORD_LOADS_OK || ((s1A | s2A) & WM) == 0) { \
+         /* Both areas are word aligned, or the target does */ \
+         /* misaligned loads.  Skip over the equal prefix as */ \
+         /* fast as possible. */ \
          while (n >= WS) { \
             UWord w1 = *(UWord*)s1A; \
             UWord w2 = *(UWord*)s2A; \
@@ -1333,6 +1390,8 @@ static inline void my_exit ( int x )
    void* VG_REPLACE_FUNCTION_EZZ(20210,soname,fnname) \
             (void *s, Int c, SizeT n) \
    { \
+      if (BULK_SET(s, c, n)) \
+         return s; \
       if (sizeof(void*) == 8) { \
          Addr  a  = (Addr)s;   \
          ULong c8 = (c & 0xFF); \